@@ -0,0 +1,144 @@
+#ifndef ALLOCATOR_TRAITS_HPP
+#define ALLOCATOR_TRAITS_HPP
+
+#include <cassert>
+
+// What a container does with its allocator when it is copied, assigned or
+// swapped, after C++11's std::allocator_traits. An allocator opts in by
+// declaring the member typedefs (ft::true_type / ft::false_type) or the member
+// function below; std::allocator declares none of them and gets the defaults,
+// which are what the containers did before:
+//   select_on_container_copy_construction()    copy constructor; default: a copy
+//   propagate_on_container_copy_assignment     operator=; default: keep ours
+//   propagate_on_container_swap                swap; default: keep ours, and the
+//                                              two allocators must compare equal
+//   propagate_on_container_move_assignment     declared for completeness; without
+//                                              rvalue references nothing moves
+//   releases_in_bulk                           deallocate() gives nothing back and
+//                                              the memory goes all at once (arenas);
+//                                              default false
+// Rebinding goes through the converting constructor, so a rebound copy shares
+// the original's state (arena, pool, counters).
+
+namespace ft {
+
+	template <bool B>
+	struct bool_constant {
+		static const bool value = B;
+	};
+
+	typedef bool_constant<true>		true_type;
+	typedef bool_constant<false>	false_type;
+
+	template <typename T, typename U>
+	struct is_same : public false_type {};
+
+	template <typename T>
+	struct is_same<T, T> : public true_type {};
+
+	namespace allocator_detail {
+
+		// Alloc::name if the allocator declares it, false_type otherwise
+#define FT_ALLOCATOR_PROPERTY(name) \
+		template <typename A> \
+		struct has_##name { \
+			template <typename U> static char test(typename U::name*); \
+			template <typename U> static long test(...); \
+			static const bool value = sizeof(test<A>(0)) == 1; \
+		}; \
+		template <typename A, bool = has_##name<A>::value> \
+		struct name { typedef false_type type; }; \
+		template <typename A> \
+		struct name<A, true> { typedef typename A::name type; };
+
+		FT_ALLOCATOR_PROPERTY(propagate_on_container_copy_assignment)
+		FT_ALLOCATOR_PROPERTY(propagate_on_container_move_assignment)
+		FT_ALLOCATOR_PROPERTY(propagate_on_container_swap)
+		FT_ALLOCATOR_PROPERTY(releases_in_bulk)
+		FT_ALLOCATOR_PROPERTY(allocator_type)
+
+#undef FT_ALLOCATOR_PROPERTY
+
+		template <typename A>
+		struct has_select_on_copy {
+			template <typename U, U> struct check;
+			template <typename U> static char test(check<A (U::*)() const, &U::select_on_container_copy_construction>*);
+			template <typename U> static long test(...);
+			static const bool value = sizeof(test<A>(0)) == 1;
+		};
+
+		template <typename A, bool = has_select_on_copy<A>::value>
+		struct select_on_copy {
+			static A get(const A& a) { return a; }
+		};
+
+		template <typename A>
+		struct select_on_copy<A, true> {
+			static A get(const A& a) { return a.select_on_container_copy_construction(); }
+		};
+	}
+
+	template <typename Alloc>
+	struct allocator_traits {
+		typedef Alloc	allocator_type;
+		typedef typename allocator_detail::propagate_on_container_copy_assignment<Alloc>::type
+			propagate_on_container_copy_assignment;
+		typedef typename allocator_detail::propagate_on_container_move_assignment<Alloc>::type
+			propagate_on_container_move_assignment;
+		typedef typename allocator_detail::propagate_on_container_swap<Alloc>::type
+			propagate_on_container_swap;
+		typedef typename allocator_detail::releases_in_bulk<Alloc>::type
+			releases_in_bulk;
+
+		template <typename U>
+		struct rebind_alloc { typedef typename Alloc::template rebind<U>::other other; };
+
+		static Alloc select_on_container_copy_construction(const Alloc& a) {
+			return allocator_detail::select_on_copy<Alloc>::get(a);
+		}
+	};
+
+	// operator=: true when the container must free everything with its current
+	// allocator and take the source's before copying
+	template <typename Alloc>
+	bool allocator_propagates_on_copy(const Alloc& ours, const Alloc& theirs) {
+		return allocator_traits<Alloc>::propagate_on_container_copy_assignment::value && !(ours == theirs);
+	}
+
+	// swap: exchanges the allocators when they propagate; otherwise memory
+	// cannot change hands between them, so they have to be equal
+	template <typename Alloc>
+	void swap_allocators(Alloc& a, Alloc& b) {
+		if (allocator_traits<Alloc>::propagate_on_container_swap::value) {
+			Alloc tmp = a;
+			a = b;
+			b = tmp;
+		}
+		else
+			assert(a == b);
+	}
+
+	// compiler builtin; without it every type counts as needing its destructor
+	template <typename T>
+	struct is_trivially_destructible
+#if defined(__GNUC__) || defined(__clang__)
+		: public bool_constant<__has_trivial_destructor(T)> {};
+#else
+		: public false_type {};
+#endif
+
+	// A container whose allocator releases in bulk and whose elements need no
+	// destructor has nothing to do when it is destroyed: it skips walking and
+	// freeing its memory, so it may even outlive the arena's release().
+	template <typename Alloc, typename T>
+	struct destruction_is_trivial
+		: public bool_constant<allocator_traits<Alloc>::releases_in_bulk::value
+			&& is_trivially_destructible<T>::value> {};
+
+	// whether a container (or adaptor) of type T can be built from an Alloc
+	template <typename T, typename Alloc>
+	struct uses_allocator
+		: public bool_constant<is_same<typename allocator_detail::allocator_type<T>::type, Alloc>::value> {};
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "allocator_traits.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace ft {
+
+	// Bump allocator for memory that dies together, e.g. everything one request
+	// builds. Allocation moves a cursor through the current chunk; deallocate()
+	// only takes back the most recent allocation (a vector growing in place at
+	// the end); release() frees every chunk at once. An optional caller buffer,
+	// typically on the stack, is used first and never freed. Chunks double from
+	// chunk_size up to max_chunk_size; a larger request gets a chunk of its own.
+	// Not thread safe, not copyable.
+	class monotonic_arena {
+		private:
+			struct chunk {
+				chunk*	next;
+				size_t	size;	// bytes, header included
+			};
+
+			static const size_t	max_chunk_size = 1024 * 1024;
+
+			char*	_buffer;		// caller's initial buffer, may be NULL
+			size_t	_buffer_size;
+			size_t	_first_chunk;
+			size_t	_next_chunk;
+			chunk*	_chunks;		// newest first
+			char*	_cursor;
+			char*	_end;
+			size_t	_used;			// bytes handed out and not taken back
+			size_t	_reserved;		// bytes of chunks from operator new
+
+			monotonic_arena(const monotonic_arena&);
+			monotonic_arena& operator=(const monotonic_arena&);
+
+			static char* align_up(char* p, size_t align) {
+				size_t mis = reinterpret_cast<size_t>(p) & (align - 1);
+				return mis ? p + (align - mis) : p;
+			}
+
+			void grow(size_t bytes, size_t align) {
+				if (bytes > std::numeric_limits<size_t>::max() - sizeof(chunk) - align)
+					throw std::bad_alloc();
+				size_t need = sizeof(chunk) + bytes + align;
+				size_t size = _next_chunk > need ? _next_chunk : need;
+				chunk* c = static_cast<chunk*>(::operator new(size));
+				c->next = _chunks;
+				c->size = size;
+				_chunks = c;
+				_reserved += size;
+				_cursor = reinterpret_cast<char*>(c + 1);
+				_end = reinterpret_cast<char*>(c) + size;
+				if (_next_chunk < max_chunk_size)
+					_next_chunk *= 2;
+			}
+
+		public:
+			explicit monotonic_arena(size_t chunk_size = 4096)
+				: _buffer(NULL), _buffer_size(0), _first_chunk(chunk_size ? chunk_size : 64), _next_chunk(_first_chunk),
+				_chunks(NULL), _cursor(NULL), _end(NULL), _used(0), _reserved(0) {}
+
+			monotonic_arena(void* buffer, size_t size, size_t chunk_size = 4096)
+				: _buffer(static_cast<char*>(buffer)), _buffer_size(size), _first_chunk(chunk_size ? chunk_size : 64),
+				_next_chunk(_first_chunk), _chunks(NULL), _cursor(_buffer), _end(_buffer + size), _used(0), _reserved(0) {}
+
+			~monotonic_arena() { release(); }
+
+			void* allocate(size_t bytes, size_t align = sizeof(void*)) {
+				char* p = _cursor ? align_up(_cursor, align) : NULL;
+				if (p == NULL || p > _end || static_cast<size_t>(_end - p) < bytes) {
+					grow(bytes, align);
+					p = align_up(_cursor, align);
+				}
+				_cursor = p + bytes;
+				_used += bytes;
+				return p;
+			}
+
+			void deallocate(void* p, size_t bytes) {
+				if (static_cast<char*>(p) + bytes == _cursor) {
+					_cursor = static_cast<char*>(p);
+					_used -= bytes;
+				}
+			}
+
+			// everything allocated so far is gone; the arena starts over from the
+			// caller's buffer with the initial chunk size
+			void release() {
+				while (_chunks != NULL) {
+					chunk* next = _chunks->next;
+					::operator delete(_chunks);
+					_chunks = next;
+				}
+				_cursor = _buffer;
+				_end = _buffer + _buffer_size;
+				_next_chunk = _first_chunk;
+				_used = 0;
+				_reserved = 0;
+			}
+
+			size_t	bytes_used() const { return _used; }
+			size_t	bytes_reserved() const { return _reserved; }
+			size_t	chunks() const {
+				size_t n = 0;
+				for (chunk* c = _chunks; c != NULL; c = c->next)
+					n++;
+				return n;
+			}
+	};
+
+	// Standard allocator interface over a monotonic_arena. Copies and rebinds
+	// share the arena. Containers keep the arena they were built with (no
+	// propagation on copy assignment or swap), and since deallocation is a
+	// no-op a container of trivially destructible elements skips its
+	// destructor's walk entirely (releases_in_bulk, allocator_traits.hpp).
+	template <typename T>
+	class arena_allocator {
+		public:
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef const T*	const_pointer;
+			typedef T&			reference;
+			typedef const T&	const_reference;
+			typedef size_t		size_type;
+			typedef ptrdiff_t	difference_type;
+
+			typedef ft::true_type	releases_in_bulk;
+
+			template <typename U>
+			struct rebind { typedef arena_allocator<U> other; };
+
+		private:
+			monotonic_arena*	_arena;
+
+			template <typename U>
+			friend class arena_allocator;
+
+		public:
+			arena_allocator(monotonic_arena& arena) throw() : _arena(&arena) {}
+			arena_allocator(const arena_allocator& other) throw() : _arena(other._arena) {}
+			template <typename U>
+			arena_allocator(const arena_allocator<U>& other) throw() : _arena(other._arena) {}
+			~arena_allocator() throw() {}
+
+			arena_allocator& operator=(const arena_allocator& other) throw() {
+				_arena = other._arena;
+				return *this;
+			}
+
+			monotonic_arena&	arena() const { return *_arena; }
+
+			pointer			address(reference x) const { return &x; }
+			const_pointer	address(const_reference x) const { return &x; }
+
+			pointer allocate(size_type n, const void* hint = 0) {
+				(void)hint;
+				if (n > max_size())
+					throw std::bad_alloc();
+				return static_cast<pointer>(_arena->allocate(n * sizeof(T), __alignof__(T)));
+			}
+
+			void deallocate(pointer p, size_type n) {
+				if (p != NULL)
+					_arena->deallocate(p, n * sizeof(T));
+			}
+
+			size_type max_size() const throw() {
+				return std::numeric_limits<size_type>::max() / sizeof(T);
+			}
+
+			void construct(pointer p, const_reference val) { ::new (static_cast<void*>(p)) T(val); }
+			void destroy(pointer p) { p->~T(); }
+
+			template <typename U>
+			bool operator==(const arena_allocator<U>& other) const { return _arena == other._arena; }
+			template <typename U>
+			bool operator!=(const arena_allocator<U>& other) const { return _arena != other._arena; }
+	};
+}
+
+#endif
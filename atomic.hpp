@@ -0,0 +1,114 @@
+#ifndef ATOMIC_HPP
+#define ATOMIC_HPP
+
+#include <cstddef>
+#include <sched.h>
+
+// The little of C++11 <atomic> the concurrent containers need, on the
+// GCC/Clang __atomic builtins (which ThreadSanitizer understands). T must be
+// an integer or a pointer.
+
+namespace ft {
+
+	enum memory_order {
+		memory_order_relaxed = __ATOMIC_RELAXED,
+		memory_order_consume = __ATOMIC_CONSUME,
+		memory_order_acquire = __ATOMIC_ACQUIRE,
+		memory_order_release = __ATOMIC_RELEASE,
+		memory_order_acq_rel = __ATOMIC_ACQ_REL,
+		memory_order_seq_cst = __ATOMIC_SEQ_CST
+	};
+
+	template <typename T>
+	class atomic {
+		private:
+			T	_value;
+
+			atomic(const atomic&);
+			atomic& operator=(const atomic&);
+
+		public:
+			atomic() : _value() {}
+			explicit atomic(T v) : _value(v) {}
+
+			T load(memory_order order = memory_order_seq_cst) const {
+				return __atomic_load_n(&_value, order);
+			}
+
+			void store(T v, memory_order order = memory_order_seq_cst) {
+				__atomic_store_n(&_value, v, order);
+			}
+
+			T exchange(T v, memory_order order = memory_order_seq_cst) {
+				return __atomic_exchange_n(&_value, v, order);
+			}
+
+			// on failure expected receives the current value
+			bool compare_exchange_weak(T& expected, T desired, memory_order success, memory_order failure) {
+				return __atomic_compare_exchange_n(&_value, &expected, desired, true, success, failure);
+			}
+
+			bool compare_exchange_strong(T& expected, T desired, memory_order success, memory_order failure) {
+				return __atomic_compare_exchange_n(&_value, &expected, desired, false, success, failure);
+			}
+
+			T fetch_add(T delta, memory_order order = memory_order_seq_cst) {
+				return __atomic_fetch_add(&_value, delta, order);
+			}
+
+			T fetch_sub(T delta, memory_order order = memory_order_seq_cst) {
+				return __atomic_fetch_sub(&_value, delta, order);
+			}
+	};
+
+	// ThreadSanitizer does not model fences and GCC warns about every one it
+	// instruments; the fence is still emitted, so a TSan build stays correct
+	// and only loses the happens-before edges fences would add
+#if defined(__SANITIZE_THREAD__) && !defined(__clang__) && __GNUC__ >= 12
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wtsan"
+#endif
+	inline void atomic_thread_fence(memory_order order) {
+		__atomic_thread_fence(order);
+	}
+#if defined(__SANITIZE_THREAD__) && !defined(__clang__) && __GNUC__ >= 12
+# pragma GCC diagnostic pop
+#endif
+
+	// what two indices written by different threads should be apart
+	static const size_t	cache_line_size = 64;
+
+	// the spin-wait hint: lets the sibling hyperthread run and saves power
+	inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+
+	// Waiting for another thread: spin 1, 2, 4 .. 64 pauses, then give the
+	// core away with sched_yield(), which matters when there are more
+	// threads than cores.
+	class backoff {
+		private:
+			unsigned	_spins;
+
+		public:
+			backoff() : _spins(1) {}
+
+			void pause() {
+				if (_spins <= 64) {
+					for (unsigned i = 0; i < _spins; i++)
+						cpu_relax();
+					_spins *= 2;
+				}
+				else
+					sched_yield();
+			}
+
+			void reset() { _spins = 1; }
+	};
+}
+
+#endif
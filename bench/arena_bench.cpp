@@ -0,0 +1,233 @@
+#include "bench.hpp"
+
+#include "arena.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// request-scoped containers: every "request" builds a vector, a map and a set
+// of a few dozen to a few hundred elements, reads them back and throws them
+// all away, the way a handler's temporaries live and die. Rows compare where
+// the memory comes from:
+//   heap        std::allocator, one malloc/free per node and per growth
+//   arena       arena_allocator over one monotonic_arena, release()d after each request
+//   stack       arena_allocator over a fresh arena whose first 16 KiB are on the stack
+// with std:: containers on std::allocator as the baseline. "long" requests
+// hold trivially destructible elements, so the arena containers skip their
+// destructors; "string" maps still destroy every key.
+
+using bench::xorshift;
+
+struct arena_options {
+	size_t	requests;
+	size_t	items;
+	size_t	reps;
+
+	arena_options() : requests(20000), items(100), reps(5) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--requests N] [--items K] [--reps R]\n"
+		<< "  --requests requests per timed run (default 20000)\n"
+		<< "  --items average elements per container and request (default 100)\n"
+		<< "  --reps runs per row; the median is reported (default 5)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, arena_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--requests")
+			opt.requests = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--items")
+			opt.items = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--reps")
+			opt.reps = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.requests == 0 || opt.items == 0 || opt.reps == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// requests ===================================================================
+
+struct request {
+	std::vector<long>	keys;
+};
+
+static std::vector<request> make_requests(const arena_options& opt, unsigned long seed) {
+	std::vector<request> reqs(opt.requests);
+	for (size_t r = 0; r < reqs.size(); r++) {
+		size_t n = opt.items / 2 + xorshift(seed) % opt.items + 1;
+		for (size_t i = 0; i < n; i++)
+			reqs[r].keys.push_back(static_cast<long>(xorshift(seed) % (4 * n)));
+	}
+	return reqs;
+}
+
+template <typename Key>
+Key make_key(long k);
+
+template <>
+long make_key<long>(long k) { return k; }
+
+template <>
+std::string make_key<std::string>(long k) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "request-key-%012ld", k);
+	return std::string(buf);
+}
+
+// the work of one request; the containers die at the closing brace
+template <typename Vec, typename Map, typename Set, typename Alloc>
+size_t serve(const request& r, const Alloc& alloc) {
+	typedef typename Map::key_type key_type;
+	typedef typename Map::key_compare map_compare;
+	typedef typename Set::key_compare set_compare;
+
+	Vec v(alloc);
+	Map m((map_compare()), alloc);
+	Set s((set_compare()), alloc);
+	for (size_t i = 0; i < r.keys.size(); i++) {
+		v.push_back(r.keys[i]);
+		m.insert(typename Map::value_type(make_key<key_type>(r.keys[i]), r.keys[i]));
+		s.insert(r.keys[i]);
+	}
+	size_t sum = v.size();
+	for (size_t i = 0; i < r.keys.size(); i++) {
+		typename Map::iterator it = m.find(make_key<key_type>(r.keys[i] + 1));
+		if (it != m.end())
+			sum += static_cast<size_t>(it->second);
+		sum += s.count(r.keys[i]);
+	}
+	return sum + m.size();
+}
+
+// policies ===================================================================
+
+template <typename Key>
+struct ft_heap {
+	typedef ft::vector<long>		vector_type;
+	typedef ft::map<Key, long>		map_type;
+	typedef ft::set<long>			set_type;
+
+	static size_t run(const std::vector<request>& reqs) {
+		size_t sum = 0;
+		for (size_t r = 0; r < reqs.size(); r++)
+			sum += serve<vector_type, map_type, set_type>(reqs[r], std::allocator<long>());
+		return sum;
+	}
+};
+
+template <typename Key>
+struct std_heap {
+	typedef std::vector<long>		vector_type;
+	typedef std::map<Key, long>		map_type;
+	typedef std::set<long>			set_type;
+
+	static size_t run(const std::vector<request>& reqs) {
+		size_t sum = 0;
+		for (size_t r = 0; r < reqs.size(); r++)
+			sum += serve<vector_type, map_type, set_type>(reqs[r], std::allocator<long>());
+		return sum;
+	}
+};
+
+template <typename Key>
+struct ft_arena_types {
+	typedef ft::arena_allocator<long>						alloc;
+	typedef ft::arena_allocator<ft::pair<const Key, long> >	pair_alloc;
+
+	typedef ft::vector<long, alloc>							vector_type;
+	typedef ft::map<Key, long, ft::less<Key>, pair_alloc>	map_type;
+	typedef ft::set<long, ft::less<long>, alloc>			set_type;
+};
+
+template <typename Key>
+struct ft_arena : ft_arena_types<Key> {
+	typedef ft_arena_types<Key> types;
+
+	static size_t run(const std::vector<request>& reqs) {
+		ft::monotonic_arena arena;
+		size_t sum = 0;
+		for (size_t r = 0; r < reqs.size(); r++) {
+			sum += serve<typename types::vector_type, typename types::map_type, typename types::set_type>(
+				reqs[r], typename types::alloc(arena));
+			arena.release();
+		}
+		return sum;
+	}
+};
+
+template <typename Key>
+struct ft_stack : ft_arena_types<Key> {
+	typedef ft_arena_types<Key> types;
+
+	static size_t run(const std::vector<request>& reqs) {
+		size_t sum = 0;
+		for (size_t r = 0; r < reqs.size(); r++) {
+			char buffer[16384];
+			ft::monotonic_arena arena(buffer, sizeof(buffer));
+			sum += serve<typename types::vector_type, typename types::map_type, typename types::set_type>(
+				reqs[r], typename types::alloc(arena));
+		}
+		return sum;
+	}
+};
+
+// report =====================================================================
+
+template <typename Policy>
+double measure(const arena_options& opt, const std::vector<request>& reqs) {
+	std::vector<double> samples;
+	Policy::run(reqs);
+	for (size_t rep = 0; rep < opt.reps; rep++) {
+		double start = bench::now_ns();
+		bench::sink() += Policy::run(reqs);
+		samples.push_back((bench::now_ns() - start) / static_cast<double>(reqs.size()));
+	}
+	return bench::median_of(samples);
+}
+
+template <typename Key>
+void rows(const arena_options& opt, const char* type, const std::vector<request>& reqs) {
+	double heap = measure<ft_heap<Key> >(opt, reqs);
+	double arena = measure<ft_arena<Key> >(opt, reqs);
+	double stack = measure<ft_stack<Key> >(opt, reqs);
+	double baseline = measure<std_heap<Key> >(opt, reqs);
+
+	std::printf("%-8s %12.0f %12.0f %12.0f %12.0f %10.2f %10.2f\n", type, heap, arena, stack, baseline,
+		heap / arena, heap / stack);
+}
+
+int main(int argc, char** argv) {
+	arena_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::vector<request> reqs = make_requests(opt, 88172645463325252UL);
+
+	std::printf("# %lu requests of about %lu elements per container; nanoseconds per request\n",
+		static_cast<unsigned long>(opt.requests), static_cast<unsigned long>(opt.items));
+	std::printf("%-8s %12s %12s %12s %12s %10s %10s\n", "type", "ft_heap", "ft_arena", "ft_stack", "std_heap",
+		"arena_x", "stack_x");
+	rows<long>(opt, "long", reqs);
+	rows<std::string>(opt, "string", reqs);
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
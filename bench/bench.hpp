@@ -0,0 +1,293 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "counting_allocator.hpp"
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <time.h>
+#include <vector>
+
+// shared helpers for the bench programs and the ft-vs-std suite harness
+
+namespace bench {
+
+	// clock ======================================================================
+
+	inline double now_ns() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec * 1e9 + ts.tv_nsec;
+	}
+
+	inline double now_ms() {
+		return now_ns() / 1e6;
+	}
+
+	inline unsigned long xorshift(unsigned long& s) {
+		s ^= s << 13;
+		s ^= s >> 7;
+		s ^= s << 17;
+		return s;
+	}
+
+	// keeps results alive so the optimizer cannot drop the measured work
+	inline size_t& sink() {
+		static size_t s = 0;
+		return s;
+	}
+
+	// statistics =================================================================
+
+	struct stats {
+		double	median;
+		double	p99;
+		size_t	samples;
+		size_t	checksum;
+		double	allocs_per_op;
+		double	counters[counter_count];	// median per element, -1 if not measured
+	};
+
+	inline double median_of(std::vector<double> v) {
+		std::sort(v.begin(), v.end());
+		size_t n = v.size();
+		return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+	}
+
+	inline stats summarize(std::vector<double> samples, size_t checksum, double allocs_per_op) {
+		stats st;
+		st.allocs_per_op = allocs_per_op;
+		for (size_t i = 0; i < counter_count; i++)
+			st.counters[i] = -1;
+		std::sort(samples.begin(), samples.end());
+		size_t n = samples.size();
+		st.samples = n;
+		st.checksum = checksum;
+		st.median = median_of(samples);
+		// nearest rank; with few samples this is the slowest one
+		size_t rank = (n * 99 + 99) / 100;
+		st.p99 = samples[rank - 1];
+		return st;
+	}
+
+	// options ====================================================================
+
+	struct options {
+		size_t		min_size;
+		size_t		max_size;
+		size_t		reps;
+		size_t		sample_ops;
+		std::string	filter;
+		bool		table;
+		bool		counters;
+
+		options() : min_size(10), max_size(100000), reps(0), sample_ops(100000), filter(), table(false), counters(false) {}
+
+		size_t reps_for(size_t n) const {
+			if (reps != 0)
+				return reps;
+			if (n <= 1000)
+				return 31;
+			if (n <= 100000)
+				return 11;
+			if (n <= 1000000)
+				return 5;
+			return 3;
+		}
+
+		bool selected(const std::string& name) const {
+			return filter.empty() || name.find(filter) != std::string::npos;
+		}
+	};
+
+	inline void usage(const char* prog) {
+		std::cerr << "usage: " << prog << " [--min N] [--max N] [--reps N] [--sample-ops N] [--filter STR] [--table] [--counters]\n"
+			<< "  sizes run in decades from --min to --max (default 10..100000, up to 10000000)\n"
+			<< "  --reps fixes the repetition count (default: 31 / 11 / 5 / 3 by size)\n"
+			<< "  --filter keeps rows whose \"container/op/type\" contains STR\n"
+			<< "  --table prints aligned columns instead of tab-separated values\n"
+			<< "  --counters adds hardware counters per element (linux perf_event_open):\n"
+			<< "    cyc cycles, ins instructions, l1d L1d read misses, llc last level cache misses,\n"
+			<< "    brm branch misses, dtlb dTLB read misses; \"-\" where the kernel refused the event" << std::endl;
+	}
+
+	inline bool parse_options(int argc, char** argv, options& opt) {
+		for (int i = 1; i < argc; i++) {
+			std::string arg(argv[i]);
+			if (arg == "--table") {
+				opt.table = true;
+				continue;
+			}
+			if (arg == "--counters") {
+				opt.counters = true;
+				continue;
+			}
+			if (i + 1 >= argc) {
+				usage(argv[0]);
+				return false;
+			}
+			std::string val(argv[++i]);
+			if (arg == "--filter")
+				opt.filter = val;
+			else if (arg == "--min")
+				opt.min_size = std::strtoul(val.c_str(), NULL, 10);
+			else if (arg == "--max")
+				opt.max_size = std::strtoul(val.c_str(), NULL, 10);
+			else if (arg == "--reps")
+				opt.reps = std::strtoul(val.c_str(), NULL, 10);
+			else if (arg == "--sample-ops")
+				opt.sample_ops = std::strtoul(val.c_str(), NULL, 10);
+			else {
+				usage(argv[0]);
+				return false;
+			}
+		}
+		if (opt.min_size == 0 || opt.max_size < opt.min_size || opt.sample_ops == 0) {
+			usage(argv[0]);
+			return false;
+		}
+		return true;
+	}
+
+	// the process wide counter set, opened on first use; NULL without --counters
+	inline perf_counters* counters_for(const options& opt) {
+		if (!opt.counters)
+			return NULL;
+		static perf_counters pc;
+		return &pc;
+	}
+
+	// measurement ================================================================
+	// Containers under test use ft::counting_allocator, so the allocations the
+	// timed part made are read from the global allocation_stats afterwards.
+	// A case is a struct with
+	//   typedef ... fixture;                          default constructible
+	//   static void   setup(fixture&, const Keys&);   not timed
+	//   static size_t run(fixture&, const Keys&);     timed, returns a checksum
+	// and Keys has size(). One sample runs the case on as many fresh fixtures as
+	// needed to reach sample_ops element operations and is reported per element.
+
+	template <typename Case, typename Keys>
+	stats measure(const Keys& keys, const options& opt) {
+		typedef typename Case::fixture fixture;
+		const size_t n = keys.size();
+		const size_t iters = opt.sample_ops / n ? opt.sample_ops / n : 1;
+		const size_t reps = opt.reps_for(n);
+		std::vector<double> samples;
+		size_t checksum = 0;
+		size_t allocations = 0;
+		ft::allocation_stats& alloc_stats = ft::allocation_stats::global();
+		perf_counters* pc = counters_for(opt);
+		std::vector<double> counted[counter_count];
+		double events[counter_count];
+
+		for (size_t r = 0; r < reps; r++) {
+			std::vector<fixture> fixtures(iters);
+			for (size_t i = 0; i < iters; i++)
+				Case::setup(fixtures[i], keys);
+			size_t sum = 0;
+			alloc_stats.reset();
+			if (pc)
+				pc->start();
+			double start = now_ns();
+			for (size_t i = 0; i < iters; i++)
+				sum += Case::run(fixtures[i], keys);
+			samples.push_back((now_ns() - start) / static_cast<double>(iters * n));
+			if (pc) {
+				pc->stop(events);
+				for (size_t c = 0; c < counter_count; c++)
+					if (events[c] >= 0)
+						counted[c].push_back(events[c] / static_cast<double>(iters * n));
+			}
+			allocations = alloc_stats.allocations;
+			checksum = sum / iters;
+			sink() += sum;
+		}
+		stats st = summarize(samples, checksum, static_cast<double>(allocations) / static_cast<double>(iters * n));
+		for (size_t c = 0; c < counter_count; c++)
+			if (!counted[c].empty())
+				st.counters[c] = median_of(counted[c]);
+		return st;
+	}
+
+	// report =====================================================================
+
+	// with --counters every row ends in ft_<counter> and std_<counter> columns
+	inline void print_counter_header(const options& opt) {
+		if (!opt.counters)
+			return;
+		const char* sides[2] = { "ft", "std" };
+		for (size_t s = 0; s < 2; s++)
+			for (size_t c = 0; c < counter_count; c++) {
+				std::string col = std::string(sides[s]) + "_" + counter_column(c);
+				if (opt.table)
+					std::printf(" %8s", col.c_str());
+				else
+					std::printf("\t%s", col.c_str());
+			}
+	}
+
+	inline void print_counters(const options& opt, const stats& ft, const stats& std_) {
+		if (!opt.counters)
+			return;
+		const stats* sides[2] = { &ft, &std_ };
+		for (size_t s = 0; s < 2; s++)
+			for (size_t c = 0; c < counter_count; c++) {
+				double v = sides[s]->counters[c];
+				if (v < 0)
+					std::printf(opt.table ? " %8s" : "\t%s", "-");
+				else
+					std::printf(opt.table ? " %8.2f" : "\t%.3f", v);
+			}
+	}
+
+	inline void print_header(const options& opt) {
+		if (opt.table)
+			std::printf("%-14s %-12s %-7s %9s %5s %10s %10s %9s %10s %10s %9s %7s %-8s",
+				"container", "op", "type", "size", "reps",
+				"ft_med_ns", "ft_p99_ns", "ft_alloc", "std_med_ns", "std_p99_ns", "std_alloc", "ft/std", "check");
+		else
+			std::printf("container\top\ttype\tsize\treps\tft_median_ns\tft_p99_ns\tft_allocs_per_op"
+				"\tstd_median_ns\tstd_p99_ns\tstd_allocs_per_op\tratio\tcheck");
+		print_counter_header(opt);
+		std::printf("\n");
+		std::fflush(stdout);
+	}
+
+	inline void print_row(const options& opt, const std::string& container, const std::string& op,
+		const std::string& type, size_t n, const stats& ft, const stats& std_) {
+		double ratio = std_.median > 0 ? ft.median / std_.median : 0;
+		const char* check = ft.checksum == std_.checksum ? "ok" : "MISMATCH";
+		if (opt.table)
+			std::printf("%-14s %-12s %-7s %9lu %5lu %10.2f %10.2f %9.3f %10.2f %10.2f %9.3f %7.2f %-8s",
+				container.c_str(), op.c_str(), type.c_str(), static_cast<unsigned long>(n),
+				static_cast<unsigned long>(ft.samples), ft.median, ft.p99, ft.allocs_per_op,
+				std_.median, std_.p99, std_.allocs_per_op, ratio, check);
+		else
+			std::printf("%s\t%s\t%s\t%lu\t%lu\t%.3f\t%.3f\t%.4f\t%.3f\t%.3f\t%.4f\t%.4f\t%s",
+				container.c_str(), op.c_str(), type.c_str(), static_cast<unsigned long>(n),
+				static_cast<unsigned long>(ft.samples), ft.median, ft.p99, ft.allocs_per_op,
+				std_.median, std_.p99, std_.allocs_per_op, ratio, check);
+		print_counters(opt, ft, std_);
+		std::printf("\n");
+		std::fflush(stdout);
+	}
+
+	// measures the ft case and its std counterpart on the same keys and prints one row
+	template <typename FtCase, typename StdCase, typename Keys>
+	void compare(const options& opt, const std::string& container, const std::string& op,
+		const std::string& type, const Keys& keys) {
+		if (!opt.selected(container + "/" + op + "/" + type))
+			return;
+		stats ft = measure<FtCase>(keys, opt);
+		stats std_ = measure<StdCase>(keys, opt);
+		print_row(opt, container, op, type, keys.size(), ft, std_);
+	}
+}
+
+#endif
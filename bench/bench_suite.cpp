@@ -0,0 +1,451 @@
+#include "bench.hpp"
+
+#include "vector.hpp"
+#include "stack.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "unordered_map.hpp"
+#include "unordered_set.hpp"
+#include "btree_map.hpp"
+#include "btree_set.hpp"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <set>
+#include <stack>
+#include <string>
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#include <vector>
+
+// ft vs std for every container and operation, over int, a 64-byte POD and
+// std::string elements. One tab-separated row per (container, op, type, size);
+// times are nanoseconds per element. Both sides allocate through
+// ft::counting_allocator, so each row also shows container allocations per
+// element (std::string's own buffers are not counted). "check" compares the
+// checksums both sides returned, so a wrong result shows up next to its timing.
+
+// element types ==============================================================
+
+struct pod64 {
+	long	key;
+	char	pad[56];
+};
+
+inline bool operator<(const pod64& a, const pod64& b) { return a.key < b.key; }
+inline bool operator==(const pod64& a, const pod64& b) { return a.key == b.key; }
+
+namespace ft {
+	template <>
+	struct hash<pod64> {
+		size_t operator()(const pod64& p) const { return static_cast<size_t>(p.key); }
+	};
+}
+
+namespace std {
+	namespace tr1 {
+		template <>
+		struct hash<pod64> {
+			size_t operator()(const pod64& p) const { return static_cast<size_t>(p.key); }
+		};
+	}
+}
+
+template <typename T>
+T make_key(long id);
+
+template <>
+int make_key<int>(long id) { return static_cast<int>(id); }
+
+template <>
+pod64 make_key<pod64>(long id) {
+	pod64 p;
+	p.key = id;
+	std::memset(p.pad, static_cast<int>(id & 0x7F), sizeof(p.pad));
+	return p;
+}
+
+// 24 characters, past the small-string buffer
+template <>
+std::string make_key<std::string>(long id) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "key-%020ld", id);
+	return std::string(buf);
+}
+
+inline size_t weight(int v) { return static_cast<size_t>(v); }
+inline size_t weight(const pod64& p) { return static_cast<size_t>(p.key) + static_cast<unsigned char>(p.pad[55]); }
+inline size_t weight(const std::string& s) { return s.size() + static_cast<unsigned char>(s[s.size() - 1]); }
+
+// keys =======================================================================
+
+template <typename T>
+struct key_set {
+	std::vector<T>	insert_order;	// even ids 0 .. 2n-2, shuffled
+	std::vector<T>	lookup_order;	// the same keys, shuffled again
+	std::vector<T>	misses;			// odd ids, never inserted
+
+	explicit key_set(size_t n) {
+		std::vector<long> ids(n);
+		for (size_t i = 0; i < n; i++)
+			ids[i] = static_cast<long>(i) * 2;
+		unsigned long seed = 88172645463325252UL;
+		shuffle(ids, seed);
+		for (size_t i = 0; i < n; i++) {
+			insert_order.push_back(make_key<T>(ids[i]));
+			misses.push_back(make_key<T>(ids[i] + 1));
+		}
+		shuffle(ids, seed);
+		for (size_t i = 0; i < n; i++)
+			lookup_order.push_back(make_key<T>(ids[i]));
+	}
+
+	size_t size() const { return insert_order.size(); }
+
+	static void shuffle(std::vector<long>& v, unsigned long& seed) {
+		for (size_t i = v.size(); i > 1; i--)
+			std::swap(v[i - 1], v[bench::xorshift(seed) % i]);
+	}
+};
+
+// vector =====================================================================
+
+template <typename C, typename T>
+struct vec_filled {
+	typedef C fixture;
+	static void setup(C& c, const key_set<T>& ks) {
+		for (size_t i = 0; i < ks.size(); i++)
+			c.push_back(ks.insert_order[i]);
+	}
+};
+
+template <typename C, typename T>
+struct vec_push_back {
+	typedef C fixture;
+	static void setup(C&, const key_set<T>&) {}
+	static size_t run(C& c, const key_set<T>& ks) {
+		for (size_t i = 0; i < ks.size(); i++)
+			c.push_back(ks.insert_order[i]);
+		return c.size();
+	}
+};
+
+template <typename C, typename T>
+struct vec_reserve_push_back {
+	typedef C fixture;
+	static void setup(C&, const key_set<T>&) {}
+	static size_t run(C& c, const key_set<T>& ks) {
+		c.reserve(ks.size());
+		for (size_t i = 0; i < ks.size(); i++)
+			c.push_back(ks.insert_order[i]);
+		return c.size();
+	}
+};
+
+template <typename C, typename T>
+struct vec_resize {
+	typedef C fixture;
+	static void setup(C&, const key_set<T>&) {}
+	static size_t run(C& c, const key_set<T>& ks) {
+		c.resize(ks.size(), ks.insert_order[0]);
+		return c.size() + weight(c.back());
+	}
+};
+
+template <typename C, typename T>
+struct vec_index : vec_filled<C, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		size_t sum = 0;
+		size_t n = ks.size();
+		for (size_t i = 0, j = 0; i < n; i++, j = (j + 7919) % n)
+			sum += weight(c[j]);
+		return sum;
+	}
+};
+
+template <typename C, typename T>
+struct vec_iterate : vec_filled<C, T> {
+	static size_t run(C& c, const key_set<T>&) {
+		const C& cc = c;
+		size_t sum = 0;
+		for (typename C::const_iterator it = cc.begin(); it != cc.end(); ++it)
+			sum += weight(*it);
+		return sum;
+	}
+};
+
+template <typename C, typename T>
+struct vec_pop_back : vec_filled<C, T> {
+	static size_t run(C& c, const key_set<T>&) {
+		size_t sum = 0;
+		while (!c.empty()) {
+			sum += weight(c.back());
+			c.pop_back();
+		}
+		return sum;
+	}
+};
+
+template <typename C, typename T>
+struct vec_erase_half : vec_filled<C, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		c.erase(c.begin(), c.begin() + ks.size() / 2);
+		return c.size() + weight(c.front());
+	}
+};
+
+template <typename C>
+struct copy_fixture {
+	C	src;
+	C	dst;
+};
+
+template <typename C, typename T>
+struct vec_copy {
+	typedef copy_fixture<C> fixture;
+	static void setup(fixture& f, const key_set<T>& ks) { vec_filled<C, T>::setup(f.src, ks); }
+	static size_t run(fixture& f, const key_set<T>&) {
+		f.dst = f.src;
+		return f.dst.size() + weight(f.dst.back());
+	}
+};
+
+template <typename FtC, typename StdC, typename T>
+void vector_rows(const bench::options& opt, const char* name, const char* type, const key_set<T>& ks) {
+	bench::compare<vec_push_back<FtC, T>, vec_push_back<StdC, T> >(opt, name, "push_back", type, ks);
+	bench::compare<vec_reserve_push_back<FtC, T>, vec_reserve_push_back<StdC, T> >(opt, name, "reserve_push", type, ks);
+	bench::compare<vec_resize<FtC, T>, vec_resize<StdC, T> >(opt, name, "resize", type, ks);
+	bench::compare<vec_index<FtC, T>, vec_index<StdC, T> >(opt, name, "index", type, ks);
+	bench::compare<vec_iterate<FtC, T>, vec_iterate<StdC, T> >(opt, name, "iterate", type, ks);
+	bench::compare<vec_copy<FtC, T>, vec_copy<StdC, T> >(opt, name, "copy", type, ks);
+	bench::compare<vec_pop_back<FtC, T>, vec_pop_back<StdC, T> >(opt, name, "pop_back", type, ks);
+	bench::compare<vec_erase_half<FtC, T>, vec_erase_half<StdC, T> >(opt, name, "erase_half", type, ks);
+}
+
+// stack ======================================================================
+
+template <typename C, typename T>
+struct stack_push {
+	typedef C fixture;
+	static void setup(C&, const key_set<T>&) {}
+	static size_t run(C& c, const key_set<T>& ks) {
+		for (size_t i = 0; i < ks.size(); i++)
+			c.push(ks.insert_order[i]);
+		return c.size() + weight(c.top());
+	}
+};
+
+template <typename C, typename T>
+struct stack_pop {
+	typedef C fixture;
+	static void setup(C& c, const key_set<T>& ks) { stack_push<C, T>::run(c, ks); }
+	static size_t run(C& c, const key_set<T>&) {
+		size_t sum = 0;
+		while (!c.empty()) {
+			sum += weight(c.top());
+			c.pop();
+		}
+		return sum;
+	}
+};
+
+template <typename FtC, typename StdC, typename T>
+void stack_rows(const bench::options& opt, const char* name, const char* type, const key_set<T>& ks) {
+	bench::compare<stack_push<FtC, T>, stack_push<StdC, T> >(opt, name, "push", type, ks);
+	bench::compare<stack_pop<FtC, T>, stack_pop<StdC, T> >(opt, name, "pop", type, ks);
+}
+
+// associative containers =====================================================
+
+struct map_like {
+	template <typename C, typename T>
+	static void add(C& c, const T& k) { c.insert(typename C::value_type(k, 1)); }
+	template <typename It>
+	static size_t weight_of(It it) { return weight(it->first) + it->second; }
+};
+
+struct set_like {
+	template <typename C, typename T>
+	static void add(C& c, const T& k) { c.insert(k); }
+	template <typename It>
+	static size_t weight_of(It it) { return weight(*it); }
+};
+
+template <typename C, typename F, typename T>
+struct assoc_filled {
+	typedef C fixture;
+	static void setup(C& c, const key_set<T>& ks) {
+		for (size_t i = 0; i < ks.size(); i++)
+			F::add(c, ks.insert_order[i]);
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_insert {
+	typedef C fixture;
+	static void setup(C&, const key_set<T>&) {}
+	static size_t run(C& c, const key_set<T>& ks) {
+		for (size_t i = 0; i < ks.size(); i++)
+			F::add(c, ks.insert_order[i]);
+		return c.size();
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_find : assoc_filled<C, F, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		size_t sum = 0;
+		for (size_t i = 0; i < ks.size(); i++) {
+			typename C::iterator it = c.find(ks.lookup_order[i]);
+			if (it != c.end())
+				sum += F::weight_of(it);
+		}
+		return sum;
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_find_miss : assoc_filled<C, F, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		size_t hits = 0;
+		for (size_t i = 0; i < ks.size(); i++)
+			hits += c.find(ks.misses[i]) != c.end();
+		return hits;
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_erase : assoc_filled<C, F, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		size_t erased = 0;
+		for (size_t i = 0; i < ks.size(); i++)
+			erased += c.erase(ks.lookup_order[i]);
+		return erased + c.size();
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_iterate : assoc_filled<C, F, T> {
+	static size_t run(C& c, const key_set<T>&) {
+		const C& cc = c;
+		size_t sum = 0;
+		for (typename C::const_iterator it = cc.begin(); it != cc.end(); ++it)
+			sum += F::weight_of(it);
+		return sum;
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_copy {
+	typedef copy_fixture<C> fixture;
+	static void setup(fixture& f, const key_set<T>& ks) { assoc_filled<C, F, T>::setup(f.src, ks); }
+	static size_t run(fixture& f, const key_set<T>&) {
+		f.dst = f.src;
+		return f.dst.size();
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_lower_bound : assoc_filled<C, F, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		size_t sum = 0;
+		for (size_t i = 0; i < ks.size(); i++) {
+			typename C::iterator it = c.lower_bound(ks.misses[i]);
+			if (it != c.end())
+				sum += F::weight_of(it);
+		}
+		return sum;
+	}
+};
+
+template <typename C, typename F, typename T>
+struct assoc_upper_bound : assoc_filled<C, F, T> {
+	static size_t run(C& c, const key_set<T>& ks) {
+		size_t sum = 0;
+		for (size_t i = 0; i < ks.size(); i++) {
+			typename C::iterator it = c.upper_bound(ks.lookup_order[i]);
+			if (it != c.end())
+				sum += F::weight_of(it);
+		}
+		return sum;
+	}
+};
+
+template <typename FtC, typename StdC, typename F, typename T>
+void hashed_rows(const bench::options& opt, const char* name, const char* type, const key_set<T>& ks) {
+	bench::compare<assoc_insert<FtC, F, T>, assoc_insert<StdC, F, T> >(opt, name, "insert", type, ks);
+	bench::compare<assoc_find<FtC, F, T>, assoc_find<StdC, F, T> >(opt, name, "find", type, ks);
+	bench::compare<assoc_find_miss<FtC, F, T>, assoc_find_miss<StdC, F, T> >(opt, name, "find_miss", type, ks);
+	bench::compare<assoc_erase<FtC, F, T>, assoc_erase<StdC, F, T> >(opt, name, "erase", type, ks);
+	bench::compare<assoc_iterate<FtC, F, T>, assoc_iterate<StdC, F, T> >(opt, name, "iterate", type, ks);
+	bench::compare<assoc_copy<FtC, F, T>, assoc_copy<StdC, F, T> >(opt, name, "copy", type, ks);
+}
+
+template <typename FtC, typename StdC, typename F, typename T>
+void ordered_rows(const bench::options& opt, const char* name, const char* type, const key_set<T>& ks) {
+	hashed_rows<FtC, StdC, F>(opt, name, type, ks);
+	bench::compare<assoc_lower_bound<FtC, F, T>, assoc_lower_bound<StdC, F, T> >(opt, name, "lower_bound", type, ks);
+	bench::compare<assoc_upper_bound<FtC, F, T>, assoc_upper_bound<StdC, F, T> >(opt, name, "upper_bound", type, ks);
+}
+
+// driver =====================================================================
+
+// every container under test, ft and std, allocating through counting_allocator
+template <typename T>
+struct counted {
+	typedef ft::counting_allocator<T>							alloc;
+	typedef ft::counting_allocator<ft::pair<const T, int> >		ft_pair_alloc;
+	typedef ft::counting_allocator<std::pair<const T, int> >	std_pair_alloc;
+
+	typedef ft::vector<T, alloc>													ft_vector;
+	typedef std::vector<T, alloc>													std_vector;
+	typedef ft::stack<T, ft_vector>													ft_stack;
+	typedef std::stack<T, std::deque<T, alloc> >									std_stack;
+	typedef ft::map<T, int, ft::less<T>, ft_pair_alloc>								ft_map;
+	typedef std::map<T, int, std::less<T>, std_pair_alloc>							std_map;
+	typedef ft::set<T, ft::less<T>, alloc>											ft_set;
+	typedef std::set<T, std::less<T>, alloc>										std_set;
+	typedef ft::unordered_map<T, int, ft::hash<T>, ft::equal_to<T>, ft_pair_alloc>	ft_unordered_map;
+	typedef std::tr1::unordered_map<T, int, std::tr1::hash<T>, std::equal_to<T>, std_pair_alloc>	std_unordered_map;
+	typedef ft::unordered_set<T, ft::hash<T>, ft::equal_to<T>, alloc>				ft_unordered_set;
+	typedef std::tr1::unordered_set<T, std::tr1::hash<T>, std::equal_to<T>, alloc>	std_unordered_set;
+	typedef ft::btree_map<T, int, ft::less<T>, ft_pair_alloc>						ft_btree_map;
+	typedef ft::btree_set<T, ft::less<T>, alloc>									ft_btree_set;
+};
+
+template <typename T>
+void run_type(const bench::options& opt, const char* type, size_t n) {
+	typedef counted<T> c;
+	key_set<T> ks(n);
+
+	vector_rows<typename c::ft_vector, typename c::std_vector>(opt, "vector", type, ks);
+	stack_rows<typename c::ft_stack, typename c::std_stack>(opt, "stack", type, ks);
+	ordered_rows<typename c::ft_map, typename c::std_map, map_like>(opt, "map", type, ks);
+	ordered_rows<typename c::ft_set, typename c::std_set, set_like>(opt, "set", type, ks);
+	hashed_rows<typename c::ft_unordered_map, typename c::std_unordered_map, map_like>(opt, "unordered_map", type, ks);
+	hashed_rows<typename c::ft_unordered_set, typename c::std_unordered_set, set_like>(opt, "unordered_set", type, ks);
+	ordered_rows<typename c::ft_btree_map, typename c::std_map, map_like>(opt, "btree_map", type, ks);
+	ordered_rows<typename c::ft_btree_set, typename c::std_set, set_like>(opt, "btree_set", type, ks);
+}
+
+int main(int argc, char** argv) {
+	bench::options opt;
+
+	if (!bench::parse_options(argc, argv, opt))
+		return 2;
+	if (bench::perf_counters* pc = bench::counters_for(opt)) {
+		for (size_t c = 0; c < bench::counter_count; c++)
+			if (!pc->available(c))
+				std::fprintf(stderr, "# counter %s unavailable%s%s\n", bench::counter_name(c),
+					pc->error().empty() ? "" : ": ", pc->error().c_str());
+	}
+	bench::print_header(opt);
+	for (size_t n = opt.min_size; n <= opt.max_size; n *= 10) {
+		run_type<int>(opt, "int", n);
+		run_type<pod64>(opt, "pod64", n);
+		run_type<std::string>(opt, "string", n);
+	}
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include "bench.hpp"
+#include "btree_map.hpp"
+#include "map.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+
+using bench::now_ms;
+using bench::xorshift;
+
+// random insert, random lookup and full in-order scan: ft::btree_map vs
+// ft::map (and std::map for reference) at several sizes.
+// usage: btree_map_bench [max_size]   (default 1000000)
+
+static void report(const std::string& container, const std::string& op, size_t n, size_t ops, double ms, long sink) {
+	std::cout << std::left << std::setw(16) << container << std::setw(10) << op
+		<< std::right << std::setw(10) << n
+		<< std::setw(12) << std::fixed << std::setprecision(2) << (ms * 1e6 / ops) << " ns/op"
+		<< "  (" << sink << ")" << std::endl;
+}
+
+template <typename Map, typename Pair>
+void run(const std::string& name, size_t n) {
+	const size_t ops = n < 1000000 ? 1000000 : n;
+	const unsigned long first_seed = 88172645463325252UL;
+	Map m;
+	unsigned long seed = first_seed;
+	long sink = 0;
+
+	double start = now_ms();
+	for (size_t i = 0; i < n; i++)
+		m.insert(Pair(static_cast<long>(xorshift(seed) >> 2), static_cast<long>(i)));
+	report(name, "insert", n, n, now_ms() - start, m.size());
+
+	start = now_ms();
+	for (size_t i = 0; i < ops; i++) {
+		if (i % n == 0)
+			seed = first_seed;
+		typename Map::iterator it = m.find(static_cast<long>(xorshift(seed) >> 2));
+		if (it != m.end())
+			sink += it->second;
+	}
+	report(name, "find", n, ops, now_ms() - start, sink);
+
+	size_t rounds = ops / n;
+	start = now_ms();
+	for (size_t r = 0; r < rounds; r++) {
+		for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it)
+			sink += it->second;
+	}
+	report(name, "scan", n, rounds * n, now_ms() - start, sink);
+}
+
+int main(int argc, char** argv) {
+	size_t max_size = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+
+	for (size_t n = 1000; n <= max_size; n *= 10) {
+		run<ft::btree_map<long, long>, ft::pair<long, long> >("ft::btree_map", n);
+		run<ft::map<long, long>, ft::pair<long, long> >("ft::map", n);
+		run<std::map<long, long>, std::pair<long, long> >("std::map", n);
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,218 @@
+#include "bench.hpp"
+
+#include "concurrent_queue.hpp"
+
+#include <algorithm>
+#include <pthread.h>
+#include <queue>
+#include <string>
+#include <vector>
+
+// handoff throughput through a bounded queue, 1 .. --max-threads producers
+// and as many consumers. --items longs in total per row, --capacity slots.
+//   mutex    std::queue behind a pthread mutex, one item per lock
+//   lockfree ft::concurrent_queue, try_push / try_pop
+//   batch    ft::concurrent_queue, try_push_n / try_pop_n of up to --batch items
+// A full or empty queue makes the thread back off (spin, then sched_yield).
+// Throughput is million items per second handed from producers to consumers.
+
+struct queue_options {
+	size_t	max_threads;
+	size_t	items;
+	size_t	capacity;
+	size_t	batch;
+
+	queue_options() : max_threads(32), items(4000000), capacity(1024), batch(32) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--max-threads N] [--items N] [--capacity N] [--batch N]\n"
+		<< "  --max-threads producers (and consumers) 1, 2, 4 .. N (default 32)\n"
+		<< "  --items items handed over per row (default 4000000)\n"
+		<< "  --capacity queue slots (default 1024)\n"
+		<< "  --batch items per try_push_n / try_pop_n (default 32)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, queue_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--max-threads")
+			opt.max_threads = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--items")
+			opt.items = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--capacity")
+			opt.capacity = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--batch")
+			opt.batch = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.max_threads == 0 || opt.items == 0 || opt.capacity == 0 || opt.batch == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// queues =====================================================================
+
+// push_some / pop_some move up to n items and return how many they moved
+
+class mutex_queue {
+	private:
+		pthread_mutex_t		_lock;
+		std::queue<long>	_items;
+		size_t				_capacity;
+
+	public:
+		explicit mutex_queue(size_t capacity) : _items(), _capacity(capacity) {
+			pthread_mutex_init(&_lock, NULL);
+		}
+		~mutex_queue() { pthread_mutex_destroy(&_lock); }
+
+		size_t push_some(const long* items, size_t) {
+			pthread_mutex_lock(&_lock);
+			bool room = _items.size() < _capacity;
+			if (room)
+				_items.push(*items);
+			pthread_mutex_unlock(&_lock);
+			return room ? 1 : 0;
+		}
+
+		size_t pop_some(long* out, size_t) {
+			pthread_mutex_lock(&_lock);
+			bool some = !_items.empty();
+			if (some) {
+				*out = _items.front();
+				_items.pop();
+			}
+			pthread_mutex_unlock(&_lock);
+			return some ? 1 : 0;
+		}
+};
+
+class lockfree_queue {
+	private:
+		ft::concurrent_queue<long>	_q;
+
+	public:
+		explicit lockfree_queue(size_t capacity) : _q(capacity) {}
+
+		size_t push_some(const long* items, size_t) { return _q.try_push(*items) ? 1 : 0; }
+		size_t pop_some(long* out, size_t) { return _q.try_pop(*out) ? 1 : 0; }
+};
+
+class batch_queue {
+	private:
+		ft::concurrent_queue<long>	_q;
+
+	public:
+		explicit batch_queue(size_t capacity) : _q(capacity) {}
+
+		size_t push_some(const long* items, size_t n) { return _q.try_push_n(items, n); }
+		size_t pop_some(long* out, size_t n) { return _q.try_pop_n(out, n); }
+};
+
+// workers ====================================================================
+
+template <typename Queue>
+struct shared_run {
+	Queue*				queue;
+	size_t				per_thread;		// items each producer pushes, each consumer pops
+	size_t				batch;
+	pthread_barrier_t	start;
+};
+
+template <typename Queue>
+struct worker_arg {
+	shared_run<Queue>*	run;
+	size_t				id;
+	bool				producer;
+	size_t				checksum;
+};
+
+template <typename Queue>
+void* worker(void* p) {
+	worker_arg<Queue>& arg = *static_cast<worker_arg<Queue>*>(p);
+	shared_run<Queue>& run = *arg.run;
+	std::vector<long> buf(run.batch);
+	size_t done = 0;
+	ft::backoff wait;
+
+	if (arg.producer)
+		for (size_t i = 0; i < buf.size(); i++)
+			buf[i] = static_cast<long>(arg.id * run.per_thread + i);
+	pthread_barrier_wait(&run.start);
+	while (done < run.per_thread) {
+		size_t want = std::min(run.batch, run.per_thread - done);
+		size_t moved = arg.producer ? run.queue->push_some(&buf[0], want) : run.queue->pop_some(&buf[0], want);
+		if (moved == 0) {
+			wait.pause();
+			continue;
+		}
+		wait.reset();
+		if (!arg.producer)
+			for (size_t i = 0; i < moved; i++)
+				arg.checksum += static_cast<size_t>(buf[i]);
+		done += moved;
+	}
+	return NULL;
+}
+
+// million items per second
+template <typename Queue>
+double measure(const queue_options& opt, size_t threads) {
+	Queue queue(opt.capacity);
+	shared_run<Queue> run;
+	run.queue = &queue;
+	run.per_thread = opt.items / threads;
+	run.batch = opt.batch;
+	pthread_barrier_init(&run.start, NULL, static_cast<unsigned>(2 * threads + 1));
+
+	std::vector<pthread_t> tids(2 * threads);
+	std::vector<worker_arg<Queue> > args(2 * threads);
+	for (size_t t = 0; t < 2 * threads; t++) {
+		args[t].run = &run;
+		args[t].id = t / 2;
+		args[t].producer = t % 2 == 0;
+		args[t].checksum = 0;
+		pthread_create(&tids[t], NULL, worker<Queue>, &args[t]);
+	}
+	pthread_barrier_wait(&run.start);
+	double start = bench::now_ns();
+	for (size_t t = 0; t < tids.size(); t++)
+		pthread_join(tids[t], NULL);
+	double elapsed = bench::now_ns() - start;
+
+	for (size_t t = 0; t < args.size(); t++)
+		bench::sink() += args[t].checksum;
+	pthread_barrier_destroy(&run.start);
+	return static_cast<double>(run.per_thread * threads) / elapsed * 1000.0;
+}
+
+int main(int argc, char** argv) {
+	queue_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::printf("# %lu items per row, capacity %lu, batch %lu; million items per second\n",
+		static_cast<unsigned long>(opt.items), static_cast<unsigned long>(opt.capacity),
+		static_cast<unsigned long>(opt.batch));
+	std::printf("%9s %9s %10s %10s %10s\n", "producers", "consumers", "mutex", "lockfree", "batch");
+	for (size_t threads = 1; threads <= opt.max_threads; threads *= 2) {
+		double locked = measure<mutex_queue>(opt, threads);
+		double lockfree = measure<lockfree_queue>(opt, threads);
+		double batched = measure<batch_queue>(opt, threads);
+		std::printf("%9lu %9lu %10.2f %10.2f %10.2f\n", static_cast<unsigned long>(threads),
+			static_cast<unsigned long>(threads), locked, lockfree, batched);
+	}
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
@@ -0,0 +1,671 @@
+#include "concurrent_queue.hpp"
+#include "parallel_algorithm.hpp"
+#include "spsc_queue.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <pthread.h>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// correctness under contention for the lock-free containers, meant to run
+// under ThreadSanitizer (make stress). Exits non-zero on the first failure.
+//   mpmc     --threads producers and as many consumers through a tiny
+//            concurrent_queue, mixing push, try_push, try_push_n and pop,
+//            try_pop_n, zero-length batches included: every item arrives
+//            exactly once, and each consumer sees every producer's items in
+//            the order they were pushed
+//   objects  the same with a type that counts its live copies: nothing is
+//            leaked or destroyed twice, including items left in the queue
+//   spsc     one producer and one consumer through a tiny spsc_queue, every
+//            call mixed with the batch calls: the items arrive exactly in
+//            order; then the objects check on an spsc_queue
+//   deque    the owner of a work_stealing_deque pushes and pops in bursts
+//            while --threads thieves steal: every item is taken exactly once
+//   pool     fib on a thread_pool of --threads workers, forking down to tiny
+//            tasks, from two outside threads at once; an exception out of
+//            one half of a parallel_invoke; and, in a child process run
+//            first, one out of a task stolen from another invoke, which must
+//            terminate
+//   par      ft::par sort, stable_sort, transform and reduce of --items values
+//            on a thread_pool of --threads workers, against the std algorithms
+
+struct stress_options {
+	size_t	threads;
+	size_t	items;
+	size_t	capacity;
+
+	stress_options() : threads(4), items(100000), capacity(8) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--threads N] [--items N] [--capacity N]\n"
+		<< "  --threads producers and consumers (default 4)\n"
+		<< "  --items items per producer (default 100000)\n"
+		<< "  --capacity queue slots, small to keep it full (default 8)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, stress_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--threads")
+			opt.threads = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--items")
+			opt.items = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--capacity")
+			opt.capacity = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.threads == 0 || opt.items == 0 || opt.capacity == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+static bool check(bool ok, const char* test, const char* what) {
+	if (!ok)
+		std::fprintf(stderr, "FAIL %s: %s\n", test, what);
+	return ok;
+}
+
+static unsigned long xorshift(unsigned long& s) {
+	s ^= s << 13;
+	s ^= s >> 7;
+	s ^= s << 17;
+	return s;
+}
+
+// mpmc =======================================================================
+
+// producer in the high half, its sequence number in the low half
+static unsigned long tag(size_t producer, size_t seq) {
+	return (static_cast<unsigned long>(producer) << 32) | seq;
+}
+
+struct mpmc_run {
+	ft::concurrent_queue<unsigned long>*	queue;
+	const stress_options*					opt;
+	std::vector<unsigned char>				seen;		// per item, bumped atomically
+	ft::atomic<size_t>						order_errors;
+	pthread_barrier_t						start;
+};
+
+struct mpmc_arg {
+	mpmc_run*	run;
+	size_t		id;
+};
+
+static void* mpmc_producer(void* p) {
+	mpmc_arg& arg = *static_cast<mpmc_arg*>(p);
+	mpmc_run& run = *arg.run;
+	unsigned long seed = 88172645463325252UL + arg.id;
+	unsigned long batch[16];
+	size_t seq = 0;
+
+	pthread_barrier_wait(&run.start);
+	while (seq < run.opt->items) {
+		unsigned long how = xorshift(seed) % 3;
+		if (how == 0)
+			run.queue->push(tag(arg.id, seq++));
+		else if (how == 1) {
+			if (run.queue->try_push(tag(arg.id, seq)))
+				seq++;
+		}
+		else {
+			size_t n = xorshift(seed) % 17;
+			if (n > run.opt->items - seq)
+				n = run.opt->items - seq;
+			for (size_t i = 0; i < n; i++)
+				batch[i] = tag(arg.id, seq + i);
+			seq += run.queue->try_push_n(batch, n);
+		}
+	}
+	return NULL;
+}
+
+static void* mpmc_consumer(void* p) {
+	mpmc_arg& arg = *static_cast<mpmc_arg*>(p);
+	mpmc_run& run = *arg.run;
+	unsigned long seed = 0x9E3779B97F4A7C15UL + arg.id;
+	unsigned long batch[16];
+	std::vector<long> last(run.opt->threads, -1);
+	size_t got = 0;
+
+	pthread_barrier_wait(&run.start);
+	while (got < run.opt->items) {
+		size_t n;
+		if (xorshift(seed) % 2 == 0) {
+			run.queue->pop(batch[0]);
+			n = 1;
+		}
+		else {
+			n = xorshift(seed) % 17;
+			if (n > run.opt->items - got)
+				n = run.opt->items - got;
+			n = run.queue->try_pop_n(batch, n);
+		}
+		for (size_t i = 0; i < n; i++) {
+			size_t producer = static_cast<size_t>(batch[i] >> 32);
+			long seq = static_cast<long>(batch[i] & 0xFFFFFFFFUL);
+			if (producer >= run.opt->threads || seq <= last[producer])
+				run.order_errors.fetch_add(1);
+			else {
+				last[producer] = seq;
+				__atomic_fetch_add(&run.seen[producer * run.opt->items + static_cast<size_t>(seq)], 1,
+					__ATOMIC_RELAXED);
+			}
+		}
+		got += n;
+	}
+	return NULL;
+}
+
+// zero-length batches claim nothing, on an empty queue and a non-empty one
+static bool test_mpmc_empty_batch(const stress_options& opt) {
+	ft::concurrent_queue<unsigned long> queue(opt.capacity);
+	unsigned long items[1] = { 42 };
+	unsigned long out[1] = { 0 };
+	bool ok = check(queue.try_push_n(items, 0) == 0 && queue.size_approx() == 0, "mpmc", "try_push_n(items, 0) pushed");
+	ok = check(queue.try_pop_n(out, 0) == 0 && out[0] == 0, "mpmc", "try_pop_n(out, 0) on an empty queue popped") && ok;
+	queue.push(7);
+	ok = check(queue.try_push_n(items, 0) == 0 && queue.size_approx() == 1, "mpmc", "try_push_n(items, 0) pushed") && ok;
+	ok = check(queue.try_pop_n(out, 0) == 0 && out[0] == 0 && queue.size_approx() == 1, "mpmc",
+		"try_pop_n(out, 0) popped") && ok;
+	return ok;
+}
+
+static bool test_mpmc(const stress_options& opt) {
+	if (!test_mpmc_empty_batch(opt))
+		return false;
+	ft::concurrent_queue<unsigned long> queue(opt.capacity);
+	mpmc_run run;
+	run.queue = &queue;
+	run.opt = &opt;
+	run.seen.assign(opt.threads * opt.items, 0);
+	pthread_barrier_init(&run.start, NULL, static_cast<unsigned>(2 * opt.threads));
+
+	std::vector<pthread_t> tids(2 * opt.threads);
+	std::vector<mpmc_arg> args(2 * opt.threads);
+	for (size_t t = 0; t < tids.size(); t++) {
+		args[t].run = &run;
+		args[t].id = t / 2;
+		pthread_create(&tids[t], NULL, t % 2 == 0 ? mpmc_producer : mpmc_consumer, &args[t]);
+	}
+	for (size_t t = 0; t < tids.size(); t++)
+		pthread_join(tids[t], NULL);
+	pthread_barrier_destroy(&run.start);
+
+	size_t wrong = 0;
+	for (size_t i = 0; i < run.seen.size(); i++)
+		wrong += run.seen[i] != 1;
+	bool ok = check(run.order_errors.load() == 0, "mpmc", "a producer's items were seen out of order");
+	ok = check(wrong == 0, "mpmc", "an item was lost or delivered twice") && ok;
+	return check(queue.size_approx() == 0, "mpmc", "items left over") && ok;
+}
+
+// objects ====================================================================
+
+static ft::atomic<long>	g_live;
+
+struct tracked {
+	unsigned long	value;
+	tracked*		self;		// detects copies that skipped the constructor
+
+	tracked() : value(0), self(this) { g_live.fetch_add(1); }
+	explicit tracked(unsigned long v) : value(v), self(this) { g_live.fetch_add(1); }
+	tracked(const tracked& other) : value(other.value), self(this) { g_live.fetch_add(1); }
+	tracked& operator=(const tracked& other) {
+		value = other.value;
+		return *this;
+	}
+	~tracked() {
+		if (self == this)
+			g_live.fetch_sub(1);
+		self = NULL;
+	}
+};
+
+template <typename Queue>
+struct objects_run {
+	Queue*						queue;
+	size_t						items;
+	ft::atomic<unsigned long>	sum;
+};
+
+template <typename Queue>
+void* objects_producer(void* p) {
+	objects_run<Queue>& run = *static_cast<objects_run<Queue>*>(p);
+	for (size_t i = 1; i <= run.items; i++)
+		run.queue->push(tracked(i));
+	return NULL;
+}
+
+template <typename Queue>
+void* objects_consumer(void* p) {
+	objects_run<Queue>& run = *static_cast<objects_run<Queue>*>(p);
+	tracked t;
+	// leaves a quarter of the items in the queue for its destructor
+	for (size_t i = 0; i < run.items - run.items / 4; i++) {
+		run.queue->pop(t);
+		run.sum.fetch_add(t.value);
+	}
+	return NULL;
+}
+
+template <typename Queue>
+bool test_objects(const stress_options& opt, const char* test) {
+	size_t items = opt.items;
+	unsigned long popped;
+	{
+		// just big enough for what the consumer leaves behind
+		Queue queue(items / 4 + 1);
+		objects_run<Queue> run;
+		run.queue = &queue;
+		run.items = items;
+		pthread_t producer;
+		pthread_t consumer;
+		pthread_create(&producer, NULL, objects_producer<Queue>, &run);
+		pthread_create(&consumer, NULL, objects_consumer<Queue>, &run);
+		pthread_join(producer, NULL);
+		pthread_join(consumer, NULL);
+		popped = run.sum.load();
+	}
+	unsigned long n = items - items / 4;
+	bool ok = check(popped == n * (n + 1) / 2, test, "wrong items popped");
+	return check(g_live.load() == 0, test, "live copies after the queue was destroyed") && ok;
+}
+
+// spsc =======================================================================
+
+struct spsc_run {
+	ft::spsc_queue<unsigned long>*	queue;
+	size_t							items;
+	size_t							order_errors;
+};
+
+static void* spsc_producer(void* p) {
+	spsc_run& run = *static_cast<spsc_run*>(p);
+	unsigned long seed = 88172645463325252UL;
+	unsigned long batch[16];
+
+	for (size_t seq = 0; seq < run.items;) {
+		unsigned long how = xorshift(seed) % 4;
+		size_t n = 1 + xorshift(seed) % 16;
+		if (n > run.items - seq)
+			n = run.items - seq;
+		for (size_t i = 0; i < n; i++)
+			batch[i] = seq + i;
+		if (how == 0) {
+			run.queue->push(batch[0]);
+			n = 1;
+		}
+		else if (how == 1)
+			n = run.queue->try_push(batch[0]) ? 1 : 0;
+		else if (how == 2)
+			n = run.queue->try_push_n(batch, n);
+		else
+			run.queue->push_n(batch, n);
+		seq += n;
+	}
+	return NULL;
+}
+
+static void* spsc_consumer(void* p) {
+	spsc_run& run = *static_cast<spsc_run*>(p);
+	unsigned long seed = 0x9E3779B97F4A7C15UL;
+	unsigned long batch[16];
+
+	for (size_t expect = 0; expect < run.items;) {
+		unsigned long how = xorshift(seed) % 4;
+		size_t n = 1 + xorshift(seed) % 16;
+		if (n > run.items - expect)
+			n = run.items - expect;
+		if (how == 0) {
+			run.queue->pop(batch[0]);
+			n = 1;
+		}
+		else if (how == 1)
+			n = run.queue->try_pop(batch[0]) ? 1 : 0;
+		else if (how == 2)
+			n = run.queue->try_pop_n(batch, n);
+		else
+			run.queue->pop_n(batch, n);
+		for (size_t i = 0; i < n; i++)
+			run.order_errors += batch[i] != expect + i;
+		expect += n;
+	}
+	return NULL;
+}
+
+static bool test_spsc(const stress_options& opt) {
+	ft::spsc_queue<unsigned long> queue(opt.capacity);
+	spsc_run run;
+	run.queue = &queue;
+	run.items = opt.items * opt.threads;
+	run.order_errors = 0;
+	pthread_t producer;
+	pthread_t consumer;
+	pthread_create(&producer, NULL, spsc_producer, &run);
+	pthread_create(&consumer, NULL, spsc_consumer, &run);
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+	bool ok = check(run.order_errors == 0, "spsc", "items lost, repeated or out of order");
+	return check(queue.size_approx() == 0, "spsc", "items left over") && ok;
+}
+
+// deque ======================================================================
+
+struct deque_run {
+	ft::work_stealing_deque<unsigned long>*	deque;
+	size_t									items;
+	std::vector<unsigned char>				taken;		// per item, bumped atomically
+	ft::atomic<int>							finished;
+};
+
+static void take(deque_run& run, unsigned long item) {
+	__atomic_fetch_add(&run.taken[item], 1, __ATOMIC_RELAXED);
+}
+
+static void* deque_thief(void* p) {
+	deque_run& run = *static_cast<deque_run*>(p);
+	unsigned long item;
+	while (!run.finished.load(ft::memory_order_acquire)) {
+		if (run.deque->steal(item))
+			take(run, item);
+		else
+			ft::cpu_relax();
+	}
+	return NULL;
+}
+
+static bool test_deque(const stress_options& opt) {
+	// starts tiny so the ring grows while thieves read it
+	ft::work_stealing_deque<unsigned long> deque(2);
+	deque_run run;
+	run.deque = &deque;
+	run.items = opt.items * opt.threads;
+	run.taken.assign(run.items, 0);
+	run.finished.store(0);
+	std::vector<pthread_t> thieves(opt.threads);
+	for (size_t t = 0; t < thieves.size(); t++)
+		pthread_create(&thieves[t], NULL, deque_thief, &run);
+
+	unsigned long seed = 88172645463325252UL;
+	unsigned long item;
+	for (size_t next = 0; next < run.items;) {
+		size_t burst = 1 + xorshift(seed) % 64;
+		for (size_t i = 0; i < burst && next < run.items; i++)
+			deque.push(next++);
+		size_t pops = xorshift(seed) % (burst + 1);
+		for (size_t i = 0; i < pops && deque.pop(item); i++)
+			take(run, item);
+	}
+	while (deque.pop(item))
+		take(run, item);
+	// a thief may still hold the last item it stole
+	while (!deque.empty_approx())
+		ft::cpu_relax();
+	run.finished.store(1, ft::memory_order_release);
+	for (size_t t = 0; t < thieves.size(); t++)
+		pthread_join(thieves[t], NULL);
+
+	size_t wrong = 0;
+	for (size_t i = 0; i < run.taken.size(); i++)
+		wrong += run.taken[i] != 1;
+	return check(wrong == 0, "deque", "an item was lost or taken twice");
+}
+
+// pool =======================================================================
+
+struct fib_task {
+	long	n;
+	long	result;
+
+	explicit fib_task(long num) : n(num), result(0) {}
+
+	void operator()() {
+		if (n < 2) {
+			result = n;
+			return;
+		}
+		fib_task a(n - 1);
+		fib_task b(n - 2);
+		ft::parallel_invoke(a, b);
+		result = a.result + b.result;
+	}
+};
+
+struct fib_caller {
+	ft::thread_pool*	pool;
+	size_t				rounds;
+	size_t				wrong;
+};
+
+static void* fib_outside(void* p) {
+	fib_caller& caller = *static_cast<fib_caller*>(p);
+	for (size_t r = 0; r < caller.rounds; r++) {
+		fib_task t(18);
+		caller.pool->run(t);
+		caller.wrong += t.result != 2584;
+	}
+	return NULL;
+}
+
+struct thrower {
+	void operator()() { throw std::runtime_error("half"); }
+};
+
+struct throw_half {
+	bool	caught;
+	long	other;
+
+	throw_half() : caught(false), other(0) {}
+
+	void operator()() {
+		thrower bad;
+		fib_task good(15);
+		try {
+			ft::parallel_invoke(bad, good);
+		}
+		catch (const std::runtime_error&) {
+			caught = true;
+		}
+		other = good.result;
+	}
+};
+
+// Root runs invoke(left, right) on a pool of two workers. left waits until
+// the other worker has stolen right, which forks again: right_a waits, and
+// right_b, taken by Root's worker while it waits for right, throws. That
+// exception belongs to right's invoke, still running on the other worker, so
+// it must end the program rather than unwind Root.
+struct steal_flags {
+	ft::atomic<int>	right_started;
+	ft::atomic<int>	right_b_started;
+
+	steal_flags() : right_started(0), right_b_started(0) {}
+};
+
+struct wait_for {
+	ft::atomic<int>*	flag;
+	void operator()() {
+		ft::backoff wait;
+		while (flag->load(ft::memory_order_acquire) == 0)
+			wait.pause();
+	}
+};
+
+struct right_b_throws {
+	steal_flags*	flags;
+	void operator()() {
+		flags->right_b_started.store(1, ft::memory_order_release);
+		throw std::runtime_error("from right_b");
+	}
+};
+
+struct stolen_right {
+	steal_flags*	flags;
+	void operator()() {
+		flags->right_started.store(1, ft::memory_order_release);
+		wait_for right_a = { &flags->right_b_started };
+		right_b_throws right_b = { flags };
+		ft::parallel_invoke(right_a, right_b);
+	}
+};
+
+struct root_catches {
+	steal_flags*	flags;
+	void operator()() {
+		wait_for left = { &flags->right_started };
+		stolen_right right = { flags };
+		try {
+			ft::parallel_invoke(left, right);
+		}
+		catch (...) {
+			// the bug: right_b's exception came out of the wrong invoke
+			_exit(1);
+		}
+	}
+};
+
+static void exit_terminated() {
+	_exit(3);
+}
+
+// in a child process, which std::terminate has to end with exit code 3; a
+// hang is cut short by SIGALRM
+static bool test_pool_terminate() {
+	std::fflush(NULL);
+	pid_t pid = fork();
+	if (pid < 0)
+		return check(false, "pool", "fork failed");
+	if (pid == 0) {
+		alarm(10);
+		std::set_terminate(exit_terminated);
+		steal_flags flags;
+		ft::thread_pool pool(2);
+		root_catches root = { &flags };
+		pool.run(root);
+		_exit(0);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	return check(WIFEXITED(status) && WEXITSTATUS(status) == 3, "pool",
+		"an exception from another invoke's task did not call std::terminate");
+}
+
+static bool test_pool(const stress_options& opt) {
+	ft::thread_pool pool(opt.threads);
+	fib_caller callers[2];
+	pthread_t tids[2];
+	for (size_t i = 0; i < 2; i++) {
+		callers[i].pool = &pool;
+		callers[i].rounds = 1 + opt.items / 20000;
+		callers[i].wrong = 0;
+		pthread_create(&tids[i], NULL, fib_outside, &callers[i]);
+	}
+	for (size_t i = 0; i < 2; i++)
+		pthread_join(tids[i], NULL);
+	bool ok = check(callers[0].wrong + callers[1].wrong == 0, "pool", "wrong fib result");
+
+	throw_half t;
+	pool.run(t);
+	ok = check(t.caught, "pool", "exception lost") && ok;
+	return check(t.other == 610, "pool", "the other half did not finish") && ok;
+}
+
+// par ========================================================================
+
+struct entry {
+	long	key;
+	long	position;
+};
+
+struct by_key {
+	bool operator()(const entry& a, const entry& b) const { return a.key < b.key; }
+};
+
+struct same_entry {
+	bool operator()(const entry& a, const entry& b) const { return a.key == b.key && a.position == b.position; }
+};
+
+struct square {
+	long operator()(long x) const { return x * x; }
+};
+
+struct par_checks {
+	size_t	n;
+	bool	ok;
+
+	void operator()() {
+		unsigned long seed = 88172645463325252UL;
+		ft::vector<long> keys(n);
+		std::vector<entry> entries(n);
+		for (size_t i = 0; i < n; i++) {
+			keys[i] = static_cast<long>(xorshift(seed) % 100000);
+			entries[i].key = keys[i] % 64;
+			entries[i].position = static_cast<long>(i);
+		}
+		std::vector<long> sorted(&keys[0], &keys[0] + n);
+		std::sort(sorted.begin(), sorted.end());
+		ft::par::sort(keys.begin(), keys.end());
+		ok = check(std::equal(sorted.begin(), sorted.end(), &keys[0]), "par", "sort") && ok;
+
+		std::vector<entry> stable(entries);
+		std::stable_sort(stable.begin(), stable.end(), by_key());
+		ft::par::stable_sort(entries.begin(), entries.end(), by_key());
+		ok = check(std::equal(stable.begin(), stable.end(), entries.begin(), same_entry()), "par", "stable_sort") && ok;
+
+		ft::vector<long> squares(n);
+		ft::par::transform(keys.begin(), keys.end(), squares.begin(), square());
+		long expect = 0;
+		for (size_t i = 0; i < n; i++)
+			expect += keys[i] * keys[i];
+		ok = check(ft::par::reduce(squares.begin(), squares.end(), 0L) == expect, "par", "transform and reduce") && ok;
+	}
+};
+
+static bool test_par(const stress_options& opt) {
+	ft::thread_pool pool(opt.threads);
+	par_checks c;
+	c.n = opt.items;
+	c.ok = true;
+	pool.run(c);
+	return c.ok;
+}
+
+int main(int argc, char** argv) {
+	stress_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	// first: ThreadSanitizer does not let a child forked from a process that
+	// has started threads start any of its own
+	bool ok = test_pool_terminate();
+	ok = test_mpmc(opt) && ok;
+	ok = test_objects<ft::concurrent_queue<tracked> >(opt, "objects") && ok;
+	ok = test_spsc(opt) && ok;
+	ok = test_objects<ft::spsc_queue<tracked> >(opt, "spsc objects") && ok;
+	ok = test_deque(opt) && ok;
+	ok = test_pool(opt) && ok;
+	ok = test_par(opt) && ok;
+	std::printf("%s\n", ok ? "stress OK" : "stress FAILED");
+	return ok ? 0 : 1;
+}
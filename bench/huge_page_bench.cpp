@@ -0,0 +1,206 @@
+#include "bench.hpp"
+
+#include "huge_pages.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// random lookups into containers too big for the TLB, on 4 KB pages and on
+// 2 MB pages (huge_pages.hpp):
+//   vector   --vector-mb of longs, random reads; std::allocator vs huge_page_allocator
+//   map      --map-keys entries, random finds; pmr::map over a pool whose upstream is
+//            new_delete_resource() or a huge_page_resource
+// "huge_mb" is how much of the process the kernel actually backs with huge
+// pages (AnonHugePages in /proc/self/smaps_rollup) while the container is
+// alive; 0 means THP is off or refused the advice and the run measured 4 KB
+// pages twice. dTLB misses per lookup come from perf_event_open, "-" where
+// the kernel does not expose the event.
+
+using bench::xorshift;
+
+struct huge_options {
+	size_t	vector_mb;
+	size_t	map_keys;
+	size_t	lookups;
+
+	huge_options() : vector_mb(512), map_keys(2000000), lookups(4000000) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--vector-mb N] [--map-keys N] [--lookups N]\n"
+		<< "  --vector-mb size of the vector in MB (default 512)\n"
+		<< "  --map-keys entries in the map (default 2000000)\n"
+		<< "  --lookups random lookups per row (default 4000000)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, huge_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--vector-mb")
+			opt.vector_mb = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--map-keys")
+			opt.map_keys = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--lookups")
+			opt.lookups = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.vector_mb == 0 || opt.map_keys == 0 || opt.lookups == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// kB of anonymous memory on huge pages, -1 if the kernel does not say
+static long anon_huge_kb() {
+	FILE* f = std::fopen("/proc/self/smaps_rollup", "r");
+	if (f == NULL)
+		return -1;
+	char line[256];
+	long kb = -1;
+	while (std::fgets(line, sizeof(line), f) != NULL)
+		if (std::strncmp(line, "AnonHugePages:", 14) == 0)
+			kb = std::strtol(line + 14, NULL, 10);
+	std::fclose(f);
+	return kb;
+}
+
+static std::string thp_mode() {
+	FILE* f = std::fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+	if (f == NULL)
+		return "unavailable";
+	char line[128] = "";
+	if (std::fgets(line, sizeof(line), f) == NULL)
+		line[0] = '\0';
+	std::fclose(f);
+	std::string s(line);
+	size_t open = s.find('[');
+	size_t close = s.find(']');
+	if (open == std::string::npos || close == std::string::npos || close < open)
+		return "unknown";
+	return s.substr(open + 1, close - open - 1);
+}
+
+// report =====================================================================
+
+struct row {
+	double	mlookups;		// million lookups per second
+	double	dtlb;			// dTLB read misses per lookup, -1 unavailable
+	long	huge_kb;
+};
+
+static void print_row(const char* container, const char* pages, const row& r) {
+	std::printf("%-9s %-6s %12.2f", container, pages, r.mlookups);
+	if (r.dtlb < 0)
+		std::printf(" %10s", "-");
+	else
+		std::printf(" %10.3f", r.dtlb);
+	if (r.huge_kb < 0)
+		std::printf(" %8s\n", "-");
+	else
+		std::printf(" %8ld\n", r.huge_kb / 1024);
+}
+
+template <typename Lookup>
+row time_lookups(const Lookup& lookup, const std::vector<long>& probes) {
+	static bench::perf_counters pc;
+	double counters[bench::counter_count];
+	row r;
+	r.huge_kb = anon_huge_kb();
+	size_t sum = 0;
+	pc.start();
+	double start = bench::now_ns();
+	for (size_t i = 0; i < probes.size(); i++)
+		sum += lookup(probes[i]);
+	double elapsed = bench::now_ns() - start;
+	pc.stop(counters);
+	bench::sink() += sum;
+	r.mlookups = static_cast<double>(probes.size()) / elapsed * 1000.0;
+	r.dtlb = counters[bench::dtlb_misses] < 0 ? -1 : counters[bench::dtlb_misses] / static_cast<double>(probes.size());
+	return r;
+}
+
+// vector =====================================================================
+
+template <typename Vec>
+struct vector_lookup {
+	const Vec& v;
+	explicit vector_lookup(const Vec& vec) : v(vec) {}
+	size_t operator()(long i) const { return static_cast<size_t>(v[static_cast<size_t>(i)]); }
+};
+
+template <typename Vec>
+row vector_row(const huge_options& opt) {
+	size_t n = opt.vector_mb * 1024 * 1024 / sizeof(long);
+	Vec v;
+	v.reserve(n);
+	for (size_t i = 0; i < n; i++)
+		v.push_back(static_cast<long>(i));
+	unsigned long seed = 88172645463325252UL;
+	std::vector<long> probes(opt.lookups);
+	for (size_t i = 0; i < probes.size(); i++)
+		probes[i] = static_cast<long>(xorshift(seed) % n);
+	return time_lookups(vector_lookup<Vec>(v), probes);
+}
+
+// map ========================================================================
+
+typedef ft::pmr::map<long, long>::type	pmr_map;
+
+struct map_lookup {
+	const pmr_map& m;
+	explicit map_lookup(const pmr_map& map) : m(map) {}
+	size_t operator()(long k) const {
+		pmr_map::const_iterator it = m.find(k);
+		return it == m.end() ? 0 : static_cast<size_t>(it->second);
+	}
+};
+
+static row map_row(const huge_options& opt, ft::pmr::memory_resource* upstream) {
+	ft::pmr::unsynchronized_pool_resource pool(upstream);
+	row r;
+	{
+		pmr_map m((ft::less<long>()), &pool);
+		unsigned long seed = 0x9E3779B97F4A7C15UL;
+		std::vector<long> keys(opt.map_keys);
+		for (size_t i = 0; i < keys.size(); i++) {
+			keys[i] = static_cast<long>(xorshift(seed) % (4 * keys.size()));
+			m.insert(ft::make_pair(keys[i], static_cast<long>(i)));
+		}
+		std::vector<long> probes(opt.lookups);
+		for (size_t i = 0; i < probes.size(); i++)
+			probes[i] = keys[xorshift(seed) % keys.size()];
+		r = time_lookups(map_lookup(m), probes);
+	}
+	return r;
+}
+
+int main(int argc, char** argv) {
+	huge_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::printf("# THP mode %s; vector %lu MB, map %lu keys, %lu random lookups per row\n", thp_mode().c_str(),
+		static_cast<unsigned long>(opt.vector_mb), static_cast<unsigned long>(opt.map_keys),
+		static_cast<unsigned long>(opt.lookups));
+	std::printf("%-9s %-6s %12s %10s %8s\n", "container", "pages", "Mlookups/s", "dtlb/op", "huge_mb");
+	print_row("vector", "4k", vector_row<ft::vector<long> >(opt));
+	print_row("vector", "2m", vector_row<ft::vector<long, ft::huge_page_allocator<long> > >(opt));
+	print_row("map", "4k", map_row(opt, ft::pmr::new_delete_resource()));
+	{
+		ft::pmr::huge_page_resource huge;
+		print_row("map", "2m", map_row(opt, &huge));
+	}
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
@@ -0,0 +1,230 @@
+#include "bench.hpp"
+#include "latency_histogram.hpp"
+
+#include "vector.hpp"
+#include "map.hpp"
+#include "unordered_map.hpp"
+#include "btree_map.hpp"
+
+#include <map>
+#include <string>
+#include <tr1/unordered_map>
+#include <vector>
+
+// per-operation latency: every operation is timed on its own with
+// clock_gettime into a latency_histogram, and each row reports the tail
+// (p50 .. p99.9, max) in nanoseconds instead of an average. This is where the
+// vector reallocation copies, hash table rehashes and clear() of large trees
+// show up. "mix" interleaves growth and lookups the way a service does:
+// --mix lookups of already inserted keys after every insert.
+// The timer's own cost is in every sample; the "timer" row measures it.
+
+using bench::xorshift;
+
+struct latency_options {
+	size_t		n;
+	size_t		mix;
+	size_t		rounds;
+	std::string	filter;
+
+	latency_options() : n(1000000), mix(4), rounds(5), filter() {}
+
+	bool selected(const std::string& name) const {
+		return filter.empty() || name.find(filter) != std::string::npos;
+	}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--n N] [--mix K] [--rounds R] [--filter STR]\n"
+		<< "  --n elements per run (default 1000000)\n"
+		<< "  --mix lookups per insert in the mixed workload (default 4)\n"
+		<< "  --rounds times each container is filled (default 5); insert, push_back and clear\n"
+		<< "    are sampled every round, find and erase only in the first\n"
+		<< "  --filter keeps rows whose \"container/op\" contains STR" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, latency_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--n")
+			opt.n = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--mix")
+			opt.mix = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--rounds")
+			opt.rounds = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--filter")
+			opt.filter = val;
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.n == 0 || opt.rounds == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+static inline unsigned long tick() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long>(ts.tv_sec) * 1000000000UL + static_cast<unsigned long>(ts.tv_nsec);
+}
+
+// report =====================================================================
+
+static void print_header() {
+	std::printf("%-20s %-10s %9s %10s %10s %10s %10s %10s %10s %12s\n",
+		"container", "op", "count", "min", "p50", "p90", "p99", "p99.9", "max", "mean");
+}
+
+static void print_row(const std::string& container, const std::string& op, const bench::latency_histogram& h) {
+	std::printf("%-20s %-10s %9lu %10lu %10lu %10lu %10lu %10lu %10lu %12.1f\n",
+		container.c_str(), op.c_str(), static_cast<unsigned long>(h.count()), h.min(),
+		h.percentile(50), h.percentile(90), h.percentile(99), h.percentile(99.9), h.max(), h.mean());
+	std::fflush(stdout);
+}
+
+// keys =======================================================================
+
+// 0, 2, .. 2n-2 shuffled; odd keys are never inserted
+static std::vector<long> make_keys(size_t n, unsigned long seed) {
+	std::vector<long> keys(n);
+	for (size_t i = 0; i < n; i++)
+		keys[i] = static_cast<long>(i) * 2;
+	for (size_t i = n; i > 1; i--)
+		std::swap(keys[i - 1], keys[xorshift(seed) % i]);
+	return keys;
+}
+
+// workloads ==================================================================
+
+static void timer_rows(const latency_options& opt) {
+	if (!opt.selected("timer/empty"))
+		return;
+	bench::latency_histogram h;
+	for (size_t i = 0; i < opt.n; i++) {
+		unsigned long start = tick();
+		h.record(tick() - start);
+	}
+	print_row("timer", "empty", h);
+}
+
+template <typename Vector>
+void vector_rows(const latency_options& opt, const std::string& name) {
+	if (!opt.selected(name + "/push_back"))
+		return;
+	bench::latency_histogram h;
+	for (size_t r = 0; r < opt.rounds; r++) {
+		Vector v;
+		for (size_t i = 0; i < opt.n; i++) {
+			unsigned long start = tick();
+			v.push_back(static_cast<long>(i));
+			h.record(tick() - start);
+		}
+		bench::sink() += v.size();
+	}
+	print_row(name, "push_back", h);
+}
+
+template <typename Map>
+void map_rows(const latency_options& opt, const std::string& name,
+	const std::vector<long>& keys, const std::vector<long>& lookups) {
+	bench::latency_histogram insert, find, erase, clear;
+	for (size_t r = 0; r < opt.rounds; r++) {
+		Map m;
+		for (size_t i = 0; i < keys.size(); i++) {
+			unsigned long start = tick();
+			m.insert(typename Map::value_type(keys[i], static_cast<long>(i)));
+			insert.record(tick() - start);
+		}
+		if (r == 0) {
+			size_t sum = 0;
+			for (size_t i = 0; i < lookups.size(); i++) {
+				unsigned long start = tick();
+				sum += m.find(lookups[i])->second;
+				find.record(tick() - start);
+			}
+			bench::sink() += sum;
+			Map copy(m);
+			for (size_t i = 0; i < lookups.size(); i++) {
+				unsigned long start = tick();
+				copy.erase(lookups[i]);
+				erase.record(tick() - start);
+			}
+		}
+		unsigned long start = tick();
+		m.clear();
+		clear.record(tick() - start);
+	}
+	if (opt.selected(name + "/insert"))
+		print_row(name, "insert", insert);
+	if (opt.selected(name + "/find"))
+		print_row(name, "find", find);
+	if (opt.selected(name + "/erase"))
+		print_row(name, "erase", erase);
+	if (opt.selected(name + "/clear"))
+		print_row(name, "clear", clear);
+}
+
+// growth with lookups in between: after each insert, opt.mix finds of keys
+// inserted so far (uniformly chosen, so early keys are not favoured)
+template <typename Map>
+void mix_rows(const latency_options& opt, const std::string& name, const std::vector<long>& keys) {
+	if (!opt.selected(name + "/mix"))
+		return;
+	bench::latency_histogram insert, find;
+	unsigned long seed = 0x2545F4914F6CDD1DUL;
+	Map m;
+	size_t sum = 0;
+	for (size_t i = 0; i < keys.size(); i++) {
+		unsigned long start = tick();
+		m.insert(typename Map::value_type(keys[i], static_cast<long>(i)));
+		insert.record(tick() - start);
+		for (size_t j = 0; j < opt.mix; j++) {
+			long key = keys[xorshift(seed) % (i + 1)];
+			start = tick();
+			sum += m.find(key)->second;
+			find.record(tick() - start);
+		}
+	}
+	bench::sink() += sum;
+	print_row(name, "mix_insert", insert);
+	print_row(name, "mix_find", find);
+}
+
+template <typename Map>
+void assoc_rows(const latency_options& opt, const std::string& name,
+	const std::vector<long>& keys, const std::vector<long>& lookups) {
+	map_rows<Map>(opt, name, keys, lookups);
+	mix_rows<Map>(opt, name, keys);
+}
+
+int main(int argc, char** argv) {
+	latency_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::vector<long> keys = make_keys(opt.n, 88172645463325252UL);
+	std::vector<long> lookups = make_keys(opt.n, 0x9E3779B97F4A7C15UL);
+
+	std::printf("# n %lu, mix %lu, rounds %lu; nanoseconds per operation\n",
+		static_cast<unsigned long>(opt.n), static_cast<unsigned long>(opt.mix), static_cast<unsigned long>(opt.rounds));
+	print_header();
+	timer_rows(opt);
+	vector_rows<ft::vector<long> >(opt, "ft::vector");
+	vector_rows<std::vector<long> >(opt, "std::vector");
+	assoc_rows<ft::map<long, long> >(opt, "ft::map", keys, lookups);
+	assoc_rows<std::map<long, long> >(opt, "std::map", keys, lookups);
+	assoc_rows<ft::unordered_map<long, long> >(opt, "ft::unordered_map", keys, lookups);
+	assoc_rows<std::tr1::unordered_map<long, long> >(opt, "tr1::unordered_map", keys, lookups);
+	assoc_rows<ft::btree_map<long, long> >(opt, "ft::btree_map", keys, lookups);
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
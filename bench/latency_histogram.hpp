@@ -0,0 +1,101 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// HdrHistogram-style log-bucketed latency histogram. Values below
+// sub_bucket_count are kept exactly; above that every power of two is split
+// into sub_bucket_count / 2 linear buckets, so any recorded value is known to
+// within 1 / 64 of itself while the whole 64-bit range fits in ~3800 counters.
+
+namespace bench {
+
+	class latency_histogram {
+		public:
+			static const unsigned long	sub_bucket_bits = 7;
+			static const unsigned long	sub_bucket_count = 1UL << sub_bucket_bits;
+			static const unsigned long	sub_bucket_half = sub_bucket_count / 2;
+
+		private:
+			std::vector<size_t>	_counts;
+			size_t				_total;
+			unsigned long		_min;
+			unsigned long		_max;
+			double				_sum;
+
+			static unsigned long msb(unsigned long v) {
+				return sizeof(unsigned long) * 8 - 1 - __builtin_clzl(v);
+			}
+
+			static size_t index_of(unsigned long v) {
+				if (v < sub_bucket_count)
+					return v;
+				// v >> shift lands in [sub_bucket_half, sub_bucket_count)
+				unsigned long shift = msb(v) - (sub_bucket_bits - 1);
+				return sub_bucket_count + (shift - 1) * sub_bucket_half + ((v >> shift) - sub_bucket_half);
+			}
+
+			// largest value that lands in the same bucket as index i
+			static unsigned long highest_equivalent(size_t i) {
+				if (i < sub_bucket_count)
+					return i;
+				size_t k = i - sub_bucket_count;
+				unsigned long shift = k / sub_bucket_half + 1;
+				unsigned long sub = k % sub_bucket_half + sub_bucket_half;
+				return ((sub + 1) << shift) - 1;
+			}
+
+		public:
+			latency_histogram()
+				: _counts(sub_bucket_count + (sizeof(unsigned long) * 8 - sub_bucket_bits) * sub_bucket_half, 0),
+				_total(0), _min(0), _max(0), _sum(0) {}
+
+			void record(unsigned long value) {
+				_counts[index_of(value)]++;
+				if (_total == 0 || value < _min)
+					_min = value;
+				if (value > _max)
+					_max = value;
+				_total++;
+				_sum += static_cast<double>(value);
+			}
+
+			void reset() {
+				std::fill(_counts.begin(), _counts.end(), 0);
+				_total = 0;
+				_min = 0;
+				_max = 0;
+				_sum = 0;
+			}
+
+			size_t			count() const { return _total; }
+			unsigned long	min() const { return _min; }
+			unsigned long	max() const { return _max; }
+			double			mean() const { return _total ? _sum / static_cast<double>(_total) : 0; }
+
+			// smallest recorded bucket covering p percent of the samples, as its
+			// highest equivalent value (clamped to the exact max); p in [0, 100]
+			unsigned long percentile(double p) const {
+				if (_total == 0)
+					return 0;
+				size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(_total) + 0.5);
+				if (rank < 1)
+					rank = 1;
+				if (rank > _total)
+					rank = _total;
+				size_t seen = 0;
+				for (size_t i = 0; i < _counts.size(); i++) {
+					seen += _counts[i];
+					if (seen >= rank) {
+						unsigned long v = highest_equivalent(i);
+						return v < _max ? v : _max;
+					}
+				}
+				return _max;
+			}
+	};
+}
+
+#endif
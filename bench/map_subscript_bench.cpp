@@ -0,0 +1,86 @@
+#include "bench.hpp"
+#include "map.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <string>
+
+using bench::now_ms;
+using bench::xorshift;
+
+// read-heavy operator[] with std::string values: 95% of the calls hit an
+// existing key and only read it, 5% overwrite it. "insert" emulates the old
+// operator[], which built make_pair(k, mapped_type()) and a node on every call.
+
+static size_t g_allocations = 0;
+
+void* operator new(std::size_t n) throw(std::bad_alloc) {
+	g_allocations++;
+	void* p = std::malloc(n ? n : 1);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+// kept out of line so gcc does not see free() paired with a new-expression
+__attribute__((noinline)) void operator delete(void* p) throw() {
+	std::free(p);
+}
+
+static void report(const std::string& container, const std::string& op, size_t n, size_t ops, double ms, size_t allocations, size_t sink) {
+	std::cout << std::left << std::setw(12) << container << std::setw(10) << op
+		<< std::right << std::setw(10) << n
+		<< std::setw(12) << std::fixed << std::setprecision(2) << (ms * 1e6 / ops) << " ns/op"
+		<< std::setw(10) << std::setprecision(3) << static_cast<double>(allocations) / ops << " allocs/op"
+		<< "  (" << sink << ")" << std::endl;
+}
+
+struct use_subscript {
+	template <typename Map>
+	static std::string& at(Map& m, long k) { return m[k]; }
+};
+
+struct use_insert {
+	template <typename Map>
+	static std::string& at(Map& m, long k) {
+		return m.insert(typename Map::value_type(k, std::string())).first->second;
+	}
+};
+
+template <typename Map, typename Access>
+void run(const std::string& name, const std::string& op, size_t n) {
+	const size_t ops = n < 1000000 ? 1000000 : n;
+	const std::string payload("a value long enough to live on the heap");
+	Map m;
+	for (size_t i = 0; i < n; i++)
+		m.insert(typename Map::value_type(static_cast<long>(i), payload));
+
+	unsigned long seed = 88172645463325252UL;
+	size_t sink = 0;
+	size_t before = g_allocations;
+	double start = now_ms();
+	for (size_t i = 0; i < ops; i++) {
+		unsigned long r = xorshift(seed);
+		std::string& v = Access::at(m, static_cast<long>(r % n));
+		if (r % 20 == 0)
+			v = payload;
+		else
+			sink += v.size();
+	}
+	report(name, op, n, ops, now_ms() - start, g_allocations - before, sink);
+}
+
+int main() {
+	static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		run<ft::map<long, std::string>, use_subscript>("ft::map", "[]", sizes[i]);
+		run<ft::map<long, std::string>, use_insert>("ft::map", "insert", sizes[i]);
+		run<std::map<long, std::string>, use_subscript>("std::map", "[]", sizes[i]);
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include "bench.hpp"
+
+#include "vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "unordered_map.hpp"
+#include "unordered_set.hpp"
+#include "btree_map.hpp"
+#include "btree_set.hpp"
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#include <vector>
+
+// bytes per element, ft vs std. The ft side is broken down with
+// memory_usage() (payload / structural overhead / estimated malloc overhead);
+// the std side can only be measured from outside, through counting_allocator
+// (requested bytes plus the same malloc estimate). "check" confirms that the
+// ft breakdown adds up to what the allocator actually handed out.
+// Containers are filled by insertion (vector by push_back, so growth slack is
+// included). Memory the elements own themselves, a std::string's buffer,
+// is not counted on either side.
+
+using bench::xorshift;
+
+template <typename T>
+T make_value(long id);
+
+template <>
+int make_value<int>(long id) { return static_cast<int>(id); }
+
+template <>
+long make_value<long>(long id) { return id; }
+
+template <>
+std::string make_value<std::string>(long id) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "key-%020ld", id);
+	return std::string(buf);
+}
+
+// fillers ====================================================================
+
+template <typename C>
+struct seq_fill {
+	static void fill(C& c, const std::vector<long>& ids) {
+		for (size_t i = 0; i < ids.size(); i++)
+			c.push_back(make_value<typename C::value_type>(ids[i]));
+	}
+};
+
+template <typename C>
+struct map_fill {
+	static void fill(C& c, const std::vector<long>& ids) {
+		typedef typename C::key_type	key_type;
+		typedef typename C::mapped_type	mapped_type;
+		for (size_t i = 0; i < ids.size(); i++)
+			c.insert(typename C::value_type(make_value<key_type>(ids[i]), make_value<mapped_type>(ids[i])));
+	}
+};
+
+template <typename C>
+struct set_fill {
+	static void fill(C& c, const std::vector<long>& ids) {
+		for (size_t i = 0; i < ids.size(); i++)
+			c.insert(make_value<typename C::value_type>(ids[i]));
+	}
+};
+
+// report =====================================================================
+
+static void print_header() {
+	std::printf("%-14s %-12s %9s %9s %9s %9s %9s %9s %7s %s\n", "container", "type", "size",
+		"payload", "overhead", "malloc", "ft_total", "std_total", "ft/std", "check");
+}
+
+static double per(size_t bytes, size_t n) {
+	return static_cast<double>(bytes) / static_cast<double>(n);
+}
+
+template <typename FtC, typename StdC, template <typename> class Fill>
+void row(const char* container, const char* type, const std::vector<long>& ids) {
+	ft::allocation_stats& st = ft::allocation_stats::global();
+	size_t n = ids.size();
+
+	st.reset();
+	FtC* f = new FtC();
+	Fill<FtC>::fill(*f, ids);
+	ft::memory_footprint m = f->memory_usage();
+	bool matches = st.live_bytes == m.requested();
+	delete f;
+
+	st.reset();
+	StdC* s = new StdC();
+	Fill<StdC>::fill(*s, ids);
+	size_t std_total = st.live_bytes + st.live_malloc_overhead;
+	delete s;
+
+	std::printf("%-14s %-12s %9lu %9.2f %9.2f %9.2f %9.2f %9.2f %7.2f %s\n", container, type,
+		static_cast<unsigned long>(n), per(m.payload, n), per(m.overhead, n), per(m.allocator, n),
+		per(m.total(), n), per(std_total, n), static_cast<double>(m.total()) / static_cast<double>(std_total),
+		matches ? "ok" : "MISMATCH");
+	std::fflush(stdout);
+}
+
+template <typename K, typename V>
+struct map_types {
+	typedef ft::counting_allocator<ft::pair<const K, V> >	ft_alloc;
+	typedef ft::counting_allocator<std::pair<const K, V> >	std_alloc;
+
+	typedef ft::map<K, V, ft::less<K>, ft_alloc>										ft_map;
+	typedef std::map<K, V, std::less<K>, std_alloc>									std_map;
+	typedef ft::unordered_map<K, V, ft::hash<K>, ft::equal_to<K>, ft_alloc>				ft_unordered_map;
+	typedef std::tr1::unordered_map<K, V, std::tr1::hash<K>, std::equal_to<K>, std_alloc>	std_unordered_map;
+	typedef ft::btree_map<K, V, ft::less<K>, ft_alloc>									ft_btree_map;
+};
+
+template <typename T>
+struct set_types {
+	typedef ft::counting_allocator<T>	alloc;
+
+	typedef ft::vector<T, alloc>													ft_vector;
+	typedef std::vector<T, alloc>													std_vector;
+	typedef ft::set<T, ft::less<T>, alloc>											ft_set;
+	typedef std::set<T, std::less<T>, alloc>										std_set;
+	typedef ft::unordered_set<T, ft::hash<T>, ft::equal_to<T>, alloc>				ft_unordered_set;
+	typedef std::tr1::unordered_set<T, std::tr1::hash<T>, std::equal_to<T>, alloc>	std_unordered_set;
+	typedef ft::btree_set<T, ft::less<T>, alloc>									ft_btree_set;
+};
+
+template <typename K, typename V>
+void map_rows(const char* type, const std::vector<long>& ids) {
+	typedef map_types<K, V> t;
+	row<typename t::ft_map, typename t::std_map, map_fill>("map", type, ids);
+	row<typename t::ft_unordered_map, typename t::std_unordered_map, map_fill>("unordered_map", type, ids);
+	row<typename t::ft_btree_map, typename t::std_map, map_fill>("btree_map", type, ids);
+}
+
+template <typename T>
+void set_rows(const char* type, const std::vector<long>& ids) {
+	typedef set_types<T> t;
+	row<typename t::ft_vector, typename t::std_vector, seq_fill>("vector", type, ids);
+	row<typename t::ft_set, typename t::std_set, set_fill>("set", type, ids);
+	row<typename t::ft_unordered_set, typename t::std_unordered_set, set_fill>("unordered_set", type, ids);
+	row<typename t::ft_btree_set, typename t::std_set, set_fill>("btree_set", type, ids);
+}
+
+int main() {
+	static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+	print_header();
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		size_t n = sizes[i];
+		std::vector<long> ids(n);
+		for (size_t j = 0; j < n; j++)
+			ids[j] = static_cast<long>(j);
+		unsigned long seed = 88172645463325252UL;
+		for (size_t j = n; j > 1; j--)
+			std::swap(ids[j - 1], ids[xorshift(seed) % j]);
+
+		set_rows<int>("int", ids);
+		set_rows<long>("long", ids);
+		set_rows<std::string>("string", ids);
+		map_rows<int, int>("int,int", ids);
+		map_rows<long, long>("long,long", ids);
+		map_rows<std::string, long>("string,long", ids);
+	}
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include "bench.hpp"
+#include "map.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+
+using bench::now_ms;
+
+// moving every entry from one map to another three ways:
+// copy-insert + erase, extract + insert(node_type), and merge.
+// the allocator counts node allocations to show extract/merge never allocate
+
+static size_t g_allocations = 0;
+
+template <typename T>
+struct counting_allocator : public std::allocator<T> {
+	typedef typename std::allocator<T>::pointer		pointer;
+	typedef typename std::allocator<T>::size_type	size_type;
+
+	template <typename U>
+	struct rebind { typedef counting_allocator<U> other; };
+
+	counting_allocator() {}
+	counting_allocator(const counting_allocator& other) : std::allocator<T>(other) {}
+	template <typename U>
+	counting_allocator(const counting_allocator<U>& other) : std::allocator<T>(other) {}
+
+	pointer allocate(size_type n, const void* hint = 0) {
+		g_allocations++;
+		return std::allocator<T>::allocate(n, hint);
+	}
+};
+
+typedef ft::map<long, std::string, ft::less<long>, counting_allocator<ft::pair<const long, std::string> > > map_type;
+
+static void fill(map_type& m, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		m.insert(ft::make_pair(static_cast<long>(i * 2654435761UL % (n * 4)), std::string("payload value")));
+}
+
+static void report(const std::string& op, size_t n, double ms, size_t allocations, size_t moved) {
+	std::cout << std::left << std::setw(16) << op
+		<< std::right << std::setw(10) << n
+		<< std::setw(12) << std::fixed << std::setprecision(2) << (ms * 1e6 / n) << " ns/entry"
+		<< std::setw(12) << allocations << " allocs"
+		<< "  (" << moved << ")" << std::endl;
+}
+
+static void copy_erase(size_t n) {
+	map_type src, dst;
+	fill(src, n);
+	size_t before = g_allocations;
+	double start = now_ms();
+	while (!src.empty()) {
+		map_type::iterator it = src.begin();
+		dst.insert(*it);
+		src.erase(it);
+	}
+	report("copy+erase", n, now_ms() - start, g_allocations - before, dst.size());
+}
+
+static void extract_insert(size_t n) {
+	map_type src, dst;
+	fill(src, n);
+	size_t before = g_allocations;
+	double start = now_ms();
+	while (!src.empty())
+		dst.insert(src.extract(src.begin()));
+	report("extract+insert", n, now_ms() - start, g_allocations - before, dst.size());
+}
+
+static void merge(size_t n) {
+	map_type src, dst;
+	fill(src, n);
+	size_t before = g_allocations;
+	double start = now_ms();
+	dst.merge(src);
+	report("merge", n, now_ms() - start, g_allocations - before, dst.size());
+}
+
+int main() {
+	static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		copy_erase(sizes[i]);
+		extract_insert(sizes[i]);
+		merge(sizes[i]);
+		std::cout << std::endl;
+	}
+	return 0;
+}
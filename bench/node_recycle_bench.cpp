@@ -0,0 +1,120 @@
+#include "bench.hpp"
+
+#include "map.hpp"
+#include "set.hpp"
+
+#include <map>
+#include <set>
+#include <vector>
+
+// the "rebuild and assign" and "empty and refill" cycles, where the tree
+// reuses its nodes instead of freeing them all and allocating them again.
+// Same harness and options as bench_suite; allocs/elem shows the recycling.
+//   assign        a filled container is assigned a rebuilt one of the same size
+//   assign_grow   .. of twice the size: half the nodes are reused
+//   refill        clear() and insert the keys again
+//   refill_keep   ft: clear(true) and insert the keys again; std: clear()
+
+typedef ft::counting_allocator<ft::pair<const long, long> >	ft_pair_alloc;
+typedef ft::counting_allocator<std::pair<const long, long> >	std_pair_alloc;
+typedef ft::counting_allocator<long>						alloc;
+
+typedef ft::map<long, long, ft::less<long>, ft_pair_alloc>		ft_map;
+typedef std::map<long, long, std::less<long>, std_pair_alloc>	std_map;
+typedef ft::set<long, ft::less<long>, alloc>					ft_set;
+typedef std::set<long, std::less<long>, alloc>					std_set;
+
+struct map_like {
+	template <typename C>
+	static void add(C& c, long k) { c.insert(typename C::value_type(k, k)); }
+};
+
+struct set_like {
+	template <typename C>
+	static void add(C& c, long k) { c.insert(k); }
+};
+
+template <typename C>
+struct keep_nodes {
+	static void clear(C& c) { c.clear(); }
+};
+
+template <>
+struct keep_nodes<ft_map> {
+	static void clear(ft_map& c) { c.clear(true); }
+};
+
+template <>
+struct keep_nodes<ft_set> {
+	static void clear(ft_set& c) { c.clear(true); }
+};
+
+template <typename C>
+struct assign_pair {
+	C	target;
+	C	source;
+};
+
+template <typename C, typename F, size_t Scale>
+struct assign_case {
+	typedef assign_pair<C> fixture;
+	static void setup(fixture& f, const std::vector<long>& keys) {
+		for (size_t i = 0; i < keys.size(); i++)
+			F::add(f.target, keys[i]);
+		for (size_t s = 0; s < Scale; s++)
+			for (size_t i = 0; i < keys.size(); i++)
+				F::add(f.source, keys[i] * static_cast<long>(Scale) + static_cast<long>(s));
+	}
+	static size_t run(fixture& f, const std::vector<long>&) {
+		f.target = f.source;
+		return f.target.size();
+	}
+};
+
+template <typename C, typename F, bool Keep>
+struct refill_case {
+	typedef C fixture;
+	static void setup(C& c, const std::vector<long>& keys) {
+		for (size_t i = 0; i < keys.size(); i++)
+			F::add(c, keys[i]);
+	}
+	static size_t run(C& c, const std::vector<long>& keys) {
+		size_t sum = 0;
+		for (size_t round = 0; round < 2; round++) {
+			if (Keep)
+				keep_nodes<C>::clear(c);
+			else
+				c.clear();
+			for (size_t i = 0; i < keys.size(); i++)
+				F::add(c, keys[i]);
+			sum += c.size();
+		}
+		return sum;
+	}
+};
+
+template <typename FtC, typename StdC, typename F>
+void rows(const bench::options& opt, const char* name, const std::vector<long>& keys) {
+	bench::compare<assign_case<FtC, F, 1>, assign_case<StdC, F, 1> >(opt, name, "assign", "long", keys);
+	bench::compare<assign_case<FtC, F, 2>, assign_case<StdC, F, 2> >(opt, name, "assign_grow", "long", keys);
+	bench::compare<refill_case<FtC, F, false>, refill_case<StdC, F, false> >(opt, name, "refill", "long", keys);
+	bench::compare<refill_case<FtC, F, true>, refill_case<StdC, F, true> >(opt, name, "refill_keep", "long", keys);
+}
+
+int main(int argc, char** argv) {
+	bench::options opt;
+
+	if (!bench::parse_options(argc, argv, opt))
+		return 2;
+	bench::print_header(opt);
+	for (size_t n = opt.min_size; n <= opt.max_size; n *= 10) {
+		unsigned long seed = 88172645463325252UL;
+		std::vector<long> keys(n);
+		for (size_t i = 0; i < n; i++)
+			keys[i] = static_cast<long>(bench::xorshift(seed) % (4 * n));
+		rows<ft_map, std_map, map_like>(opt, "map", keys);
+		rows<ft_set, std_set, set_like>(opt, "set", keys);
+	}
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
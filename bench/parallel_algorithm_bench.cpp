@@ -0,0 +1,228 @@
+#include "bench.hpp"
+
+#include "parallel_algorithm.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// ft::par algorithms over an ft::vector of --n 16-byte records (a random key
+// and its original position), inside thread_pools of 1, 2, 4 .. --max-threads
+// workers, against the sequential std algorithm on the same data ("std"):
+//   sort          by key
+//   stable_sort   by key, keys drawn from --n / 16 values so there are ties
+//   transform     key * 3 + position into a second vector
+//   reduce        sum of the keys
+//   for_each      key += 1 in place
+// Time is the median of --repeat runs; speedup is over std.
+
+struct par_options {
+	size_t	n;
+	size_t	max_threads;
+	size_t	repeat;
+
+	par_options() : n(10000000), max_threads(ft::thread_pool::hardware_threads()), repeat(5) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--n N] [--max-threads N] [--repeat N]\n"
+		<< "  --n records (default 10000000)\n"
+		<< "  --max-threads workers 1, 2, 4 .. N (default: online cpus)\n"
+		<< "  --repeat runs per row, the median is reported (default 5)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, par_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--n")
+			opt.n = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--max-threads")
+			opt.max_threads = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--repeat")
+			opt.repeat = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.n == 0 || opt.max_threads == 0 || opt.repeat == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// records ====================================================================
+
+struct record {
+	long	key;
+	long	position;
+};
+
+struct by_key {
+	bool operator()(const record& a, const record& b) const { return a.key < b.key; }
+};
+
+struct mix {
+	long operator()(const record& r) const { return r.key * 3 + r.position; }
+};
+
+struct add_key {
+	long operator()(long sum, const record& r) const { return sum + r.key; }
+	long operator()(long a, long b) const { return a + b; }
+	long operator()(const record& a, const record& b) const { return a.key + b.key; }
+};
+
+struct bump {
+	void operator()(record& r) const { r.key++; }
+};
+
+typedef ft::vector<record>	records;
+
+// ops ========================================================================
+
+// Each op has a fixture filled before every timed run, and two runs: par()
+// inside the pool under test, seq() with the std algorithm.
+
+struct sort_op {
+	typedef records fixture;
+	static const char* name() { return "sort"; }
+	static void setup(records& f, const records& data) { f = data; }
+	static void par(records& f) { ft::par::sort(f.begin(), f.end(), by_key()); }
+	static void seq(records& f) { std::sort(&f[0], &f[0] + f.size(), by_key()); }
+	static size_t check(const records& f) { return static_cast<size_t>(f[f.size() / 2].key); }
+};
+
+struct stable_sort_op {
+	typedef records fixture;
+	static const char* name() { return "stable_sort"; }
+	static void setup(records& f, const records& data) {
+		f = data;
+		long distinct = static_cast<long>(f.size() / 16) + 1;
+		for (size_t i = 0; i < f.size(); i++)
+			f[i].key %= distinct;
+	}
+	static void par(records& f) { ft::par::stable_sort(f.begin(), f.end(), by_key()); }
+	static void seq(records& f) { std::stable_sort(&f[0], &f[0] + f.size(), by_key()); }
+	static size_t check(const records& f) { return static_cast<size_t>(f[f.size() / 2].position); }
+};
+
+struct transform_fixture {
+	records				in;
+	ft::vector<long>	out;
+};
+
+struct transform_op {
+	typedef transform_fixture fixture;
+	static const char* name() { return "transform"; }
+	static void setup(transform_fixture& f, const records& data) {
+		f.in = data;
+		f.out.assign(data.size(), 0);
+	}
+	static void par(transform_fixture& f) { ft::par::transform(f.in.begin(), f.in.end(), f.out.begin(), mix()); }
+	static void seq(transform_fixture& f) {
+		std::transform(&f.in[0], &f.in[0] + f.in.size(), &f.out[0], mix());
+	}
+	static size_t check(const transform_fixture& f) { return static_cast<size_t>(f.out[f.out.size() / 2]); }
+};
+
+struct reduce_fixture {
+	records	in;
+	long	sum;
+};
+
+struct reduce_op {
+	typedef reduce_fixture fixture;
+	static const char* name() { return "reduce"; }
+	static void setup(reduce_fixture& f, const records& data) {
+		if (f.in.size() != data.size())
+			f.in = data;
+		f.sum = 0;
+	}
+	static void par(reduce_fixture& f) { f.sum = ft::par::reduce(f.in.begin(), f.in.end(), 0L, add_key()); }
+	static void seq(reduce_fixture& f) { f.sum = std::accumulate(&f.in[0], &f.in[0] + f.in.size(), 0L, add_key()); }
+	static size_t check(const reduce_fixture& f) { return static_cast<size_t>(f.sum); }
+};
+
+struct for_each_op {
+	typedef records fixture;
+	static const char* name() { return "for_each"; }
+	static void setup(records& f, const records& data) {
+		if (f.size() != data.size())
+			f = data;
+	}
+	static void par(records& f) { ft::par::for_each(f.begin(), f.end(), bump()); }
+	static void seq(records& f) { std::for_each(&f[0], &f[0] + f.size(), bump()); }
+	static size_t check(const records& f) { return static_cast<size_t>(f[0].key); }
+};
+
+// report =====================================================================
+
+template <typename Op>
+struct par_run {
+	typename Op::fixture*	f;
+	void operator()() { Op::par(*f); }
+};
+
+// pool == NULL runs the sequential std algorithm
+template <typename Op>
+double time_op(const par_options& opt, const records& data, ft::thread_pool* pool) {
+	typename Op::fixture f;
+	std::vector<double> samples;
+	for (size_t r = 0; r < opt.repeat; r++) {
+		Op::setup(f, data);
+		par_run<Op> run;
+		run.f = &f;
+		double start = bench::now_ns();
+		if (pool != NULL)
+			pool->run(run);
+		else
+			Op::seq(f);
+		samples.push_back(bench::now_ns() - start);
+		bench::sink() += Op::check(f);
+	}
+	return bench::median_of(samples) / 1e6;
+}
+
+template <typename Op>
+void rows(const par_options& opt, const records& data) {
+	double base = time_op<Op>(opt, data, NULL);
+	std::printf("%-12s %8s %10.2f %8.2f\n", Op::name(), "std", base, 1.0);
+	for (size_t threads = 1; threads <= opt.max_threads; threads *= 2) {
+		ft::thread_pool pool(threads);
+		double ms = time_op<Op>(opt, data, &pool);
+		std::printf("%-12s %8lu %10.2f %8.2f\n", Op::name(), static_cast<unsigned long>(threads), ms, base / ms);
+		std::fflush(stdout);
+	}
+}
+
+int main(int argc, char** argv) {
+	par_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	records data(opt.n);
+	unsigned long seed = 88172645463325252UL;
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i].key = static_cast<long>(bench::xorshift(seed) >> 1);
+		data[i].position = static_cast<long>(i);
+	}
+	std::printf("# %lu records of %lu bytes, %lu online cpus; median of %lu runs\n",
+		static_cast<unsigned long>(opt.n), static_cast<unsigned long>(sizeof(record)),
+		static_cast<unsigned long>(ft::thread_pool::hardware_threads()), static_cast<unsigned long>(opt.repeat));
+	std::printf("%-12s %8s %10s %8s\n", "op", "threads", "ms", "speedup");
+	rows<sort_op>(opt, data);
+	rows<stable_sort_op>(opt, data);
+	rows<transform_op>(opt, data);
+	rows<reduce_op>(opt, data);
+	rows<for_each_op>(opt, data);
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
@@ -0,0 +1,148 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+# include <cerrno>
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+// hardware counters for the bench harness, read through perf_event_open on
+// linux. Every event is opened on its own, so a machine (or container) that
+// lacks some of them still reports the rest; events that could not be opened
+// read as unavailable instead of failing the run.
+
+namespace bench {
+
+	enum counter_id {
+		cycles,
+		instructions,
+		l1d_misses,
+		llc_misses,
+		branch_misses,
+		dtlb_misses,
+		counter_count
+	};
+
+	inline const char* counter_name(size_t id) {
+		static const char* names[counter_count] = {
+			"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"
+		};
+		return names[id];
+	}
+
+	// short column names for the report
+	inline const char* counter_column(size_t id) {
+		static const char* names[counter_count] = { "cyc", "ins", "l1d", "llc", "brm", "dtlb" };
+		return names[id];
+	}
+
+	class perf_counters {
+		private:
+			int			_fd[counter_count];
+			std::string	_error;
+
+			perf_counters(const perf_counters&);
+			perf_counters& operator=(const perf_counters&);
+
+#ifdef __linux__
+			static int open_event(unsigned int type, unsigned long long config) {
+				struct perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = type;
+				attr.config = config;
+				attr.disabled = 1;
+				// user space only: this is what perf_event_paranoid 2 still allows
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				// scaled on read if the kernel had to multiplex the events
+				attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+				return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+			}
+#endif
+
+		public:
+			perf_counters() : _error() {
+				for (size_t i = 0; i < counter_count; i++)
+					_fd[i] = -1;
+#ifdef __linux__
+				const unsigned long long l1d_read_miss = PERF_COUNT_HW_CACHE_L1D
+					| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				const unsigned long long dtlb_read_miss = PERF_COUNT_HW_CACHE_DTLB
+					| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				_fd[cycles] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+				if (_fd[cycles] < 0)
+					_error = std::strerror(errno);
+				_fd[instructions] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+				_fd[l1d_misses] = open_event(PERF_TYPE_HW_CACHE, l1d_read_miss);
+				_fd[llc_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+				_fd[branch_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+				_fd[dtlb_misses] = open_event(PERF_TYPE_HW_CACHE, dtlb_read_miss);
+				if (!any() && _error.empty())
+					_error = std::strerror(errno);
+#else
+				_error = "perf_event_open is linux only";
+#endif
+			}
+
+			~perf_counters() {
+#ifdef __linux__
+				for (size_t i = 0; i < counter_count; i++)
+					if (_fd[i] >= 0)
+						close(_fd[i]);
+#endif
+			}
+
+			bool available(size_t id) const { return _fd[id] >= 0; }
+
+			bool any() const {
+				for (size_t i = 0; i < counter_count; i++)
+					if (available(i))
+						return true;
+				return false;
+			}
+
+			// why the cycles counter (or every counter) could not be opened
+			const std::string& error() const { return _error; }
+
+			void start() {
+#ifdef __linux__
+				for (size_t i = 0; i < counter_count; i++) {
+					if (_fd[i] < 0)
+						continue;
+					ioctl(_fd[i], PERF_EVENT_IOC_RESET, 0);
+					ioctl(_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+				}
+#endif
+			}
+
+			// stops counting and stores each event's count, -1 where unavailable
+			void stop(double out[counter_count]) {
+				for (size_t i = 0; i < counter_count; i++)
+					out[i] = -1;
+#ifdef __linux__
+				for (size_t i = 0; i < counter_count; i++)
+					if (_fd[i] >= 0)
+						ioctl(_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+				for (size_t i = 0; i < counter_count; i++) {
+					unsigned long long v[3];	// value, time enabled, time running
+					if (_fd[i] < 0 || read(_fd[i], v, sizeof(v)) != static_cast<ssize_t>(sizeof(v)))
+						continue;
+					if (v[2] == 0)
+						continue;
+					out[i] = static_cast<double>(v[0]);
+					if (v[2] < v[1])
+						out[i] *= static_cast<double>(v[1]) / static_cast<double>(v[2]);
+				}
+#endif
+			}
+	};
+}
+
+#endif
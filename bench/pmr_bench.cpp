@@ -0,0 +1,180 @@
+#include "bench.hpp"
+
+#include "pmr.hpp"
+
+#include <string>
+#include <vector>
+
+// the same ft::pmr containers on each memory resource, picked at run time by
+// name. A request builds a map, a set and a vector, reads them back and
+// destroys them. Resources:
+//   new_delete    operator new / delete behind the virtual call
+//   monotonic     monotonic_buffer_resource, released after every request
+//   stack         monotonic_buffer_resource over a 16 KiB stack buffer per request
+//   pool          one unsynchronized_pool_resource for the whole run
+//   sync_pool     one synchronized_pool_resource (uncontended mutex)
+// "static" is ft containers on std::allocator: the cost of the indirection.
+
+using bench::xorshift;
+
+typedef ft::pmr::vector<long>::type			pmr_vector;
+typedef ft::pmr::map<long, long>::type		pmr_map;
+typedef ft::pmr::set<long>::type			pmr_set;
+
+struct pmr_options {
+	size_t		requests;
+	size_t		items;
+	size_t		reps;
+	std::string	resource;
+
+	pmr_options() : requests(20000), items(100), reps(5), resource() {}
+};
+
+static const char*	resource_names[] = { "static", "new_delete", "monotonic", "stack", "pool", "sync_pool" };
+static const size_t	resource_count = sizeof(resource_names) / sizeof(resource_names[0]);
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--resource NAME] [--requests N] [--items K] [--reps R]\n"
+		<< "  --resource static, new_delete, monotonic, stack, pool or sync_pool (default: all)\n"
+		<< "  --requests requests per timed run (default 20000)\n"
+		<< "  --items average elements per container and request (default 100)\n"
+		<< "  --reps runs per row; the median is reported (default 5)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, pmr_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--requests")
+			opt.requests = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--items")
+			opt.items = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--reps")
+			opt.reps = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--resource")
+			opt.resource = val;
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	bool known = opt.resource.empty();
+	for (size_t r = 0; r < resource_count; r++)
+		known = known || opt.resource == resource_names[r];
+	if (!known || opt.requests == 0 || opt.items == 0 || opt.reps == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// requests ===================================================================
+
+typedef std::vector<long> request;
+
+static std::vector<request> make_requests(const pmr_options& opt, unsigned long seed) {
+	std::vector<request> reqs(opt.requests);
+	for (size_t r = 0; r < reqs.size(); r++) {
+		size_t n = opt.items / 2 + xorshift(seed) % opt.items + 1;
+		for (size_t i = 0; i < n; i++)
+			reqs[r].push_back(static_cast<long>(xorshift(seed) % (4 * n)));
+	}
+	return reqs;
+}
+
+template <typename Vec, typename Map, typename Set, typename Alloc>
+size_t serve(const request& keys, const Alloc& alloc) {
+	Vec v(alloc);
+	Map m((ft::less<long>()), alloc);
+	Set s((ft::less<long>()), alloc);
+	for (size_t i = 0; i < keys.size(); i++) {
+		v.push_back(keys[i]);
+		m.insert(typename Map::value_type(keys[i], keys[i]));
+		s.insert(keys[i]);
+	}
+	size_t sum = v.size();
+	for (size_t i = 0; i < keys.size(); i++) {
+		typename Map::iterator it = m.find(keys[i] + 1);
+		if (it != m.end())
+			sum += static_cast<size_t>(it->second);
+		sum += s.count(keys[i]);
+	}
+	return sum + m.size();
+}
+
+static size_t serve_pmr(const request& keys, ft::pmr::memory_resource* r) {
+	return serve<pmr_vector, pmr_map, pmr_set>(keys, ft::pmr::polymorphic_allocator<long>(r));
+}
+
+// one timed pass over every request with the named resource
+static size_t run(const std::string& name, const std::vector<request>& reqs) {
+	size_t sum = 0;
+	if (name == "static") {
+		for (size_t r = 0; r < reqs.size(); r++)
+			sum += serve<ft::vector<long>, ft::map<long, long>, ft::set<long> >(reqs[r], std::allocator<long>());
+	}
+	else if (name == "new_delete") {
+		for (size_t r = 0; r < reqs.size(); r++)
+			sum += serve_pmr(reqs[r], ft::pmr::new_delete_resource());
+	}
+	else if (name == "monotonic") {
+		ft::pmr::monotonic_buffer_resource mono;
+		for (size_t r = 0; r < reqs.size(); r++) {
+			sum += serve_pmr(reqs[r], &mono);
+			mono.release();
+		}
+	}
+	else if (name == "stack") {
+		for (size_t r = 0; r < reqs.size(); r++) {
+			char buffer[16384];
+			ft::pmr::monotonic_buffer_resource mono(buffer, sizeof(buffer));
+			sum += serve_pmr(reqs[r], &mono);
+		}
+	}
+	else if (name == "pool") {
+		ft::pmr::unsynchronized_pool_resource pool;
+		for (size_t r = 0; r < reqs.size(); r++)
+			sum += serve_pmr(reqs[r], &pool);
+	}
+	else if (name == "sync_pool") {
+		ft::pmr::synchronized_pool_resource pool;
+		for (size_t r = 0; r < reqs.size(); r++)
+			sum += serve_pmr(reqs[r], &pool);
+	}
+	return sum;
+}
+
+int main(int argc, char** argv) {
+	pmr_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::vector<request> reqs = make_requests(opt, 88172645463325252UL);
+
+	std::printf("# %lu requests of about %lu elements per container; nanoseconds per request\n",
+		static_cast<unsigned long>(opt.requests), static_cast<unsigned long>(opt.items));
+	std::printf("%-12s %12s %10s\n", "resource", "ns/request", "vs_static");
+	double baseline = 0;
+	for (size_t r = 0; r < resource_count; r++) {
+		std::string name(resource_names[r]);
+		if (!opt.resource.empty() && name != opt.resource && name != "static")
+			continue;
+		std::vector<double> samples;
+		bench::sink() += run(name, reqs);
+		for (size_t rep = 0; rep < opt.reps; rep++) {
+			double start = bench::now_ns();
+			bench::sink() += run(name, reqs);
+			samples.push_back((bench::now_ns() - start) / static_cast<double>(reqs.size()));
+		}
+		double ns = bench::median_of(samples);
+		if (name == "static")
+			baseline = ns;
+		std::printf("%-12s %12.0f %10.2f\n", name.c_str(), ns, baseline / ns);
+	}
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
@@ -0,0 +1,256 @@
+#include "bench.hpp"
+#include "latency_histogram.hpp"
+
+#include "concurrent_queue.hpp"
+#include "spsc_queue.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+// one producer thread, one consumer thread.
+//   throughput   --items longs handed over, million items per second:
+//                  mpmc       concurrent_queue try_push / try_pop, for reference
+//                  spsc       spsc_queue try_push / try_pop
+//                  spsc_n     spsc_queue try_push_n / try_pop_n of up to --batch
+//   pingpong     --rounds round trips of one item over a pair of queues,
+//                nanoseconds per round trip (the one-way latency is half)
+// --cpus a,b pins the producer (ping) thread to cpu a and the consumer (pong)
+// thread to cpu b; numbers between two physical cores are the ones that matter.
+
+struct spsc_options {
+	size_t	items;
+	size_t	capacity;
+	size_t	batch;
+	size_t	rounds;
+	int		cpu[2];
+
+	spsc_options() : items(20000000), capacity(4096), batch(64), rounds(200000) {
+		cpu[0] = -1;
+		cpu[1] = -1;
+	}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--items N] [--capacity N] [--batch N] [--rounds N] [--cpus a,b]\n"
+		<< "  --items items per throughput row (default 20000000)\n"
+		<< "  --capacity queue slots (default 4096)\n"
+		<< "  --batch items per try_push_n / try_pop_n (default 64)\n"
+		<< "  --rounds ping-pong round trips (default 200000)\n"
+		<< "  --cpus pin the two threads to cpus a and b (default: not pinned)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, spsc_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--items")
+			opt.items = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--capacity")
+			opt.capacity = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--batch")
+			opt.batch = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--rounds")
+			opt.rounds = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--cpus") {
+			if (std::sscanf(val.c_str(), "%d,%d", &opt.cpu[0], &opt.cpu[1]) != 2 || opt.cpu[0] < 0 || opt.cpu[1] < 0) {
+				usage(argv[0]);
+				return false;
+			}
+		}
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.items == 0 || opt.capacity == 0 || opt.batch == 0 || opt.rounds == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+static void pin(int cpu) {
+	if (cpu < 0)
+		return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+		std::fprintf(stderr, "# could not pin to cpu %d\n", cpu);
+}
+
+// queues =====================================================================
+
+// push_some / pop_some move up to n items and return how many they moved
+
+template <typename Queue>
+struct single {
+	Queue	q;
+	explicit single(size_t capacity) : q(capacity) {}
+
+	size_t push_some(const long* items, size_t) { return q.try_push(*items) ? 1 : 0; }
+	size_t pop_some(long* out, size_t) { return q.try_pop(*out) ? 1 : 0; }
+};
+
+struct batched {
+	ft::spsc_queue<long>	q;
+	explicit batched(size_t capacity) : q(capacity) {}
+
+	size_t push_some(const long* items, size_t n) { return q.try_push_n(items, n); }
+	size_t pop_some(long* out, size_t n) { return q.try_pop_n(out, n); }
+};
+
+typedef single<ft::concurrent_queue<long> >	mpmc_single;
+typedef single<ft::spsc_queue<long> >		spsc_single;
+
+// throughput =================================================================
+
+template <typename Queue>
+struct throughput_run {
+	const spsc_options*	opt;
+	Queue*				queue;
+	pthread_barrier_t	start;
+	size_t				checksum;
+};
+
+template <typename Queue>
+void* consumer(void* p) {
+	throughput_run<Queue>& run = *static_cast<throughput_run<Queue>*>(p);
+	std::vector<long> buf(run.opt->batch);
+	ft::backoff wait;
+	size_t sum = 0;
+
+	pin(run.opt->cpu[1]);
+	pthread_barrier_wait(&run.start);
+	for (size_t done = 0; done < run.opt->items;) {
+		size_t k = run.queue->pop_some(&buf[0], std::min(buf.size(), run.opt->items - done));
+		if (k == 0) {
+			wait.pause();
+			continue;
+		}
+		wait.reset();
+		for (size_t i = 0; i < k; i++)
+			sum += static_cast<size_t>(buf[i]);
+		done += k;
+	}
+	run.checksum = sum;
+	return NULL;
+}
+
+// million items per second
+template <typename Queue>
+double throughput(const spsc_options& opt) {
+	Queue queue(opt.capacity);
+	throughput_run<Queue> run;
+	run.opt = &opt;
+	run.queue = &queue;
+	run.checksum = 0;
+	pthread_barrier_init(&run.start, NULL, 2);
+	std::vector<long> buf(opt.batch);
+	for (size_t i = 0; i < buf.size(); i++)
+		buf[i] = static_cast<long>(i);
+	ft::backoff wait;
+
+	pthread_t tid;
+	pthread_create(&tid, NULL, consumer<Queue>, &run);
+	pin(opt.cpu[0]);
+	pthread_barrier_wait(&run.start);
+	double start = bench::now_ns();
+	for (size_t done = 0; done < opt.items;) {
+		size_t k = queue.push_some(&buf[0], std::min(buf.size(), opt.items - done));
+		if (k == 0) {
+			wait.pause();
+			continue;
+		}
+		wait.reset();
+		done += k;
+	}
+	pthread_join(tid, NULL);
+	double elapsed = bench::now_ns() - start;
+	pthread_barrier_destroy(&run.start);
+	bench::sink() += run.checksum;
+	return static_cast<double>(opt.items) / elapsed * 1000.0;
+}
+
+// ping-pong ==================================================================
+
+template <typename Queue>
+struct pingpong_run {
+	const spsc_options*	opt;
+	Queue*				ping;
+	Queue*				pong;
+	pthread_barrier_t	start;
+};
+
+template <typename Queue>
+void* ponger(void* p) {
+	pingpong_run<Queue>& run = *static_cast<pingpong_run<Queue>*>(p);
+	long v;
+
+	pin(run.opt->cpu[1]);
+	pthread_barrier_wait(&run.start);
+	for (size_t r = 0; r < run.opt->rounds; r++) {
+		run.ping->pop(v);
+		run.pong->push(v + 1);
+	}
+	return NULL;
+}
+
+template <typename Queue>
+bench::latency_histogram pingpong(const spsc_options& opt) {
+	Queue ping(opt.capacity);
+	Queue pong(opt.capacity);
+	pingpong_run<Queue> run;
+	run.opt = &opt;
+	run.ping = &ping;
+	run.pong = &pong;
+	pthread_barrier_init(&run.start, NULL, 2);
+	bench::latency_histogram h;
+	long v = 0;
+
+	pthread_t tid;
+	pthread_create(&tid, NULL, ponger<Queue>, &run);
+	pin(opt.cpu[0]);
+	pthread_barrier_wait(&run.start);
+	for (size_t r = 0; r < opt.rounds; r++) {
+		double start = bench::now_ns();
+		ping.push(v);
+		pong.pop(v);
+		h.record(static_cast<unsigned long>(bench::now_ns() - start));
+	}
+	pthread_join(tid, NULL);
+	pthread_barrier_destroy(&run.start);
+	bench::sink() += static_cast<size_t>(v);
+	return h;
+}
+
+static void print_latency(const char* queue, const bench::latency_histogram& h) {
+	std::printf("%-10s %-7s %10lu %10lu %10lu %10lu %10.1f\n", "", queue, h.percentile(50),
+		h.percentile(99), h.percentile(99.9), h.max(), h.mean());
+}
+
+int main(int argc, char** argv) {
+	spsc_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::printf("# %lu items per row, capacity %lu, batch %lu, cpus %d,%d\n",
+		static_cast<unsigned long>(opt.items), static_cast<unsigned long>(opt.capacity),
+		static_cast<unsigned long>(opt.batch), opt.cpu[0], opt.cpu[1]);
+	std::printf("%-10s %-7s %12s\n", "throughput", "queue", "Mitems/s");
+	std::printf("%-10s %-7s %12.2f\n", "", "mpmc", throughput<mpmc_single>(opt));
+	std::printf("%-10s %-7s %12.2f\n", "", "spsc", throughput<spsc_single>(opt));
+	std::printf("%-10s %-7s %12.2f\n", "", "spsc_n", throughput<batched>(opt));
+	std::printf("# %lu round trips; nanoseconds\n", static_cast<unsigned long>(opt.rounds));
+	std::printf("%-10s %-7s %10s %10s %10s %10s %10s\n", "pingpong", "queue", "p50", "p99", "p99.9", "max", "mean");
+	print_latency("mpmc", pingpong<ft::concurrent_queue<long> >(opt));
+	print_latency("spsc", pingpong<ft::spsc_queue<long> >(opt));
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include "bench.hpp"
+
+#include "thread_cache.hpp"
+#include "map.hpp"
+
+#include <string>
+#include <vector>
+
+// insert/erase churn on ft::map from 1 to --max-threads threads, node memory
+// from std::allocator (malloc) or thread_caching_allocator. Each thread owns
+// one map of up to --keys entries.
+//   own     every thread inserts --keys random keys into its map, then erases
+//           them all, --rounds times
+//   cross   every thread fills its map, then erases its neighbour's, so every
+//           node is freed on a thread other than the one that allocated it
+// Throughput is million inserts + erases per second over all threads.
+
+using bench::xorshift;
+
+struct cache_options {
+	size_t	max_threads;
+	size_t	keys;
+	size_t	rounds;
+
+	cache_options() : max_threads(64), keys(10000), rounds(20) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--max-threads N] [--keys K] [--rounds R]\n"
+		<< "  --max-threads thread counts 1, 2, 4 .. N (default 64)\n"
+		<< "  --keys entries per map (default 10000)\n"
+		<< "  --rounds fill/empty cycles per thread (default 20)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, cache_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--max-threads")
+			opt.max_threads = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--keys")
+			opt.keys = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--rounds")
+			opt.rounds = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.max_threads == 0 || opt.keys == 0 || opt.rounds == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// workers ====================================================================
+
+template <typename Map>
+struct shared_run {
+	const cache_options*	opt;
+	size_t					threads;
+	bool					cross;
+	std::vector<Map*>		maps;
+	pthread_barrier_t		start;		// workers and the timer
+	pthread_barrier_t		round;		// workers only, between fill and erase
+};
+
+template <typename Map>
+struct worker_arg {
+	shared_run<Map>*	run;
+	size_t				id;
+	size_t				checksum;
+};
+
+template <typename Map>
+void* worker(void* p) {
+	worker_arg<Map>& arg = *static_cast<worker_arg<Map>*>(p);
+	shared_run<Map>& run = *arg.run;
+	unsigned long seed = 88172645463325252UL + arg.id * 0x9E3779B97F4A7C15UL;
+	std::vector<long> keys(run.opt->keys);
+	for (size_t i = 0; i < keys.size(); i++)
+		keys[i] = static_cast<long>(xorshift(seed) % (4 * keys.size()));
+
+	pthread_barrier_wait(&run.start);
+	for (size_t r = 0; r < run.opt->rounds; r++) {
+		Map& mine = *run.maps[arg.id];
+		for (size_t i = 0; i < keys.size(); i++)
+			mine.insert(typename Map::value_type(keys[i], r));
+		if (run.cross)
+			pthread_barrier_wait(&run.round);
+		Map& victim = run.cross ? *run.maps[(arg.id + 1) % run.threads] : mine;
+		for (size_t i = 0; i < keys.size(); i++)
+			arg.checksum += victim.erase(keys[i] ^ static_cast<long>(r & 1));
+		arg.checksum += victim.size();
+		victim.clear();
+		if (run.cross)
+			pthread_barrier_wait(&run.round);
+	}
+	return NULL;
+}
+
+// million operations per second
+template <typename Map>
+double measure(const cache_options& opt, size_t threads, bool cross) {
+	shared_run<Map> run;
+	run.opt = &opt;
+	run.threads = threads;
+	run.cross = cross;
+	for (size_t t = 0; t < threads; t++)
+		run.maps.push_back(new Map());
+	pthread_barrier_init(&run.start, NULL, static_cast<unsigned>(threads + 1));
+	pthread_barrier_init(&run.round, NULL, static_cast<unsigned>(threads));
+
+	std::vector<pthread_t> tids(threads);
+	std::vector<worker_arg<Map> > args(threads);
+	for (size_t t = 0; t < threads; t++) {
+		args[t].run = &run;
+		args[t].id = t;
+		args[t].checksum = 0;
+		pthread_create(&tids[t], NULL, worker<Map>, &args[t]);
+	}
+	pthread_barrier_wait(&run.start);
+	double start = bench::now_ns();
+	for (size_t t = 0; t < threads; t++)
+		pthread_join(tids[t], NULL);
+	double elapsed = bench::now_ns() - start;
+
+	for (size_t t = 0; t < threads; t++) {
+		bench::sink() += args[t].checksum;
+		delete run.maps[t];
+	}
+	pthread_barrier_destroy(&run.start);
+	pthread_barrier_destroy(&run.round);
+	double ops = 2.0 * static_cast<double>(opt.keys) * static_cast<double>(opt.rounds) * static_cast<double>(threads);
+	return ops / elapsed * 1000.0;
+}
+
+typedef ft::map<long, size_t>	malloc_map;
+typedef ft::map<long, size_t, ft::less<long>, ft::thread_caching_allocator<ft::pair<const long, size_t> > >
+	cached_map;
+
+int main(int argc, char** argv) {
+	cache_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	std::printf("# %lu keys per map, %lu rounds; million inserts + erases per second, all threads\n",
+		static_cast<unsigned long>(opt.keys), static_cast<unsigned long>(opt.rounds));
+	std::printf("%-6s %8s %10s %10s %8s\n", "mode", "threads", "malloc", "cached", "speedup");
+	for (int cross = 0; cross < 2; cross++)
+		for (size_t threads = 1; threads <= opt.max_threads; threads *= 2) {
+			double plain = measure<malloc_map>(opt, threads, cross);
+			double cached = measure<cached_map>(opt, threads, cross);
+			std::printf("%-6s %8lu %10.2f %10.2f %8.2f\n", cross ? "cross" : "own",
+				static_cast<unsigned long>(threads), plain, cached, cached / plain);
+		}
+	ft::thread_cache_detail::depot_stats s = ft::thread_cache_stats();
+	std::printf("# depot: %lu batch fetches, %lu returns, %lu slabs\n", s.fetches, s.returns, s.slabs);
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
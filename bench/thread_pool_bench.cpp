@@ -0,0 +1,193 @@
+#include "bench.hpp"
+
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+#include <string>
+#include <vector>
+
+// recursive fork/join on ft::thread_pool, 1, 2, 4 .. --max-threads workers,
+// against the same recursion run sequentially ("seq"):
+//   fib   fib(--fib) forking both calls down to --cutoff, then plain recursion;
+//         almost no work per task, so this measures the scheduler
+//   sum   sum of an ft::vector of --sum-mb MB of longs, halved down to --grain
+//         elements; memory bound, so it stops scaling at the memory bandwidth
+// Time is the median of --repeat runs; steals/run shows how much work moved
+// between workers.
+
+struct pool_options {
+	size_t	max_threads;
+	size_t	fib;
+	size_t	cutoff;
+	size_t	sum_mb;
+	size_t	grain;
+	size_t	repeat;
+
+	pool_options() : max_threads(ft::thread_pool::hardware_threads()), fib(36), cutoff(16), sum_mb(256),
+		grain(16384), repeat(5) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [--max-threads N] [--fib N] [--cutoff N] [--sum-mb N] [--grain N] [--repeat N]\n"
+		<< "  --max-threads workers 1, 2, 4 .. N (default: online cpus)\n"
+		<< "  --fib which fibonacci number (default 36)\n"
+		<< "  --cutoff below this fib runs sequentially (default 16)\n"
+		<< "  --sum-mb size of the summed vector in MB (default 256)\n"
+		<< "  --grain elements summed sequentially (default 16384)\n"
+		<< "  --repeat runs per row, the median is reported (default 5)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, pool_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return false;
+		}
+		std::string val(argv[++i]);
+		if (arg == "--max-threads")
+			opt.max_threads = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--fib")
+			opt.fib = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--cutoff")
+			opt.cutoff = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--sum-mb")
+			opt.sum_mb = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--grain")
+			opt.grain = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--repeat")
+			opt.repeat = std::strtoul(val.c_str(), NULL, 10);
+		else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	if (opt.max_threads == 0 || opt.cutoff < 2 || opt.sum_mb == 0 || opt.grain == 0 || opt.repeat == 0) {
+		usage(argv[0]);
+		return false;
+	}
+	return true;
+}
+
+// tasks ======================================================================
+
+static long seq_fib(long n) {
+	return n < 2 ? n : seq_fib(n - 1) + seq_fib(n - 2);
+}
+
+struct fib_task {
+	long	n;
+	long	cutoff;
+	long	result;
+
+	fib_task(long num, long cut) : n(num), cutoff(cut), result(0) {}
+
+	void operator()() {
+		if (n < cutoff) {
+			result = seq_fib(n);
+			return;
+		}
+		fib_task a(n - 1, cutoff);
+		fib_task b(n - 2, cutoff);
+		ft::parallel_invoke(a, b);
+		result = a.result + b.result;
+	}
+
+	void run_sequential() { result = seq_fib(n); }
+};
+
+struct sum_task {
+	const long*	first;
+	const long*	last;
+	size_t		grain;
+	long		result;
+
+	sum_task(const long* f, const long* l, size_t g) : first(f), last(l), grain(g), result(0) {}
+
+	void operator()() {
+		size_t n = static_cast<size_t>(last - first);
+		if (n <= grain) {
+			run_sequential();
+			return;
+		}
+		sum_task a(first, first + n / 2, grain);
+		sum_task b(first + n / 2, last, grain);
+		ft::parallel_invoke(a, b);
+		result = a.result + b.result;
+	}
+
+	void run_sequential() {
+		long s = 0;
+		for (const long* p = first; p != last; p++)
+			s += *p;
+		result = s;
+	}
+};
+
+// report =====================================================================
+
+struct timing {
+	double	ms;
+	double	steals;		// per run
+};
+
+// pool == NULL runs the task's plain recursion on the calling thread
+template <typename Task>
+timing time_task(const pool_options& opt, ft::thread_pool* pool, Task proto) {
+	std::vector<double> samples;
+	ft::thread_pool::stats_type before = ft::thread_pool::stats_type();
+	if (pool != NULL)
+		before = pool->stats();
+	for (size_t r = 0; r < opt.repeat; r++) {
+		Task t = proto;
+		double start = bench::now_ns();
+		if (pool != NULL)
+			pool->run(t);
+		else
+			t.run_sequential();
+		samples.push_back(bench::now_ns() - start);
+		bench::sink() += static_cast<size_t>(t.result);
+	}
+	timing tm;
+	tm.ms = bench::median_of(samples) / 1e6;
+	tm.steals = 0;
+	if (pool != NULL)
+		tm.steals = static_cast<double>(pool->stats().steals - before.steals) / static_cast<double>(opt.repeat);
+	return tm;
+}
+
+static void print_row(const char* name, const char* threads, const timing& t, double base) {
+	std::printf("%-5s %8s %10.2f %8.2f %12.1f\n", name, threads, t.ms, base / t.ms, t.steals);
+	std::fflush(stdout);
+}
+
+template <typename Task>
+void rows(const pool_options& opt, const char* name, const Task& proto) {
+	timing seq = time_task(opt, NULL, proto);
+	print_row(name, "seq", seq, seq.ms);
+	for (size_t threads = 1; threads <= opt.max_threads; threads *= 2) {
+		ft::thread_pool pool(threads);
+		char label[32];
+		std::snprintf(label, sizeof(label), "%lu", static_cast<unsigned long>(threads));
+		print_row(name, label, time_task(opt, &pool, proto), seq.ms);
+	}
+}
+
+int main(int argc, char** argv) {
+	pool_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	ft::vector<long> values(opt.sum_mb * 1024 * 1024 / sizeof(long));
+	for (size_t i = 0; i < values.size(); i++)
+		values[i] = static_cast<long>(i & 1023);
+	std::printf("# %lu online cpus; fib(%lu) cutoff %lu, sum of %lu MB grain %lu; median of %lu runs\n",
+		static_cast<unsigned long>(ft::thread_pool::hardware_threads()), static_cast<unsigned long>(opt.fib),
+		static_cast<unsigned long>(opt.cutoff), static_cast<unsigned long>(opt.sum_mb),
+		static_cast<unsigned long>(opt.grain), static_cast<unsigned long>(opt.repeat));
+	std::printf("%-5s %8s %10s %8s %12s\n", "task", "threads", "ms", "speedup", "steals/run");
+	rows(opt, "fib", fib_task(static_cast<long>(opt.fib), static_cast<long>(opt.cutoff)));
+	rows(opt, "sum", sum_task(&values[0], &values[0] + values.size(), opt.grain));
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
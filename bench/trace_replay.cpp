@@ -0,0 +1,424 @@
+#include "bench.hpp"
+#include "latency_histogram.hpp"
+
+#include "trace.hpp"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// replays an operation trace recorded with traced_map / traced_set /
+// traced_vector (trace.hpp) against ft and std at full speed. The trace is
+// decoded into memory first, so file I/O is not measured. Each implementation
+// gets --reps untimed-per-op passes for throughput (median reported), then one
+// more pass with every operation timed on its own for the latency table.
+// Building the container from empty is part of every pass; destroying it is not.
+// Map values are not recorded: insert stores 1, subscript increments.
+//
+// --record writes a synthetic trace through the traced wrappers, for trying
+// the tool out or as a regression input.
+
+using bench::xorshift;
+
+struct replay_options {
+	std::string	file;
+	bool		ft;
+	bool		std_;
+	size_t		reps;
+	bool		record;
+	std::string	container;
+	std::string	keys;
+	size_t		ops;
+
+	replay_options() : file(), ft(true), std_(true), reps(5), record(false),
+		container("map"), keys("int"), ops(1000000) {}
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " FILE [--impl ft|std|both] [--reps N]\n"
+		<< "       " << prog << " --record FILE [--container map|set|vector] [--keys int|string] [--ops N]\n"
+		<< "  --impl implementations to replay against (default both)\n"
+		<< "  --reps throughput passes per implementation (default 5)\n"
+		<< "  --record writes a synthetic trace of --ops operations (default 1000000)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, replay_options& opt) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if (arg.compare(0, 2, "--") != 0) {
+			if (!opt.file.empty())
+				break;
+			opt.file = arg;
+			continue;
+		}
+		if (arg == "--record") {
+			opt.record = true;
+			continue;
+		}
+		if (i + 1 >= argc)
+			break;
+		std::string val(argv[++i]);
+		if (arg == "--impl") {
+			opt.ft = val == "ft" || val == "both";
+			opt.std_ = val == "std" || val == "both";
+		}
+		else if (arg == "--reps")
+			opt.reps = std::strtoul(val.c_str(), NULL, 10);
+		else if (arg == "--container")
+			opt.container = val;
+		else if (arg == "--keys")
+			opt.keys = val;
+		else if (arg == "--ops")
+			opt.ops = std::strtoul(val.c_str(), NULL, 10);
+		else
+			opt.file.clear();
+	}
+	bool ok = !opt.file.empty() && opt.reps != 0 && opt.ops != 0 && (opt.ft || opt.std_)
+		&& (opt.container == "map" || opt.container == "set" || opt.container == "vector")
+		&& (opt.keys == "int" || opt.keys == "string");
+	if (!ok)
+		usage(argv[0]);
+	return ok;
+}
+
+static inline unsigned long tick() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long>(ts.tv_sec) * 1000000000UL + static_cast<unsigned long>(ts.tv_nsec);
+}
+
+static size_t checksum(long v) { return static_cast<size_t>(v); }
+static size_t checksum(const std::string& v) { return v.size(); }
+
+// decoded trace ==============================================================
+
+template <typename Key>
+struct trace_ops {
+	std::vector<unsigned char>	op;
+	std::vector<Key>			key;
+	std::vector<size_t>			index;
+	size_t						count[ft::trace_op_end];
+
+	trace_ops() : op(), key(), index() {
+		for (size_t i = 0; i < ft::trace_op_end; i++)
+			count[i] = 0;
+	}
+};
+
+template <typename Key>
+void decode(std::istream& in, trace_ops<Key>& t) {
+	int		op;
+	Key		key = Key();
+	size_t	index = 0;
+	while (ft::read_trace_record(in, op, key, index)) {
+		t.op.push_back(static_cast<unsigned char>(op));
+		t.key.push_back(key);
+		t.index.push_back(index);
+		t.count[op]++;
+	}
+}
+
+// replayers ==================================================================
+
+template <typename Map>
+struct map_replay {
+	typedef Map						container;
+	typedef typename Map::key_type	key_type;
+
+	static size_t apply(Map& m, int op, const key_type& k, size_t) {
+		switch (op) {
+			case ft::trace_insert:		return m.insert(typename Map::value_type(k, 1)).second;
+			case ft::trace_subscript:	return static_cast<size_t>(++m[k]);
+			case ft::trace_find:		return m.find(k) != m.end();
+			case ft::trace_erase:		return m.erase(k);
+			case ft::trace_lower_bound:	return m.lower_bound(k) != m.end();
+			case ft::trace_upper_bound:	return m.upper_bound(k) != m.end();
+			case ft::trace_clear:		m.clear(); break;
+		}
+		return 0;
+	}
+};
+
+template <typename Set>
+struct set_replay {
+	typedef Set						container;
+	typedef typename Set::key_type	key_type;
+
+	static size_t apply(Set& s, int op, const key_type& k, size_t) {
+		switch (op) {
+			case ft::trace_insert:		return s.insert(k).second;
+			case ft::trace_find:		return s.find(k) != s.end();
+			case ft::trace_erase:		return s.erase(k);
+			case ft::trace_lower_bound:	return s.lower_bound(k) != s.end();
+			case ft::trace_upper_bound:	return s.upper_bound(k) != s.end();
+			case ft::trace_clear:		s.clear(); break;
+		}
+		return 0;
+	}
+};
+
+template <typename Vector>
+struct vector_replay {
+	typedef Vector							container;
+	typedef typename Vector::value_type		key_type;
+
+	static size_t apply(Vector& v, int op, const key_type& k, size_t i) {
+		switch (op) {
+			case ft::trace_push_back:	v.push_back(k); break;
+			case ft::trace_pop_back:	if (!v.empty()) v.pop_back(); break;
+			case ft::trace_index:		return i < v.size() ? checksum(v[i]) : 0;
+			case ft::trace_clear:		v.clear(); break;
+		}
+		return 0;
+	}
+};
+
+// report =====================================================================
+
+static void print_throughput_header() {
+	std::printf("%-16s %12s %10s %10s\n", "impl", "ops", "ms", "Mops/s");
+}
+
+static void print_latency_header() {
+	std::printf("%-16s %-12s %9s %10s %10s %10s %10s %10s %10s %12s\n",
+		"impl", "op", "count", "min", "p50", "p90", "p99", "p99.9", "max", "mean");
+}
+
+static void print_latency(const std::string& impl, const std::string& op, const bench::latency_histogram& h) {
+	std::printf("%-16s %-12s %9lu %10lu %10lu %10lu %10lu %10lu %10lu %12.1f\n",
+		impl.c_str(), op.c_str(), static_cast<unsigned long>(h.count()), h.min(),
+		h.percentile(50), h.percentile(90), h.percentile(99), h.percentile(99.9), h.max(), h.mean());
+}
+
+// replay =====================================================================
+
+template <typename Replay>
+void throughput(const std::string& impl, const trace_ops<typename Replay::key_type>& t, size_t reps) {
+	typedef typename Replay::container	container;
+	std::vector<double>	times;
+	size_t				sum = 0;
+
+	for (size_t r = 0; r < reps; r++) {
+		container* c = new container();
+		double start = bench::now_ns();
+		for (size_t i = 0; i < t.op.size(); i++)
+			sum += Replay::apply(*c, t.op[i], t.key[i], t.index[i]);
+		times.push_back(bench::now_ns() - start);
+		delete c;
+	}
+	bench::sink() += sum;
+	double ms = bench::median_of(times) / 1e6;
+	std::printf("%-16s %12lu %10.2f %10.2f\n", impl.c_str(), static_cast<unsigned long>(t.op.size()),
+		ms, ms > 0 ? static_cast<double>(t.op.size()) / ms / 1e3 : 0);
+	std::fflush(stdout);
+}
+
+template <typename Replay>
+void latency(const std::string& impl, const trace_ops<typename Replay::key_type>& t) {
+	typedef typename Replay::container	container;
+	bench::latency_histogram	all;
+	bench::latency_histogram	per_op[ft::trace_op_end];
+	size_t						sum = 0;
+
+	container* c = new container();
+	for (size_t i = 0; i < t.op.size(); i++) {
+		unsigned long start = tick();
+		sum += Replay::apply(*c, t.op[i], t.key[i], t.index[i]);
+		unsigned long elapsed = tick() - start;
+		all.record(elapsed);
+		per_op[t.op[i]].record(elapsed);
+	}
+	delete c;
+	bench::sink() += sum;
+	print_latency(impl, "all", all);
+	for (int op = 1; op < ft::trace_op_end; op++)
+		if (per_op[op].count())
+			print_latency(impl, ft::trace_op_name(op), per_op[op]);
+	std::fflush(stdout);
+}
+
+template <typename FtReplay, typename StdReplay>
+void replay(const replay_options& opt, const std::string& ft_name, const std::string& std_name,
+	const trace_ops<typename FtReplay::key_type>& t) {
+	std::printf("# throughput, median of %lu passes\n", static_cast<unsigned long>(opt.reps));
+	print_throughput_header();
+	if (opt.ft)
+		throughput<FtReplay>(ft_name, t, opt.reps);
+	if (opt.std_)
+		throughput<StdReplay>(std_name, t, opt.reps);
+	std::printf("# latency, nanoseconds per operation\n");
+	print_latency_header();
+	if (opt.ft)
+		latency<FtReplay>(ft_name, t);
+	if (opt.std_)
+		latency<StdReplay>(std_name, t);
+}
+
+template <typename Key>
+int replay_file(const replay_options& opt, std::istream& in, const ft::trace_header& h) {
+	trace_ops<Key> t;
+	decode(in, t);
+
+	std::printf("# %s: %lu operations on a %s with %s keys:", opt.file.c_str(),
+		static_cast<unsigned long>(t.op.size()), h.container == ft::trace_map ? "map"
+		: h.container == ft::trace_set ? "set" : "vector", h.key_kind == 'i' ? "integer" : "string");
+	for (int op = 1; op < ft::trace_op_end; op++)
+		if (t.count[op])
+			std::printf(" %s %lu", ft::trace_op_name(op), static_cast<unsigned long>(t.count[op]));
+	std::printf("\n");
+
+	if (h.container == ft::trace_map)
+		replay<map_replay<ft::map<Key, long> >, map_replay<std::map<Key, long> > >(opt, "ft::map", "std::map", t);
+	else if (h.container == ft::trace_set)
+		replay<set_replay<ft::set<Key> >, set_replay<std::set<Key> > >(opt, "ft::set", "std::set", t);
+	else if (h.container == ft::trace_vector)
+		replay<vector_replay<ft::vector<Key> >, vector_replay<std::vector<Key> > >(opt, "ft::vector", "std::vector", t);
+	else {
+		std::cerr << opt.file << ": unknown container '" << h.container << "'" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// synthetic traces ===========================================================
+
+template <typename Key>
+Key make_key(unsigned long id);
+
+template <>
+long make_key<long>(unsigned long id) { return static_cast<long>(id); }
+
+template <>
+std::string make_key<std::string>(unsigned long id) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "user:%010lu", id);
+	return std::string(buf);
+}
+
+// a key space of ops / 4 keys: 40% insert, 35% find, 10% erase, 8% lower_bound,
+// 4% count (recorded as find), 3% upper_bound
+template <typename Traced>
+void record_set(Traced& c, size_t ops) {
+	typedef typename Traced::key_type	key_type;
+	unsigned long seed = 88172645463325252UL;
+	unsigned long space = ops / 4 + 1;
+	size_t sum = 0;
+
+	for (size_t i = 0; i < ops; i++) {
+		unsigned long r = xorshift(seed) % 100;
+		key_type k = make_key<key_type>(xorshift(seed) % space);
+		if (r < 40)
+			c.insert(k);
+		else if (r < 75)
+			sum += c.find(k) != c.end();
+		else if (r < 85)
+			sum += c.erase(k);
+		else if (r < 93)
+			sum += c.lower_bound(k) != c.end();
+		else if (r < 97)
+			sum += c.count(k);
+		else
+			sum += c.upper_bound(k) != c.end();
+	}
+	bench::sink() += sum;
+}
+
+// as record_set, with subscript in place of count
+template <typename Traced>
+void record_map(Traced& m, size_t ops) {
+	typedef typename Traced::key_type	key_type;
+	unsigned long seed = 88172645463325252UL;
+	unsigned long space = ops / 4 + 1;
+	size_t sum = 0;
+
+	for (size_t i = 0; i < ops; i++) {
+		unsigned long r = xorshift(seed) % 100;
+		key_type k = make_key<key_type>(xorshift(seed) % space);
+		if (r < 40)
+			m.insert(typename Traced::value_type(k, 1));
+		else if (r < 75)
+			sum += m.find(k) != m.end();
+		else if (r < 85)
+			sum += m.erase(k);
+		else if (r < 93)
+			sum += m.lower_bound(k) != m.end();
+		else if (r < 97)
+			sum += static_cast<size_t>(++m[k]);
+		else
+			sum += m.upper_bound(k) != m.end();
+	}
+	bench::sink() += sum;
+}
+
+// 50% push_back, 40% index into the current size, 10% pop_back
+template <typename Traced>
+void record_vector(Traced& v, size_t ops) {
+	typedef typename Traced::value_type	value_type;
+	unsigned long seed = 88172645463325252UL;
+	size_t sum = 0;
+
+	for (size_t i = 0; i < ops; i++) {
+		unsigned long r = xorshift(seed) % 100;
+		if (r < 50 || v.empty())
+			v.push_back(make_key<value_type>(i));
+		else if (r < 90)
+			sum += checksum(v[xorshift(seed) % v.size()]);
+		else
+			v.pop_back();
+	}
+	bench::sink() += sum;
+}
+
+template <typename Key>
+void record_sample(const replay_options& opt, ft::trace_writer& w) {
+	if (opt.container == "map") {
+		ft::traced_map<Key, long> m(w);
+		record_map(m, opt.ops);
+	}
+	else if (opt.container == "set") {
+		ft::traced_set<Key> s(w);
+		record_set(s, opt.ops);
+	}
+	else {
+		ft::traced_vector<Key> v(w);
+		record_vector(v, opt.ops);
+	}
+}
+
+int main(int argc, char** argv) {
+	replay_options opt;
+
+	if (!parse_options(argc, argv, opt))
+		return 2;
+	try {
+		if (opt.record) {
+			std::ofstream out(opt.file.c_str(), std::ios::binary);
+			if (!out) {
+				std::cerr << opt.file << ": cannot open for writing" << std::endl;
+				return 1;
+			}
+			ft::trace_writer w(out);
+			if (opt.keys == "int")
+				record_sample<long>(opt, w);
+			else
+				record_sample<std::string>(opt, w);
+			std::printf("# wrote %lu operations to %s\n", static_cast<unsigned long>(w.records()), opt.file.c_str());
+			return out ? 0 : 1;
+		}
+		std::ifstream in(opt.file.c_str(), std::ios::binary);
+		if (!in) {
+			std::cerr << opt.file << ": cannot open" << std::endl;
+			return 1;
+		}
+		ft::trace_header h = ft::read_trace_header(in);
+		int ret = h.key_kind == 'i' ? replay_file<long>(opt, in, h) : replay_file<std::string>(opt, in, h);
+		std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+		return ret;
+	}
+	catch (const std::exception& e) {
+		std::cerr << opt.file << ": " << e.what() << std::endl;
+		return 1;
+	}
+}
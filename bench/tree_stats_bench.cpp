@@ -0,0 +1,116 @@
+#include "bench.hpp"
+#include "map.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using bench::xorshift;
+
+// rebalancing work and resulting shape of ft::map per workload, from the
+// tree's opt-in statistics (map<..., Stats = true>). Not timed: these are
+// counts per operation, so they do not depend on the machine.
+
+typedef ft::map<long, long, ft::less<long>, std::allocator<ft::pair<const long, long> >, true>	stats_map;
+
+static void print_header() {
+	std::cout << std::left << std::setw(12) << "workload" << std::setw(8) << "op"
+		<< std::right << std::setw(10) << "ops" << std::setw(10) << "cmp/op"
+		<< std::setw(10) << "rot/op" << std::setw(10) << "color/op"
+		<< std::setw(8) << "height" << std::setw(8) << "min_h" << std::setw(8) << "black"
+		<< std::setw(10) << "avg_depth" << std::endl;
+}
+
+static void print_row(const std::string& workload, const std::string& op, const ft::tree_op_stats& s,
+	const ft::tree_shape& shape) {
+	std::cout << std::left << std::setw(12) << workload << std::setw(8) << op
+		<< std::right << std::setw(10) << s.operations
+		<< std::fixed << std::setprecision(3)
+		<< std::setw(10) << s.per_op(s.comparisons)
+		<< std::setw(10) << s.per_op(s.rotations)
+		<< std::setw(10) << s.per_op(s.recolorings)
+		<< std::setw(8) << shape.height
+		<< std::setw(8) << static_cast<size_t>(std::ceil(std::log(shape.size + 1.0) / std::log(2.0)))
+		<< std::setw(8) << shape.black_height
+		<< std::setw(10) << std::setprecision(2) << shape.average_depth << std::endl;
+}
+
+static void report(const std::string& workload, const stats_map& m) {
+	ft::tree_shape shape = m.shape();
+	const ft::tree_stats& s = m.stats();
+	if (s.insert.operations)
+		print_row(workload, "insert", s.insert, shape);
+	if (s.erase.operations)
+		print_row(workload, "erase", s.erase, shape);
+	if (s.lookup.operations)
+		print_row(workload, "find", s.lookup, shape);
+	if (!m.verify())
+		std::cout << workload << ": invariant violated" << std::endl;
+}
+
+static void run(size_t n) {
+	std::vector<long> keys(n);
+	for (size_t i = 0; i < n; i++)
+		keys[i] = static_cast<long>(i);
+	unsigned long seed = 88172645463325252UL;
+	std::vector<long> shuffled(keys);
+	for (size_t i = n; i > 1; i--)
+		std::swap(shuffled[i - 1], shuffled[xorshift(seed) % i]);
+
+	std::cout << "# n " << n << std::endl;
+	{
+		stats_map m;
+		for (size_t i = 0; i < n; i++)
+			m.insert(ft::make_pair(keys[i], 0L));
+		report("ascending", m);
+	}
+	{
+		stats_map m;
+		for (size_t i = n; i > 0; i--)
+			m.insert(ft::make_pair(keys[i - 1], 0L));
+		report("descending", m);
+	}
+	{
+		stats_map m;
+		for (size_t i = 0; i < n; i++)
+			m.insert(ft::make_pair(shuffled[i], 0L));
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += m.count(keys[i]);
+		bench::sink() += sum;
+		report("random", m);
+	}
+	{
+		// steady state: every insert of a new key is followed by erasing a random old one
+		stats_map m;
+		for (size_t i = 0; i < n; i++)
+			m.insert(ft::make_pair(shuffled[i], 0L));
+		m.reset_stats();
+		for (size_t i = 0; i < n; i++) {
+			m.insert(ft::make_pair(static_cast<long>(n + i), 0L));
+			m.erase(shuffled[i]);
+		}
+		report("churn", m);
+	}
+	{
+		stats_map m;
+		for (size_t i = 0; i < n; i++)
+			m.insert(ft::make_pair(shuffled[i], 0L));
+		m.reset_stats();
+		for (size_t i = 0; i < n; i++)
+			m.erase(keys[i]);
+		report("drain_asc", m);
+	}
+}
+
+int main() {
+	static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+	print_header();
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		run(sizes[i]);
+	std::cerr << "# sink " << bench::sink() << std::endl;
+	return 0;
+}
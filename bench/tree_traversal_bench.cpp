@@ -0,0 +1,65 @@
+#include "bench.hpp"
+#include "map.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+
+using bench::now_ms;
+
+// full in-order iteration, copy and clear() on large maps. copy and clear
+// are the O(n) structural walks; iteration exercises the successor lookup.
+
+static void report(const std::string& container, const std::string& op, size_t n, double ms, long sink) {
+	std::cout << std::left << std::setw(12) << container << std::setw(10) << op
+		<< std::right << std::setw(10) << n
+		<< std::setw(12) << std::fixed << std::setprecision(2) << (ms * 1e6 / n) << " ns/node"
+		<< std::setw(12) << std::setprecision(1) << ms << " ms"
+		<< "  (" << sink << ")" << std::endl;
+}
+
+template <typename Map>
+void run(const std::string& name, size_t n) {
+	Map m;
+	// ascending inserts with a stride, so nodes are not laid out in key order
+	for (size_t i = 0; i < n; i++)
+		m.insert(typename Map::value_type(static_cast<long>(i * 2654435761UL % n), static_cast<long>(i)));
+
+	long sink = 0;
+	double start = now_ms();
+	for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it)
+		sink += it->second;
+	report(name, "iterate", n, now_ms() - start, sink);
+
+	start = now_ms();
+	for (typename Map::const_reverse_iterator it = m.rbegin(); it != m.rend(); ++it)
+		sink -= it->second;
+	report(name, "riterate", n, now_ms() - start, sink);
+
+	start = now_ms();
+	{
+		Map copy(m);
+		sink = copy.size();
+		report(name, "copy", n, now_ms() - start, sink);
+
+		start = now_ms();
+		copy.clear();
+		report(name, "clear", n, now_ms() - start, sink + copy.size());
+	}
+}
+
+int main(int argc, char** argv) {
+	static const size_t sizes[] = { 1000, 100000, 10000000 };
+	size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+	// "quick" skips the 10^7 row
+	if (argc > 1 && std::string(argv[1]) == "quick")
+		count--;
+	for (size_t i = 0; i < count; i++) {
+		run<ft::map<long, long> >("ft::map", sizes[i]);
+		run<std::map<long, long> >("std::map", sizes[i]);
+		std::cout << std::endl;
+	}
+	return 0;
+}
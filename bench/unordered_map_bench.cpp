@@ -0,0 +1,86 @@
+#include "bench.hpp"
+#include "unordered_map.hpp"
+#include "map.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <tr1/unordered_map>
+
+using bench::now_ms;
+using bench::xorshift;
+
+// hit/miss lookups and insert/erase churn: ft::unordered_map vs ft::map vs
+// the standard hash map (std::tr1 since the tree is built as c++98)
+
+static void report(const std::string& container, const std::string& op, size_t n, size_t ops, double ms, long sink) {
+	std::cout << std::left << std::setw(24) << container << std::setw(12) << op
+		<< std::right << std::setw(10) << n
+		<< std::setw(12) << std::fixed << std::setprecision(2) << (ms * 1e6 / ops) << " ns/op"
+		<< "  (" << sink << ")" << std::endl;
+}
+
+template <typename Map>
+void run(const std::string& name, size_t n) {
+	const size_t ops = n < 1000000 ? 1000000 : n;
+	Map m;
+	unsigned long seed = 88172645463325252UL;
+	long sink = 0;
+
+	double start = now_ms();
+	for (size_t i = 0; i < n; i++)
+		m.insert(ft::make_pair(static_cast<long>(xorshift(seed) >> 2) * 2, static_cast<long>(i)));
+	report(name, "insert", n, n, now_ms() - start, m.size());
+	const unsigned long fill_seed = seed;
+
+	// replay the same key sequence: every even key is a hit, odd keys miss
+	seed = 88172645463325252UL;
+	start = now_ms();
+	for (size_t i = 0; i < ops; i++) {
+		if (i % n == 0)
+			seed = 88172645463325252UL;
+		typename Map::iterator it = m.find(static_cast<long>(xorshift(seed) >> 2) * 2);
+		if (it != m.end())
+			sink += it->second;
+	}
+	report(name, "find_hit", n, ops, now_ms() - start, sink);
+
+	start = now_ms();
+	for (size_t i = 0; i < ops; i++) {
+		if (m.find(static_cast<long>(xorshift(seed) >> 2) * 2 + 1) != m.end())
+			sink++;
+	}
+	report(name, "find_miss", n, ops, now_ms() - start, sink);
+
+	// steady state churn: erase the oldest key, insert a new one
+	unsigned long old_seed = 88172645463325252UL;
+	seed = fill_seed;
+	start = now_ms();
+	for (size_t i = 0; i < ops; i++) {
+		sink += m.erase(static_cast<long>(xorshift(old_seed) >> 2) * 2);
+		m.insert(ft::make_pair(static_cast<long>(xorshift(seed) >> 2) * 2, static_cast<long>(i)));
+	}
+	report(name, "churn", n, ops, now_ms() - start, sink + m.size());
+}
+
+// adapter so the std hash map can take ft::pair like the ft containers
+template <typename K, typename V>
+struct std_hash_map : public std::tr1::unordered_map<K, V> {
+	typedef std::tr1::unordered_map<K, V>	base;
+	typedef typename base::iterator			iterator;
+
+	using base::insert;
+	void insert(const ft::pair<K, V>& p) { base::insert(std::make_pair(p.first, p.second)); }
+};
+
+int main() {
+	static const size_t sizes[] = { 1000, 100000, 1000000 };
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		run<ft::unordered_map<long, long> >("ft::unordered_map", sizes[i]);
+		run<std_hash_map<long, long> >("std::tr1::unordered_map", sizes[i]);
+		run<ft::map<long, long> >("ft::map", sizes[i]);
+		std::cout << std::endl;
+	}
+	return 0;
+}
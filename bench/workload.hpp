@@ -0,0 +1,221 @@
+#ifndef BENCH_WORKLOAD_HPP
+#define BENCH_WORKLOAD_HPP
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// key shapes for the benchmarks. Ascending insertion alone flatters some
+// balancing paths and punishes others, so every workload is generated for
+// each distribution below: the order keys are inserted in, the order they are
+// looked up in, read/write mixes and bulk deletes. Keys are multiples of 4 in
+// [0, 4n) unless the distribution repeats them, so misses have room in between.
+
+namespace bench {
+
+	enum key_distribution {
+		dist_uniform,		// independent uniform draws from [0, 4n)
+		dist_zipfian,		// YCSB scrambled Zipfian, theta 0.99: a few keys get most accesses
+		dist_sorted,		// 0, 4, 8, ..
+		dist_reverse,		// .., 8, 4, 0
+		dist_sawtooth,		// sqrt(n) ascending sweeps over the whole range, interleaved
+		dist_clustered,		// runs of 64 adjacent keys, the runs in random order
+		distribution_count
+	};
+
+	inline const char* distribution_name(size_t d) {
+		static const char* names[distribution_count] = {
+			"uniform", "zipfian", "sorted", "reverse", "sawtooth", "cluster"
+		};
+		return d < distribution_count ? names[d] : "?";
+	}
+
+	inline double uniform01(unsigned long& seed) {
+		return static_cast<double>(xorshift(seed) >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	template <typename T>
+	void shuffle(std::vector<T>& v, unsigned long& seed) {
+		for (size_t i = v.size(); i > 1; i--)
+			std::swap(v[i - 1], v[xorshift(seed) % i]);
+	}
+
+	// Gray et al., "Quickly generating billion-record synthetic databases";
+	// the constant-time sampler YCSB uses. next() returns a rank, 0 the hottest.
+	class zipfian_generator {
+		private:
+			unsigned long	_items;
+			double			_theta;
+			double			_alpha;
+			double			_zetan;
+			double			_eta;
+
+		public:
+			explicit zipfian_generator(unsigned long items, double theta = 0.99)
+				: _items(items ? items : 1), _theta(theta), _alpha(1.0 / (1.0 - theta)), _zetan(0), _eta(0) {
+				for (unsigned long i = 1; i <= _items; i++)
+					_zetan += 1.0 / std::pow(static_cast<double>(i), _theta);
+				double zeta2 = 1.0 + 1.0 / std::pow(2.0, _theta);
+				_eta = (1.0 - std::pow(2.0 / static_cast<double>(_items), 1.0 - _theta)) / (1.0 - zeta2 / _zetan);
+			}
+
+			unsigned long next(unsigned long& seed) const {
+				double u = uniform01(seed);
+				double uz = u * _zetan;
+				if (uz < 1.0)
+					return 0;
+				if (uz < 1.0 + std::pow(0.5, _theta))
+					return 1;
+				unsigned long r = static_cast<unsigned long>(static_cast<double>(_items)
+					* std::pow(_eta * u - _eta + 1.0, _alpha));
+				return r < _items ? r : _items - 1;
+			}
+	};
+
+	// spreads Zipfian ranks over the key range so the hot keys are not all small
+	inline long scramble(unsigned long rank, size_t n) {
+		unsigned long h = rank;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdUL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53UL;
+		h ^= h >> 33;
+		return static_cast<long>(h % n) * 4;
+	}
+
+	// n keys in insertion order
+	inline std::vector<long> make_keys(key_distribution d, size_t n, unsigned long seed) {
+		std::vector<long> keys(n);
+		switch (d) {
+			case dist_uniform:
+				for (size_t i = 0; i < n; i++)
+					keys[i] = static_cast<long>(xorshift(seed) % (4 * n));
+				break;
+			case dist_zipfian: {
+				zipfian_generator zipf(n);
+				for (size_t i = 0; i < n; i++)
+					keys[i] = scramble(zipf.next(seed), n);
+				break;
+			}
+			case dist_sorted:
+				for (size_t i = 0; i < n; i++)
+					keys[i] = static_cast<long>(i) * 4;
+				break;
+			case dist_reverse:
+				for (size_t i = 0; i < n; i++)
+					keys[i] = static_cast<long>(n - 1 - i) * 4;
+				break;
+			case dist_sawtooth: {
+				size_t teeth = static_cast<size_t>(std::sqrt(static_cast<double>(n)));
+				if (teeth == 0)
+					teeth = 1;
+				size_t i = 0;
+				for (size_t t = 0; t < teeth; t++)
+					for (size_t k = t; k < n; k += teeth)
+						keys[i++] = static_cast<long>(k) * 4;
+				break;
+			}
+			case dist_clustered: {
+				const size_t width = 64;
+				std::vector<size_t> runs((n + width - 1) / width);
+				for (size_t r = 0; r < runs.size(); r++)
+					runs[r] = r;
+				shuffle(runs, seed);
+				size_t i = 0;
+				for (size_t r = 0; r < runs.size(); r++)
+					for (size_t k = runs[r] * width; k < (runs[r] + 1) * width && k < n; k++)
+						keys[i++] = static_cast<long>(k) * 4;
+				break;
+			}
+			default:
+				break;
+		}
+		return keys;
+	}
+
+	// reads and writes =============================================================
+
+	enum operation_kind {
+		op_read,
+		op_insert,
+		op_erase
+	};
+
+	struct operation {
+		operation_kind	kind;
+		long			key;
+	};
+
+	struct workload {
+		key_distribution	dist;
+		std::vector<long>	keys;			// insertion order; zipfian repeats keys
+		std::vector<long>	lookups;		// n reads, shaped like the distribution
+		std::vector<long>	sorted_keys;	// the distinct keys, ascending
+		std::vector<long>	random_half;	// half of the distinct keys, shuffled
+
+		size_t size() const { return keys.size(); }
+	};
+
+	// Lookups hit inserted keys. Zipfian reads favour the same hot keys the
+	// writes did; sorted, reverse and sawtooth reads repeat the insertion order,
+	// the way a scan follows the shape the data arrived in; uniform and
+	// clustered reads pick inserted keys at random.
+	inline workload make_workload(key_distribution d, size_t n, unsigned long seed) {
+		workload w;
+		w.dist = d;
+		w.keys = make_keys(d, n, seed);
+		if (d == dist_zipfian) {
+			zipfian_generator zipf(n);
+			for (size_t i = 0; i < n; i++)
+				w.lookups.push_back(scramble(zipf.next(seed), n));
+		}
+		else if (d == dist_uniform || d == dist_clustered) {
+			for (size_t i = 0; i < n; i++)
+				w.lookups.push_back(w.keys[xorshift(seed) % n]);
+		}
+		else
+			w.lookups = w.keys;
+		w.sorted_keys = w.keys;
+		std::sort(w.sorted_keys.begin(), w.sorted_keys.end());
+		w.sorted_keys.erase(std::unique(w.sorted_keys.begin(), w.sorted_keys.end()), w.sorted_keys.end());
+		w.random_half = w.sorted_keys;
+		shuffle(w.random_half, seed);
+		w.random_half.resize(w.random_half.size() / 2);
+		return w;
+	}
+
+	// n operations against a container that already holds the first half of
+	// w.keys: read_percent reads (from w.lookups), the rest alternate between
+	// inserting the next key of the second half and erasing a key the reads
+	// could hit, so the size stays about n / 2.
+	inline std::vector<operation> make_mix(const workload& w, unsigned read_percent, unsigned long seed) {
+		size_t n = w.size();
+		size_t half = n / 2;
+		size_t next_insert = half;
+		bool insert_turn = true;
+		std::vector<operation> ops(n);
+		for (size_t i = 0; i < n; i++) {
+			operation& op = ops[i];
+			if (xorshift(seed) % 100 < read_percent || half == 0) {
+				op.kind = op_read;
+				op.key = w.lookups[i];
+			}
+			else if (insert_turn) {
+				op.kind = op_insert;
+				op.key = w.keys[next_insert];
+				next_insert = next_insert + 1 < n ? next_insert + 1 : half;
+			}
+			else {
+				op.kind = op_erase;
+				op.key = w.keys[xorshift(seed) % half];
+			}
+			if (op.kind != op_read)
+				insert_turn = !insert_turn;
+		}
+		return ops;
+	}
+}
+
+#endif
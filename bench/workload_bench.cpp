@@ -0,0 +1,298 @@
+#include "bench.hpp"
+#include "workload.hpp"
+
+#include "vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+// ft vs std for map, set and vector across key distributions (workload.hpp);
+// the "type" column names the distribution. Same harness, options and output
+// as bench_suite, so e.g. --filter /zipfian keeps one distribution.
+//   insert      fill from empty in the distribution's order
+//   find        the distribution's lookups on the filled container
+//   mix95 ..    read/write mixes, 95 / 50 / 5 percent reads, on a half-filled container
+//   del_asc     erase every key in ascending order
+//   del_fifo    erase in insertion order
+//   del_half    erase a random half
+//   del_range   erase the middle half with one range erase
+// vector keeps a sorted array: sort, binary-search find, and sort_insert /
+// mixes through insert at lower_bound (quadratic, so only up to 10000 keys).
+
+static const unsigned	read_percents[] = { 95, 50, 5 };
+static const char*		mix_names[] = { "mix95", "mix50", "mix5" };
+static const size_t		mix_count = sizeof(read_percents) / sizeof(read_percents[0]);
+static const size_t		sorted_vector_limit = 10000;
+
+struct inputs {
+	bench::workload					w;
+	std::vector<bench::operation>	mixes[mix_count];
+
+	inputs(bench::key_distribution d, size_t n) {
+		w = bench::make_workload(d, n, 88172645463325252UL);
+		for (size_t m = 0; m < mix_count; m++)
+			mixes[m] = bench::make_mix(w, read_percents[m], 0x9E3779B97F4A7C15UL);
+	}
+
+	size_t size() const { return w.size(); }
+};
+
+// associative containers =====================================================
+
+struct map_like {
+	template <typename C>
+	static void add(C& c, long k) { c.insert(typename C::value_type(k, 1)); }
+	template <typename It>
+	static size_t weight_of(It it) { return static_cast<size_t>(it->first) + it->second; }
+};
+
+struct set_like {
+	template <typename C>
+	static void add(C& c, long k) { c.insert(k); }
+	template <typename It>
+	static size_t weight_of(It it) { return static_cast<size_t>(*it); }
+};
+
+template <typename C, typename F>
+struct assoc_filled {
+	typedef C fixture;
+	static void setup(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.keys.size(); i++)
+			F::add(c, in.w.keys[i]);
+	}
+};
+
+template <typename C, typename F>
+struct assoc_insert {
+	typedef C fixture;
+	static void setup(C&, const inputs&) {}
+	static size_t run(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.keys.size(); i++)
+			F::add(c, in.w.keys[i]);
+		return c.size();
+	}
+};
+
+template <typename C, typename F>
+struct assoc_find : assoc_filled<C, F> {
+	static size_t run(C& c, const inputs& in) {
+		size_t sum = 0;
+		for (size_t i = 0; i < in.w.lookups.size(); i++) {
+			typename C::iterator it = c.find(in.w.lookups[i]);
+			if (it != c.end())
+				sum += F::weight_of(it);
+		}
+		return sum;
+	}
+};
+
+template <typename C, typename F, size_t Mix>
+struct assoc_mix {
+	typedef C fixture;
+	static void setup(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.keys.size() / 2; i++)
+			F::add(c, in.w.keys[i]);
+	}
+	static size_t run(C& c, const inputs& in) {
+		const std::vector<bench::operation>& ops = in.mixes[Mix];
+		size_t sum = 0;
+		for (size_t i = 0; i < ops.size(); i++) {
+			if (ops[i].kind == bench::op_read) {
+				typename C::iterator it = c.find(ops[i].key);
+				if (it != c.end())
+					sum += F::weight_of(it);
+			}
+			else if (ops[i].kind == bench::op_insert)
+				F::add(c, ops[i].key);
+			else
+				sum += c.erase(ops[i].key);
+		}
+		return sum + c.size();
+	}
+};
+
+template <typename C, typename F>
+struct assoc_erase_ascending : assoc_filled<C, F> {
+	static size_t run(C& c, const inputs& in) {
+		size_t erased = 0;
+		for (size_t i = 0; i < in.w.sorted_keys.size(); i++)
+			erased += c.erase(in.w.sorted_keys[i]);
+		return erased + c.size();
+	}
+};
+
+template <typename C, typename F>
+struct assoc_erase_fifo : assoc_filled<C, F> {
+	static size_t run(C& c, const inputs& in) {
+		size_t erased = 0;
+		for (size_t i = 0; i < in.w.keys.size(); i++)
+			erased += c.erase(in.w.keys[i]);
+		return erased + c.size();
+	}
+};
+
+template <typename C, typename F>
+struct assoc_erase_half : assoc_filled<C, F> {
+	static size_t run(C& c, const inputs& in) {
+		size_t erased = 0;
+		for (size_t i = 0; i < in.w.random_half.size(); i++)
+			erased += c.erase(in.w.random_half[i]);
+		return erased + c.size();
+	}
+};
+
+template <typename C, typename F>
+struct assoc_erase_range : assoc_filled<C, F> {
+	static size_t run(C& c, const inputs& in) {
+		const std::vector<long>& sorted = in.w.sorted_keys;
+		size_t n = sorted.size();
+		c.erase(c.lower_bound(sorted[n / 4]), c.lower_bound(sorted[n - n / 4 - 1]));
+		return c.size();
+	}
+};
+
+template <typename FtC, typename StdC, typename F>
+void assoc_rows(const bench::options& opt, const char* name, const char* type, const inputs& in) {
+	bench::compare<assoc_insert<FtC, F>, assoc_insert<StdC, F> >(opt, name, "insert", type, in);
+	bench::compare<assoc_find<FtC, F>, assoc_find<StdC, F> >(opt, name, "find", type, in);
+	bench::compare<assoc_mix<FtC, F, 0>, assoc_mix<StdC, F, 0> >(opt, name, mix_names[0], type, in);
+	bench::compare<assoc_mix<FtC, F, 1>, assoc_mix<StdC, F, 1> >(opt, name, mix_names[1], type, in);
+	bench::compare<assoc_mix<FtC, F, 2>, assoc_mix<StdC, F, 2> >(opt, name, mix_names[2], type, in);
+	bench::compare<assoc_erase_ascending<FtC, F>, assoc_erase_ascending<StdC, F> >(opt, name, "del_asc", type, in);
+	bench::compare<assoc_erase_fifo<FtC, F>, assoc_erase_fifo<StdC, F> >(opt, name, "del_fifo", type, in);
+	bench::compare<assoc_erase_half<FtC, F>, assoc_erase_half<StdC, F> >(opt, name, "del_half", type, in);
+	bench::compare<assoc_erase_range<FtC, F>, assoc_erase_range<StdC, F> >(opt, name, "del_range", type, in);
+}
+
+// sorted vector ==============================================================
+// std algorithms need std iterator tags, so they run on the element pointers
+
+template <typename C>
+long* first(C& c) { return c.empty() ? NULL : &c[0]; }
+
+template <typename C>
+long* last(C& c) { return c.empty() ? NULL : &c[0] + c.size(); }
+
+template <typename C>
+void sorted_insert(C& c, long k) {
+	size_t pos = std::lower_bound(first(c), last(c), k) - first(c);
+	c.insert(c.begin() + pos, k);
+}
+
+template <typename C>
+size_t sorted_erase(C& c, long k) {
+	long* it = std::lower_bound(first(c), last(c), k);
+	if (it == last(c) || *it != k)
+		return 0;
+	c.erase(c.begin() + (it - first(c)));
+	return 1;
+}
+
+template <typename C>
+struct vec_sort {
+	typedef C fixture;
+	static void setup(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.keys.size(); i++)
+			c.push_back(in.w.keys[i]);
+	}
+	static size_t run(C& c, const inputs&) {
+		std::sort(first(c), last(c));
+		return static_cast<size_t>(c[c.size() / 2]);
+	}
+};
+
+template <typename C>
+struct vec_find {
+	typedef C fixture;
+	static void setup(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.sorted_keys.size(); i++)
+			c.push_back(in.w.sorted_keys[i]);
+	}
+	static size_t run(C& c, const inputs& in) {
+		size_t hits = 0;
+		for (size_t i = 0; i < in.w.lookups.size(); i++)
+			hits += std::binary_search(first(c), last(c), in.w.lookups[i]);
+		return hits;
+	}
+};
+
+template <typename C>
+struct vec_sorted_insert {
+	typedef C fixture;
+	static void setup(C&, const inputs&) {}
+	static size_t run(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.keys.size(); i++)
+			sorted_insert(c, in.w.keys[i]);
+		return c.size() + static_cast<size_t>(c.back());
+	}
+};
+
+template <typename C, size_t Mix>
+struct vec_mix {
+	typedef C fixture;
+	static void setup(C& c, const inputs& in) {
+		for (size_t i = 0; i < in.w.keys.size() / 2; i++)
+			sorted_insert(c, in.w.keys[i]);
+	}
+	static size_t run(C& c, const inputs& in) {
+		const std::vector<bench::operation>& ops = in.mixes[Mix];
+		size_t sum = 0;
+		for (size_t i = 0; i < ops.size(); i++) {
+			if (ops[i].kind == bench::op_read)
+				sum += std::binary_search(first(c), last(c), ops[i].key);
+			else if (ops[i].kind == bench::op_insert)
+				sorted_insert(c, ops[i].key);
+			else
+				sum += sorted_erase(c, ops[i].key);
+		}
+		return sum + c.size();
+	}
+};
+
+template <typename FtC, typename StdC>
+void vector_rows(const bench::options& opt, const char* name, const char* type, const inputs& in) {
+	bench::compare<vec_sort<FtC>, vec_sort<StdC> >(opt, name, "sort", type, in);
+	bench::compare<vec_find<FtC>, vec_find<StdC> >(opt, name, "find", type, in);
+	if (in.size() > sorted_vector_limit)
+		return;
+	bench::compare<vec_sorted_insert<FtC>, vec_sorted_insert<StdC> >(opt, name, "sort_insert", type, in);
+	bench::compare<vec_mix<FtC, 0>, vec_mix<StdC, 0> >(opt, name, mix_names[0], type, in);
+	bench::compare<vec_mix<FtC, 1>, vec_mix<StdC, 1> >(opt, name, mix_names[1], type, in);
+	bench::compare<vec_mix<FtC, 2>, vec_mix<StdC, 2> >(opt, name, mix_names[2], type, in);
+}
+
+// driver =====================================================================
+
+typedef ft::counting_allocator<long>						alloc;
+typedef ft::counting_allocator<ft::pair<const long, int> >	ft_pair_alloc;
+typedef ft::counting_allocator<std::pair<const long, int> >	std_pair_alloc;
+
+typedef ft::vector<long, alloc>										ft_vector;
+typedef std::vector<long, alloc>									std_vector;
+typedef ft::map<long, int, ft::less<long>, ft_pair_alloc>			ft_map;
+typedef std::map<long, int, std::less<long>, std_pair_alloc>		std_map;
+typedef ft::set<long, ft::less<long>, alloc>						ft_set;
+typedef std::set<long, std::less<long>, alloc>						std_set;
+
+int main(int argc, char** argv) {
+	bench::options opt;
+
+	if (!bench::parse_options(argc, argv, opt))
+		return 2;
+	bench::print_header(opt);
+	for (size_t n = opt.min_size; n <= opt.max_size; n *= 10)
+		for (size_t d = 0; d < bench::distribution_count; d++) {
+			const char* type = bench::distribution_name(d);
+			inputs in(static_cast<bench::key_distribution>(d), n);
+			vector_rows<ft_vector, std_vector>(opt, "vector", type, in);
+			assoc_rows<ft_map, std_map, map_like>(opt, "map", type, in);
+			assoc_rows<ft_set, std_set, set_like>(opt, "set", type, in);
+		}
+	std::fprintf(stderr, "# sink %lu\n", static_cast<unsigned long>(bench::sink()));
+	return 0;
+}
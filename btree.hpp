@@ -0,0 +1,758 @@
+#ifndef BTREE_HPP
+#define BTREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include "iterator.hpp"
+#include "reverse_iterator.hpp"
+#include "enable_if.hpp"
+#include "memory_usage.hpp"
+
+// B+-tree: values live only in the leaves, which are chained in both
+// directions so a full scan is a walk over contiguous arrays. Internal nodes
+// only hold separator keys. Both node kinds are sized to FT_BTREE_NODE_BYTES
+// (four cache lines by default), so a lookup touches one node per level
+// instead of one per comparison.
+//
+// Unlike red_black_tree, insert and erase move values between slots, so they
+// invalidate every iterator into the tree.
+
+#ifndef FT_BTREE_NODE_BYTES
+# define FT_BTREE_NODE_BYTES 256
+#endif
+
+namespace ft {
+
+	namespace btree_detail {
+
+		// uninitialized, suitably aligned room for N objects of T
+		template <typename T, int N>
+		union raw_storage {
+			char		bytes[sizeof(T) * N];
+			long double	align_ld;
+			long long	align_ll;
+			void*		align_ptr;
+
+			T*			data() { return reinterpret_cast<T*>(bytes); }
+			const T*	data() const { return reinterpret_cast<const T*>(bytes); }
+		};
+
+		// each node keeps one spare slot: it is filled first and then split
+		template <typename Value, typename Key>
+		struct params {
+			enum {
+				leaf_room = FT_BTREE_NODE_BYTES > 3 * sizeof(void*) ? FT_BTREE_NODE_BYTES - 3 * sizeof(void*) : 0,
+				leaf_fit = leaf_room / sizeof(Value),
+				leaf_slots = leaf_fit < 5 ? 4 : leaf_fit - 1,
+				internal_room = FT_BTREE_NODE_BYTES > 2 * sizeof(void*) ? FT_BTREE_NODE_BYTES - 2 * sizeof(void*) : 0,
+				internal_fit = internal_room / (sizeof(Key) + sizeof(void*)),
+				internal_slots = internal_fit < 5 ? 4 : internal_fit - 1
+			};
+		};
+
+		struct node_base {
+			bool			leaf;
+			unsigned short	count;
+		};
+
+		template <typename Value, int N>
+		struct leaf_node : public node_base {
+			leaf_node*					prev;
+			leaf_node*					next;
+			raw_storage<Value, N + 1>	storage;
+
+			Value*	values() { return storage.data(); }
+		};
+
+		template <typename Key, int N>
+		struct internal_node : public node_base {
+			node_base*					children[N + 2];
+			raw_storage<Key, N + 1>		storage;
+
+			Key*	keys() { return storage.data(); }
+		};
+	}
+
+	template <typename Leaf, typename T>
+	class btree_iterator : public ft::iterator<ft::bidirectional_iterator_tag, T> {
+		public:
+			typedef	bidirectional_iterator_tag		iterator_category;
+			typedef	T								value_type;
+			typedef	T*								pointer;
+			typedef	T&								reference;
+			typedef	std::ptrdiff_t					difference_type;
+
+		private:
+			Leaf*	_leaf;
+			int		_pos;
+
+		public:
+			btree_iterator() : _leaf(NULL), _pos(0) {}
+			btree_iterator(Leaf* leaf, int pos) : _leaf(leaf), _pos(pos) {}
+			btree_iterator(const btree_iterator& other) : _leaf(other._leaf), _pos(other._pos) {}
+			template <typename U>
+			btree_iterator(const btree_iterator<Leaf, U>& other) : _leaf(other.leaf()), _pos(other.pos()) {}
+			~btree_iterator() {}
+
+			btree_iterator& operator=(const btree_iterator& other) {
+				_leaf = other._leaf;
+				_pos = other._pos;
+				return *this;
+			}
+
+			Leaf*	leaf() const { return _leaf; }
+			int		pos() const { return _pos; }
+
+			reference operator*() const { return _leaf->values()[_pos]; }
+			pointer operator->() const { return &_leaf->values()[_pos]; }
+
+			// end() is one past the last slot of the last leaf
+			btree_iterator& operator++() {
+				if (++_pos == _leaf->count && _leaf->next != NULL) {
+					_leaf = _leaf->next;
+					_pos = 0;
+				}
+				return *this;
+			}
+			btree_iterator operator++(int) {
+				btree_iterator tmp(*this);
+				++(*this);
+				return tmp;
+			}
+
+			btree_iterator& operator--() {
+				if (_pos == 0 && _leaf->prev != NULL) {
+					_leaf = _leaf->prev;
+					_pos = _leaf->count;
+				}
+				--_pos;
+				return *this;
+			}
+			btree_iterator operator--(int) {
+				btree_iterator tmp(*this);
+				--(*this);
+				return tmp;
+			}
+	};
+
+	template <typename Leaf, typename T1, typename T2>
+	bool operator==(const btree_iterator<Leaf, T1>& lhs, const btree_iterator<Leaf, T2>& rhs) {
+		return lhs.leaf() == rhs.leaf() && lhs.pos() == rhs.pos();
+	}
+	template <typename Leaf, typename T1, typename T2>
+	bool operator!=(const btree_iterator<Leaf, T1>& lhs, const btree_iterator<Leaf, T2>& rhs) {
+		return !(lhs == rhs);
+	}
+
+	template <typename Value, typename Key, typename KeyOfValue, typename Compare, typename Alloc>
+	class btree {
+
+	// typedefs =========================================================================================
+
+		private:
+			typedef btree_detail::params<Value, Key>	params;
+
+			enum {
+				leaf_slots = params::leaf_slots,
+				internal_slots = params::internal_slots,
+				leaf_min = leaf_slots / 2,
+				internal_min = internal_slots / 2,
+				max_height = 64
+			};
+
+			typedef btree_detail::node_base									node_base;
+			typedef btree_detail::leaf_node<Value, leaf_slots>				leaf_type;
+			typedef btree_detail::internal_node<Key, internal_slots>		internal_type;
+			typedef typename Alloc::template rebind<leaf_type>::other		leaf_alloc_type;
+			typedef typename Alloc::template rebind<internal_type>::other	internal_alloc_type;
+			typedef typename Alloc::template rebind<Key>::other				key_alloc_type;
+
+			struct path_entry {
+				internal_type*	node;
+				int				index;
+			};
+
+		public:
+			typedef Key													key_type;
+			typedef Value												value_type;
+			typedef Compare												key_compare;
+			typedef Alloc												allocator_type;
+			typedef size_t												size_type;
+			typedef ptrdiff_t											difference_type;
+			typedef typename allocator_type::pointer					pointer;
+			typedef typename allocator_type::const_pointer				const_pointer;
+			typedef typename allocator_type::reference					reference;
+			typedef typename allocator_type::const_reference			const_reference;
+			typedef ft::btree_iterator<leaf_type, value_type>			iterator;
+			typedef ft::btree_iterator<leaf_type, const value_type>		const_iterator;
+			typedef ft::reverse_iterator<iterator>						reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>				const_reverse_iterator;
+
+	// ==================================================================================================
+
+	// private members ==================================================================================
+
+		private:
+			key_compare			_comp;
+			KeyOfValue			_key_of;
+			allocator_type		_alloc;
+			leaf_alloc_type		_leaf_alloc;
+			internal_alloc_type	_internal_alloc;
+			key_alloc_type		_key_alloc;
+			node_base*			_root;
+			leaf_type*			_first;
+			leaf_type*			_last;
+			size_type			_size;
+
+		public:
+			btree(const key_compare& comp, const allocator_type& alloc)
+				: _comp(comp), _key_of(), _alloc(alloc), _leaf_alloc(alloc), _internal_alloc(alloc), _key_alloc(alloc),
+				_root(NULL), _first(NULL), _last(NULL), _size(0) {
+				reset_root();
+			}
+
+			btree(const btree& x)
+				: _comp(x._comp), _key_of(), _alloc(x._alloc), _leaf_alloc(x._leaf_alloc), _internal_alloc(x._internal_alloc),
+				_key_alloc(x._key_alloc), _root(NULL), _first(NULL), _last(NULL), _size(0) {
+				reset_root();
+				insert(x.begin(), x.end());
+			}
+
+			btree& operator=(const btree& x) {
+				if (this == &x)
+					return *this;
+				clear();
+				_comp = x._comp;
+				insert(x.begin(), x.end());
+				return *this;
+			}
+
+			~btree() {
+				destroy_subtree(_root);
+			}
+
+	// ==================================================================================================
+
+	// iterators ========================================================================================
+
+		public:
+			iterator				begin() { return iterator(_first, 0); }
+			const_iterator			begin() const { return const_iterator(_first, 0); }
+			iterator				end() { return iterator(_last, _last->count); }
+			const_iterator			end() const { return const_iterator(_last, _last->count); }
+			reverse_iterator		rbegin() { return reverse_iterator(end()); }
+			const_reverse_iterator	rbegin() const { return const_reverse_iterator(end()); }
+			reverse_iterator		rend() { return reverse_iterator(begin()); }
+			const_reverse_iterator	rend() const { return const_reverse_iterator(begin()); }
+
+	// ==================================================================================================
+
+	// private member func ==============================================================================
+
+		private:
+			const key_type&	key_at(leaf_type* leaf, int i) const { return _key_of(leaf->values()[i]); }
+
+			leaf_type* new_leaf() {
+				leaf_type* leaf = _leaf_alloc.allocate(1);
+				leaf->leaf = true;
+				leaf->count = 0;
+				leaf->prev = NULL;
+				leaf->next = NULL;
+				return leaf;
+			}
+
+			internal_type* new_internal() {
+				internal_type* node = _internal_alloc.allocate(1);
+				node->leaf = false;
+				node->count = 0;
+				return node;
+			}
+
+			void reset_root() {
+				_first = new_leaf();
+				_last = _first;
+				_root = _first;
+				_size = 0;
+			}
+
+			// height is logarithmic, so recursing here is bounded
+			void destroy_subtree(node_base* node) {
+				if (node->leaf) {
+					leaf_type* leaf = static_cast<leaf_type*>(node);
+					for (int i = 0; i < leaf->count; i++)
+						_alloc.destroy(leaf->values() + i);
+					_leaf_alloc.deallocate(leaf, 1);
+					return;
+				}
+				internal_type* in = static_cast<internal_type*>(node);
+				for (int i = 0; i <= in->count; i++)
+					destroy_subtree(in->children[i]);
+				for (int i = 0; i < in->count; i++)
+					_key_alloc.destroy(in->keys() + i);
+				_internal_alloc.deallocate(in, 1);
+			}
+
+			// the searches below are branch free binary searches: the number of
+			// steps only depends on count, so they do not mispredict on random keys
+
+			// first slot whose key is not less than k
+			int leaf_lower(leaf_type* leaf, const key_type& k) const {
+				int base = 0;
+				int n = leaf->count;
+				if (n == 0)
+					return 0;
+				while (n > 1) {
+					int half = n >> 1;
+					base = _comp(key_at(leaf, base + half), k) ? base + half : base;
+					n -= half;
+				}
+				return base + _comp(key_at(leaf, base), k);
+			}
+
+			// first slot whose key is greater than k
+			int leaf_upper(leaf_type* leaf, const key_type& k) const {
+				int base = 0;
+				int n = leaf->count;
+				if (n == 0)
+					return 0;
+				while (n > 1) {
+					int half = n >> 1;
+					base = _comp(k, key_at(leaf, base + half)) ? base : base + half;
+					n -= half;
+				}
+				return base + !_comp(k, key_at(leaf, base));
+			}
+
+			// separators satisfy left < sep <= right, so equal keys go right
+			int child_index(internal_type* node, const key_type& k) const {
+				const key_type* keys = node->keys();
+				int base = 0;
+				int n = node->count;
+				if (n == 0)
+					return 0;
+				while (n > 1) {
+					int half = n >> 1;
+					base = _comp(k, keys[base + half]) ? base : base + half;
+					n -= half;
+				}
+				return base + !_comp(k, keys[base]);
+			}
+
+			leaf_type* find_leaf(const key_type& k) const {
+				node_base* node = _root;
+				while (!node->leaf) {
+					internal_type* in = static_cast<internal_type*>(node);
+					node = in->children[child_index(in, k)];
+				}
+				return static_cast<leaf_type*>(node);
+			}
+
+			leaf_type* find_leaf(const key_type& k, path_entry* path, int& depth) const {
+				node_base* node = _root;
+				depth = 0;
+				while (!node->leaf) {
+					internal_type* in = static_cast<internal_type*>(node);
+					int i = child_index(in, k);
+					path[depth].node = in;
+					path[depth].index = i;
+					depth++;
+					node = in->children[i];
+				}
+				return static_cast<leaf_type*>(node);
+			}
+
+			// a position equal to count is only valid as end() on the last leaf
+			iterator normalize(leaf_type* leaf, int pos) const {
+				if (pos == leaf->count && leaf->next != NULL)
+					return iterator(leaf->next, 0);
+				return iterator(leaf, pos);
+			}
+
+			void move_value(value_type* from, value_type* to) {
+				_alloc.construct(to, *from);
+				_alloc.destroy(from);
+			}
+
+			void move_key(key_type* from, key_type* to) {
+				_key_alloc.construct(to, *from);
+				_key_alloc.destroy(from);
+			}
+
+			void set_key(internal_type* node, int i, const key_type& k) {
+				_key_alloc.destroy(node->keys() + i);
+				_key_alloc.construct(node->keys() + i, k);
+			}
+
+			void leaf_insert_at(leaf_type* leaf, int pos, const value_type& val) {
+				value_type* v = leaf->values();
+				for (int j = leaf->count; j > pos; j--)
+					move_value(v + j - 1, v + j);
+				_alloc.construct(v + pos, val);
+				leaf->count++;
+			}
+
+			void leaf_erase_at(leaf_type* leaf, int pos) {
+				value_type* v = leaf->values();
+				_alloc.destroy(v + pos);
+				for (int j = pos + 1; j < leaf->count; j++)
+					move_value(v + j, v + j - 1);
+				leaf->count--;
+			}
+
+			// key i and child i + 1 go in together
+			void internal_insert_at(internal_type* node, int i, const key_type& k, node_base* child) {
+				key_type* keys = node->keys();
+				for (int j = node->count; j > i; j--) {
+					move_key(keys + j - 1, keys + j);
+					node->children[j + 1] = node->children[j];
+				}
+				_key_alloc.construct(keys + i, k);
+				node->children[i + 1] = child;
+				node->count++;
+			}
+
+			// key i and child i + 1 go out together
+			void internal_erase_at(internal_type* node, int i) {
+				key_type* keys = node->keys();
+				_key_alloc.destroy(keys + i);
+				for (int j = i + 1; j < node->count; j++) {
+					move_key(keys + j, keys + j - 1);
+					node->children[j] = node->children[j + 1];
+				}
+				node->count--;
+			}
+
+			void unlink_leaf(leaf_type* leaf) {
+				if (leaf->prev != NULL)
+					leaf->prev->next = leaf->next;
+				else
+					_first = leaf->next;
+				if (leaf->next != NULL)
+					leaf->next->prev = leaf->prev;
+				else
+					_last = leaf->prev;
+			}
+
+			// splits an overfull leaf (leaf_slots + 1 values). Appending to the
+			// rightmost leaf keeps it full and starts a new one, so sorted input
+			// packs the leaves instead of leaving them half empty.
+			leaf_type* split_leaf(leaf_type* leaf, int split) {
+				leaf_type* right = new_leaf();
+				for (int j = split; j < leaf->count; j++)
+					move_value(leaf->values() + j, right->values() + (j - split));
+				right->count = leaf->count - split;
+				leaf->count = split;
+				right->prev = leaf;
+				right->next = leaf->next;
+				if (leaf->next != NULL)
+					leaf->next->prev = right;
+				else
+					_last = right;
+				leaf->next = right;
+				return right;
+			}
+
+			void insert_into_parent(path_entry* path, int depth, const key_type& k, node_base* child) {
+				key_type sep(k);
+				while (true) {
+					if (depth == 0) {
+						internal_type* root = new_internal();
+						root->children[0] = _root;
+						_key_alloc.construct(root->keys(), sep);
+						root->children[1] = child;
+						root->count = 1;
+						_root = root;
+						return;
+					}
+					internal_type* parent = path[depth - 1].node;
+					internal_insert_at(parent, path[depth - 1].index, sep, child);
+					if (parent->count <= internal_slots)
+						return;
+					// promote the middle key, the right half becomes a new node
+					int mid = parent->count / 2;
+					internal_type* right = new_internal();
+					key_type* keys = parent->keys();
+					for (int j = mid + 1; j < parent->count; j++) {
+						move_key(keys + j, right->keys() + (j - mid - 1));
+						right->children[j - mid - 1] = parent->children[j];
+					}
+					right->children[parent->count - mid - 1] = parent->children[parent->count];
+					right->count = parent->count - mid - 1;
+					sep = keys[mid];
+					_key_alloc.destroy(keys + mid);
+					parent->count = mid;
+					child = right;
+					depth--;
+				}
+			}
+
+			void rebalance_leaf(path_entry* path, int depth, leaf_type* leaf) {
+				if (depth == 0 || leaf->count >= leaf_min)
+					return;
+				internal_type* parent = path[depth - 1].node;
+				int i = path[depth - 1].index;
+				if (i > 0) {
+					leaf_type* left = static_cast<leaf_type*>(parent->children[i - 1]);
+					if (left->count + leaf->count <= leaf_slots) {
+						for (int j = 0; j < leaf->count; j++)
+							move_value(leaf->values() + j, left->values() + left->count + j);
+						left->count += leaf->count;
+						unlink_leaf(leaf);
+						_leaf_alloc.deallocate(leaf, 1);
+						internal_erase_at(parent, i - 1);
+						rebalance_internal(path, depth - 1);
+						return;
+					}
+					value_type* v = leaf->values();
+					for (int j = leaf->count; j > 0; j--)
+						move_value(v + j - 1, v + j);
+					move_value(left->values() + left->count - 1, v);
+					left->count--;
+					leaf->count++;
+					set_key(parent, i - 1, key_at(leaf, 0));
+					return;
+				}
+				leaf_type* right = static_cast<leaf_type*>(parent->children[i + 1]);
+				if (leaf->count + right->count <= leaf_slots) {
+					for (int j = 0; j < right->count; j++)
+						move_value(right->values() + j, leaf->values() + leaf->count + j);
+					leaf->count += right->count;
+					unlink_leaf(right);
+					_leaf_alloc.deallocate(right, 1);
+					internal_erase_at(parent, i);
+					rebalance_internal(path, depth - 1);
+					return;
+				}
+				move_value(right->values(), leaf->values() + leaf->count);
+				leaf->count++;
+				value_type* v = right->values();
+				for (int j = 1; j < right->count; j++)
+					move_value(v + j, v + j - 1);
+				right->count--;
+				set_key(parent, i, key_at(right, 0));
+			}
+
+			void rebalance_internal(path_entry* path, int level) {
+				while (true) {
+					internal_type* node = path[level].node;
+					if (level == 0) {
+						if (node->count == 0) {
+							_root = node->children[0];
+							_internal_alloc.deallocate(node, 1);
+						}
+						return;
+					}
+					if (node->count >= internal_min)
+						return;
+					internal_type* parent = path[level - 1].node;
+					int i = path[level - 1].index;
+					internal_type* left = i > 0 ? static_cast<internal_type*>(parent->children[i - 1]) : node;
+					internal_type* right = i > 0 ? node : static_cast<internal_type*>(parent->children[i + 1]);
+					int sep = i > 0 ? i - 1 : i;
+					if (left->count + right->count + 1 <= internal_slots) {
+						// pull the separator down and append right to left
+						_key_alloc.construct(left->keys() + left->count, parent->keys()[sep]);
+						for (int j = 0; j < right->count; j++) {
+							move_key(right->keys() + j, left->keys() + left->count + 1 + j);
+							left->children[left->count + 1 + j] = right->children[j];
+						}
+						left->children[left->count + 1 + right->count] = right->children[right->count];
+						left->count += right->count + 1;
+						_internal_alloc.deallocate(right, 1);
+						internal_erase_at(parent, sep);
+						level--;
+						continue;
+					}
+					if (node == right) {
+						// rotate the last child of left through the parent
+						for (int j = right->count; j > 0; j--)
+							move_key(right->keys() + j - 1, right->keys() + j);
+						for (int j = right->count + 1; j > 0; j--)
+							right->children[j] = right->children[j - 1];
+						_key_alloc.construct(right->keys(), parent->keys()[sep]);
+						right->children[0] = left->children[left->count];
+						right->count++;
+						set_key(parent, sep, left->keys()[left->count - 1]);
+						_key_alloc.destroy(left->keys() + left->count - 1);
+						left->count--;
+					} else {
+						// rotate the first child of right through the parent
+						_key_alloc.construct(left->keys() + left->count, parent->keys()[sep]);
+						left->children[left->count + 1] = right->children[0];
+						left->count++;
+						set_key(parent, sep, right->keys()[0]);
+						_key_alloc.destroy(right->keys());
+						for (int j = 1; j < right->count; j++)
+							move_key(right->keys() + j, right->keys() + j - 1);
+						for (int j = 0; j < right->count; j++)
+							right->children[j] = right->children[j + 1];
+						right->count--;
+					}
+					return;
+				}
+			}
+
+	// ==================================================================================================
+
+	// capacity =========================================================================================
+
+		public:
+			bool		empty() const { return _size == 0; }
+			size_type	size() const { return _size; }
+			size_type	max_size() const { return _alloc.max_size(); }
+
+	// ==================================================================================================
+
+	// insert ===========================================================================================
+
+			pair<iterator, bool> insert(const value_type& val) {
+				const key_type& k = _key_of(val);
+				path_entry path[max_height];
+				int depth;
+				leaf_type* leaf = find_leaf(k, path, depth);
+				int pos = leaf_lower(leaf, k);
+				if (pos < leaf->count && !_comp(k, key_at(leaf, pos)))
+					return ft::make_pair(iterator(leaf, pos), false);
+				bool append = leaf->next == NULL && pos == leaf->count;
+				leaf_insert_at(leaf, pos, val);
+				++_size;
+				if (leaf->count <= leaf_slots)
+					return ft::make_pair(iterator(leaf, pos), true);
+				int split = append ? leaf_slots : leaf->count / 2;
+				leaf_type* right = split_leaf(leaf, split);
+				insert_into_parent(path, depth, key_at(right, 0), right);
+				if (pos < split)
+					return ft::make_pair(iterator(leaf, pos), true);
+				return ft::make_pair(iterator(right, pos - split), true);
+			}
+
+			iterator insert(iterator position, const value_type& val) {
+				(void)position;
+				return insert(val).first;
+			}
+
+			template <typename InputIterator>
+			void insert(InputIterator first, InputIterator last,
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = NULL) {
+				for (; first != last; ++first)
+					insert(*first);
+			}
+
+	// ==================================================================================================
+
+	// erase ============================================================================================
+
+			size_type erase(const key_type& k) {
+				path_entry path[max_height];
+				int depth;
+				leaf_type* leaf = find_leaf(k, path, depth);
+				int pos = leaf_lower(leaf, k);
+				if (pos == leaf->count || _comp(k, key_at(leaf, pos)))
+					return 0;
+				leaf_erase_at(leaf, pos);
+				--_size;
+				rebalance_leaf(path, depth, leaf);
+				return 1;
+			}
+
+			void erase(const_iterator position) {
+				key_type k(_key_of(*position));
+				erase(k);
+			}
+
+			// erasing moves the survivors, so walk the range by key
+			void erase(const_iterator first, const_iterator last) {
+				if (first == begin() && last == end()) {
+					clear();
+					return;
+				}
+				difference_type n = ft::distance(first, last);
+				while (n-- > 0) {
+					key_type k(_key_of(*first));
+					erase(k);
+					first = lower_bound(k);
+				}
+			}
+
+			void clear() {
+				destroy_subtree(_root);
+				reset_root();
+			}
+
+	// ==================================================================================================
+
+	// swap =============================================================================================
+
+			void swap(btree& ref) {
+				if (this == &ref)
+					return;
+				std::swap(_comp, ref._comp);
+				std::swap(_alloc, ref._alloc);
+				std::swap(_leaf_alloc, ref._leaf_alloc);
+				std::swap(_internal_alloc, ref._internal_alloc);
+				std::swap(_key_alloc, ref._key_alloc);
+				std::swap(_root, ref._root);
+				std::swap(_first, ref._first);
+				std::swap(_last, ref._last);
+				std::swap(_size, ref._size);
+			}
+
+	// ==================================================================================================
+
+	// lookup ===========================================================================================
+
+			iterator find(const key_type& k) const {
+				leaf_type* leaf = find_leaf(k);
+				int pos = leaf_lower(leaf, k);
+				if (pos == leaf->count || _comp(k, key_at(leaf, pos)))
+					return iterator(_last, _last->count);
+				return iterator(leaf, pos);
+			}
+
+			size_type count(const key_type& k) const {
+				return find(k) == end() ? 0 : 1;
+			}
+
+			iterator lower_bound(const key_type& k) const {
+				leaf_type* leaf = find_leaf(k);
+				return normalize(leaf, leaf_lower(leaf, k));
+			}
+
+			iterator upper_bound(const key_type& k) const {
+				leaf_type* leaf = find_leaf(k);
+				return normalize(leaf, leaf_upper(leaf, k));
+			}
+
+	// ==================================================================================================
+
+	// observers ========================================================================================
+
+			key_compare		key_comp() const { return _comp; }
+			allocator_type	get_allocator() const { return _alloc; }
+
+			// unused leaf slots and the inner nodes (separator keys included) are overhead
+			ft::memory_footprint memory_usage() const {
+				ft::memory_footprint m;
+				size_type leaves = 0;
+				for (const leaf_type* leaf = _first; leaf != NULL; leaf = leaf->next)
+					leaves++;
+				m.add_blocks(sizeof(leaf_type), leaves, _size * sizeof(value_type));
+				m.add_blocks(sizeof(internal_type), count_internal(_root), 0);
+				return m;
+			}
+
+		private:
+			static size_type count_internal(const node_base* node) {
+				if (node->leaf)
+					return 0;
+				const internal_type* in = static_cast<const internal_type*>(node);
+				size_type n = 1;
+				for (int i = 0; i <= in->count; i++)
+					n += count_internal(in->children[i]);
+				return n;
+			}
+	};
+}
+
+#endif
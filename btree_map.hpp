@@ -0,0 +1,203 @@
+#ifndef BTREE_MAP_HPP
+#define BTREE_MAP_HPP
+
+#include "btree.hpp"
+#include <memory>
+
+namespace ft{
+	// Drop-in for ft::map backed by a B+-tree. Same interface and iterator
+	// category, but insert/erase invalidate all iterators (see btree.hpp).
+	template<typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class btree_map{
+	public:
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef ft::pair<const Key, T> value_type;
+		typedef Compare key_compare;
+		typedef Alloc allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		typedef typename allocator_type::pointer pointer;
+		typedef typename allocator_type::const_pointer const_pointer;
+		typedef typename allocator_type::reference reference;
+		typedef typename allocator_type::const_reference const_reference;
+
+	private:
+		typedef ft::btree<value_type, key_type, ft::select_first<value_type>, key_compare, allocator_type> tree_type;
+
+	public:
+		typedef typename tree_type::iterator iterator;
+		typedef typename tree_type::const_iterator const_iterator;
+		typedef typename tree_type::reverse_iterator reverse_iterator;
+		typedef typename tree_type::const_reverse_iterator const_reverse_iterator;
+
+		class value_compare : public std::binary_function<value_type, value_type, bool>{
+			friend class btree_map;
+			protected:
+			Compare comp;
+			value_compare(Compare const& c) : comp(c) {}
+		public:
+			typedef bool result_type;
+			typedef value_type first_argument_type;
+			typedef value_type second_argument_type;
+			bool operator()(const value_type& x, const value_type& y) const{
+				return comp(x.first, y.first);
+			}
+		};
+
+	private:
+		tree_type	_tree;
+	public:
+		explicit btree_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+		: _tree(comp, alloc){}
+
+		template<typename InputIterator>
+		btree_map(InputIterator first, InputIterator last,
+		 const key_compare& comp = key_compare(),
+		 const allocator_type& alloc = allocator_type())
+		 : _tree(comp, alloc){
+			insert(first, last);
+		}
+		btree_map(const btree_map& x) : _tree(x._tree){}
+		~btree_map(){}
+
+		btree_map& operator=(const btree_map& x){
+			if(this == &x)
+				return *this;
+			_tree = x._tree;
+			return *this;
+		}
+
+		iterator begin(){return _tree.begin();}
+		const_iterator begin() const{return _tree.begin();}
+
+		iterator end(){return _tree.end();}
+		const_iterator end() const{return _tree.end();}
+
+		reverse_iterator rbegin(){return _tree.rbegin();}
+		const_reverse_iterator rbegin() const{return _tree.rbegin();}
+
+		reverse_iterator rend(){return _tree.rend();}
+		const_reverse_iterator rend() const{return _tree.rend();}
+
+		bool empty() const{return _tree.empty();}
+		size_type size() const{return _tree.size();}
+		size_type max_size() const{return _tree.max_size();}
+
+		mapped_type& operator[](const key_type& k){
+			iterator it = _tree.find(k);
+			if (it == end())
+				it = _tree.insert(value_type(k, mapped_type())).first;
+			return it->second;
+		}
+
+		//insert
+		pair<iterator, bool> insert(const value_type& val){
+			return _tree.insert(val);
+		}
+		iterator insert(iterator position, const value_type& val){
+			return _tree.insert(position, val);
+		}
+		template<typename InputIterator>
+		void insert(InputIterator first, InputIterator last){
+			_tree.insert(first, last);
+		}
+
+		void erase(iterator position){
+			_tree.erase(position);
+		}
+		size_type erase(const key_type& k){
+			return _tree.erase(k);
+		}
+		void erase(iterator first, iterator last){
+			_tree.erase(first, last);
+		}
+		void swap(btree_map& x){
+			_tree.swap(x._tree);
+		}
+		void clear(){
+			_tree.clear();
+		}
+		key_compare key_comp() const{
+			return _tree.key_comp();
+		}
+		value_compare value_comp() const{
+			return value_compare(_tree.key_comp());
+		}
+
+		iterator find(const key_type& k){
+			return _tree.find(k);
+		}
+		const_iterator find(const key_type& k) const{
+			return _tree.find(k);
+		}
+		size_type count(const key_type& k) const{
+			return _tree.count(k);
+		}
+
+		iterator lower_bound(const key_type& key){
+			return _tree.lower_bound(key);
+		}
+		const_iterator lower_bound(const key_type& key) const{
+			return _tree.lower_bound(key);
+		}
+		iterator upper_bound(const key_type& key){
+			return _tree.upper_bound(key);
+		}
+		const_iterator upper_bound(const key_type& key) const{
+			return _tree.upper_bound(key);
+		}
+
+		pair<const_iterator, const_iterator> equal_range(const key_type& k) const{
+			return ft::make_pair(lower_bound(k), upper_bound(k));
+		}
+		pair<iterator, iterator> equal_range(const key_type& k){
+			return ft::make_pair(lower_bound(k), upper_bound(k));
+		}
+		allocator_type get_allocator() const{
+			return _tree.get_allocator();
+		}
+		ft::memory_footprint memory_usage() const{
+			return _tree.memory_usage();
+		}
+	};
+	template <class Key, class T, class Compare, class Alloc>
+	void swap(btree_map<Key, T, Compare, Alloc>& x, btree_map<Key, T, Compare, Alloc>& y) {
+		x.swap(y);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator==(const btree_map<Key, T, Compare, Alloc>& x, const btree_map<Key, T, Compare, Alloc>& y) {
+		if (x.size() != y.size())
+			return false;
+		return ft::equal(x.begin(), x.end(), y.begin());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator!=(const btree_map<Key, T, Compare, Alloc>& x, const btree_map<Key, T, Compare, Alloc>& y) {
+		return !(x == y);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator<(const btree_map<Key, T, Compare, Alloc>& x, const btree_map<Key, T, Compare, Alloc>& y) {
+		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator<=(const btree_map<Key, T, Compare, Alloc>& x, const btree_map<Key, T, Compare, Alloc>& y) {
+		return !(y < x);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator>(const btree_map<Key, T, Compare, Alloc>& x, const btree_map<Key, T, Compare, Alloc>& y) {
+		return y < x;
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator>=(const btree_map<Key, T, Compare, Alloc>& x, const btree_map<Key, T, Compare, Alloc>& y) {
+		return !(x < y);
+	}
+
+};
+#endif
@@ -0,0 +1,215 @@
+#ifndef BTREE_SET_HPP
+#define BTREE_SET_HPP
+
+#include "btree.hpp"
+#include <memory>
+
+namespace ft {
+
+	// Drop-in for ft::set backed by a B+-tree. Same interface and iterator
+	// category, but insert/erase invalidate all iterators (see btree.hpp).
+	template <class Key, class Compare = ft::less<Key>, class Alloc = std::allocator<Key> >
+	class btree_set {
+		private:
+		typedef ft::btree<Key, Key, ft::identity<Key>, Compare, Alloc> tree_type;
+
+		public:
+		typedef Key key_type;
+		typedef Key value_type;
+		typedef Compare key_compare;
+		typedef Compare value_compare;
+		typedef Alloc allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef typename allocator_type::reference reference;
+		typedef typename allocator_type::const_reference const_reference;
+		typedef typename allocator_type::pointer pointer;
+		typedef typename allocator_type::const_pointer const_pointer;
+		typedef typename tree_type::const_iterator iterator;
+		typedef typename tree_type::const_iterator const_iterator;
+		typedef typename ft::reverse_iterator<iterator> reverse_iterator;
+		typedef typename ft::reverse_iterator<const_iterator> const_reverse_iterator;
+
+		private:
+			tree_type _tree;
+
+		public:
+			explicit btree_set(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: _tree(comp, alloc) {}
+
+			template <class InputIterator>
+			btree_set(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: _tree(comp, alloc) {
+				_tree.insert(first, last);
+			}
+
+			btree_set(const btree_set& ref)
+			: _tree(ref._tree) {}
+
+			~btree_set() {}
+
+			btree_set& operator=(const btree_set& ref) {
+				_tree = ref._tree;
+				return *this;
+			}
+
+			//iterators
+			iterator begin() {
+				return _tree.begin();
+			}
+
+			const_iterator begin() const {
+				return _tree.begin();
+			}
+
+			iterator end() {
+				return _tree.end();
+			}
+
+			const_iterator end() const {
+				return _tree.end();
+			}
+
+			reverse_iterator rbegin() {
+				return reverse_iterator(end());
+			}
+
+			const_reverse_iterator rbegin() const {
+				return const_reverse_iterator(end());
+			}
+
+			reverse_iterator rend() {
+				return reverse_iterator(begin());
+			}
+
+			const_reverse_iterator rend() const {
+				return const_reverse_iterator(begin());
+			}
+
+			//capacity
+			bool empty() const {
+				return _tree.empty();
+			}
+
+			size_type size() const {
+				return _tree.size();
+			}
+
+			size_type max_size() const {
+				return _tree.max_size();
+			}
+
+			//modifiers
+			pair<iterator, bool> insert(const value_type& val) {
+				return _tree.insert(val);
+			}
+
+			iterator insert(iterator position, const value_type& val) {
+				(void)position;
+				return _tree.insert(val).first;
+			}
+
+			template <class InputIterator>
+			void insert(InputIterator first, InputIterator last) {
+				_tree.insert(first, last);
+			}
+
+			void erase(iterator position) {
+				_tree.erase(position);
+			}
+
+			size_type erase(const key_type& k) {
+				return _tree.erase(k);
+			}
+
+			void erase(iterator first, iterator last) {
+				_tree.erase(first, last);
+			}
+
+			void swap(btree_set& x) {
+				_tree.swap(x._tree);
+			}
+
+			void clear() {
+				_tree.clear();
+			}
+
+			key_compare key_comp() const {
+				return _tree.key_comp();
+			}
+
+			value_compare value_comp() const {
+				return _tree.key_comp();
+			}
+
+			//operations
+			iterator find(const key_type& k) const {
+				return _tree.find(k);
+			}
+
+			size_type count(const key_type& k) const {
+				return _tree.count(k);
+			}
+
+			iterator lower_bound(const key_type& k) const {
+				return _tree.lower_bound(k);
+			}
+
+			iterator upper_bound(const key_type& k) const {
+				return _tree.upper_bound(k);
+			}
+
+			pair<iterator,iterator>	equal_range(const key_type& k) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+			//allocator
+			allocator_type get_allocator() const {
+				return _tree.get_allocator();
+			}
+
+			ft::memory_footprint memory_usage() const {
+				return _tree.memory_usage();
+			}
+	};
+
+	template <class Key, class Compare, class Alloc>
+	void swap(ft::btree_set<Key, Compare, Alloc>& lhs, ft::btree_set<Key, Compare, Alloc>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template <class Key, class Compare, class Alloc>
+	bool operator==(const ft::btree_set<Key, Compare, Alloc>& lhs, const ft::btree_set<Key, Compare, Alloc>& rhs) {
+		if (lhs.size() != rhs.size())
+			return false;
+		return ft::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class Key, class Compare, class Alloc>
+	bool operator!=(const ft::btree_set<Key, Compare, Alloc>& lhs, const ft::btree_set<Key, Compare, Alloc>& rhs) {
+		return !(lhs == rhs);
+	}
+
+	template <class Key, class Compare, class Alloc>
+	bool operator<(const ft::btree_set<Key, Compare, Alloc>& lhs, const ft::btree_set<Key, Compare, Alloc>& rhs) {
+		return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	template <class Key, class Compare, class Alloc>
+	bool operator>(const ft::btree_set<Key, Compare, Alloc>& lhs, const ft::btree_set<Key, Compare, Alloc>& rhs) {
+		return rhs < lhs;
+	}
+
+	template <class Key, class Compare, class Alloc>
+	bool operator<=(const ft::btree_set<Key, Compare, Alloc>& lhs, const ft::btree_set<Key, Compare, Alloc>& rhs) {
+		return !(rhs < lhs);
+	}
+
+	template <class Key, class Compare, class Alloc>
+	bool operator>=(const ft::btree_set<Key, Compare, Alloc>& lhs, const ft::btree_set<Key, Compare, Alloc>& rhs) {
+		return !(lhs < rhs);
+	}
+}
+
+
+#endif
\ No newline at end of file
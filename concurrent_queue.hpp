@@ -0,0 +1,192 @@
+#ifndef CONCURRENT_QUEUE_HPP
+#define CONCURRENT_QUEUE_HPP
+
+#include "atomic.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace ft {
+
+	// Bounded multi-producer multi-consumer FIFO without locks (Dmitry Vyukov's
+	// ring). Every slot carries a sequence number saying whose turn it is:
+	// position p is free for the producer of p when it reads p, and full for
+	// the consumer of p when it reads p + 1. A producer claims a position by
+	// advancing the enqueue index with one CAS, writes, then publishes the
+	// slot; consumers mirror that on the dequeue index. The two indices live on
+	// cache lines of their own, so producers and consumers do not invalidate
+	// each other's line on every operation.
+	//
+	// The capacity is rounded up to a power of two. try_* never wait;
+	// push/pop spin with backoff until they succeed. The batch calls move as
+	// many items as are available, up to n, with a single CAS. Order is FIFO per
+	// producer; items from different producers interleave.
+	// T's copy constructor, assignment and destructor must not throw: a
+	// claimed slot cannot be given back.
+	template <typename T, typename Alloc = std::allocator<T> >
+	class concurrent_queue {
+		public:
+			typedef T			value_type;
+			typedef Alloc		allocator_type;
+			typedef size_t		size_type;
+
+		private:
+			struct slot {
+				ft::atomic<size_t>	sequence;
+				char				storage[sizeof(T)] __attribute__((aligned(__alignof__(T))));
+
+				T* value() { return reinterpret_cast<T*>(storage); }
+			};
+
+			typedef typename Alloc::template rebind<slot>::other	slot_alloc_type;
+
+			// read-only after construction: shared by every thread without contention
+			slot_alloc_type		_slot_alloc;
+			slot*				_slots;
+			size_t				_mask;
+			char				_pad0[cache_line_size];
+			ft::atomic<size_t>	_enqueue;
+			char				_pad1[cache_line_size - sizeof(size_t)];
+			ft::atomic<size_t>	_dequeue;
+			char				_pad2[cache_line_size - sizeof(size_t)];
+
+			concurrent_queue(const concurrent_queue&);
+			concurrent_queue& operator=(const concurrent_queue&);
+
+			static size_t round_up(size_t n) {
+				size_t c = 2;
+				while (c < n)
+					c *= 2;
+				return c;
+			}
+
+			static long distance(size_t a, size_t b) {
+				return static_cast<long>(a - b);
+			}
+
+			// claims up to n positions from index, each slot ready when its sequence
+			// equals position + offset; returns the first position, count in n
+			size_t claim(ft::atomic<size_t>& index, size_t offset, size_t& n) {
+				size_t pos = index.load(memory_order_relaxed);
+				if (n == 0)
+					return pos;
+				while (true) {
+					long d = distance(sequence(pos), pos + offset);
+					if (d < 0) {
+						// full (producers) or empty (consumers)
+						n = 0;
+						return pos;
+					}
+					if (d > 0) {
+						// another thread took pos meanwhile
+						pos = index.load(memory_order_relaxed);
+						continue;
+					}
+					size_t ready = 1;
+					while (ready < n && sequence(pos + ready) == pos + ready + offset)
+						ready++;
+					// on failure pos is reloaded and the slots are checked again
+					if (index.compare_exchange_weak(pos, pos + ready, memory_order_relaxed, memory_order_relaxed)) {
+						n = ready;
+						return pos;
+					}
+				}
+			}
+
+			size_t sequence(size_t pos) const {
+				return _slots[pos & _mask].sequence.load(memory_order_acquire);
+			}
+
+			void publish_push(size_t pos, const T& val) {
+				slot& s = _slots[pos & _mask];
+				::new (static_cast<void*>(s.storage)) T(val);
+				s.sequence.store(pos + 1, memory_order_release);
+			}
+
+			void publish_pop(size_t pos, T& out) {
+				slot& s = _slots[pos & _mask];
+				out = *s.value();
+				s.value()->~T();
+				s.sequence.store(pos + _mask + 1, memory_order_release);
+			}
+
+		public:
+			explicit concurrent_queue(size_type capacity, const allocator_type& alloc = allocator_type())
+				: _slot_alloc(alloc), _slots(NULL), _mask(round_up(capacity) - 1), _enqueue(0), _dequeue(0) {
+				_slots = _slot_alloc.allocate(_mask + 1);
+				for (size_t i = 0; i <= _mask; i++) {
+					::new (static_cast<void*>(&_slots[i])) slot();
+					_slots[i].sequence.store(i, memory_order_relaxed);
+				}
+			}
+
+			// only once no other thread uses the queue
+			~concurrent_queue() {
+				size_t head = _dequeue.load(memory_order_relaxed);
+				size_t tail = _enqueue.load(memory_order_relaxed);
+				for (size_t pos = head; pos != tail; pos++)
+					_slots[pos & _mask].value()->~T();
+				for (size_t i = 0; i <= _mask; i++)
+					_slots[i].~slot();
+				_slot_alloc.deallocate(_slots, _mask + 1);
+			}
+
+			bool try_push(const T& val) {
+				size_t n = 1;
+				size_t pos = claim(_enqueue, 0, n);
+				if (n == 0)
+					return false;
+				publish_push(pos, val);
+				return true;
+			}
+
+			bool try_pop(T& out) {
+				size_t n = 1;
+				size_t pos = claim(_dequeue, 1, n);
+				if (n == 0)
+					return false;
+				publish_pop(pos, out);
+				return true;
+			}
+
+			void push(const T& val) {
+				ft::backoff wait;
+				while (!try_push(val))
+					wait.pause();
+			}
+
+			void pop(T& out) {
+				ft::backoff wait;
+				while (!try_pop(out))
+					wait.pause();
+			}
+
+			// pushes items[0 .. k) for the largest k <= n that fits right now; returns k
+			size_type try_push_n(const T* items, size_type n) {
+				size_t pos = claim(_enqueue, 0, n);
+				for (size_t i = 0; i < n; i++)
+					publish_push(pos + i, items[i]);
+				return n;
+			}
+
+			// pops up to n items into out, in queue order; returns how many
+			size_type try_pop_n(T* out, size_type n) {
+				size_t pos = claim(_dequeue, 1, n);
+				for (size_t i = 0; i < n; i++)
+					publish_pop(pos + i, out[i]);
+				return n;
+			}
+
+			// a snapshot that may be stale by the time it returns
+			size_type size_approx() const {
+				size_t tail = _enqueue.load(memory_order_relaxed);
+				size_t head = _dequeue.load(memory_order_relaxed);
+				return tail > head ? tail - head : 0;
+			}
+
+			size_type capacity() const { return _mask + 1; }
+	};
+}
+
+#endif
@@ -0,0 +1,60 @@
+// Runs a test binary N times and prints "<median wall ms> <peak rss KB> <exit status>".
+// Used by `./do.sh --bench`; output of the binary itself is discarded.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static double now_ms() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::fprintf(stderr, "Usage: %s <runs> <binary> [args...]\n", argv[0]);
+		return 2;
+	}
+	int runs = std::atoi(argv[1]);
+	if (runs < 1)
+		runs = 1;
+
+	std::vector<double> times;
+	long peak_rss = 0;
+	int status = 0;
+	for (int i = 0; i < runs; i++) {
+		double start = now_ms();
+		pid_t pid = fork();
+		if (pid < 0)
+			return 2;
+		if (pid == 0) {
+			int null_fd = open("/dev/null", O_WRONLY);
+			if (null_fd >= 0) {
+				dup2(null_fd, 1);
+				dup2(null_fd, 2);
+			}
+			execv(argv[2], argv + 2);
+			_exit(127);
+		}
+		int wstatus = 0;
+		struct rusage usage;
+		if (wait4(pid, &wstatus, 0, &usage) < 0)
+			return 2;
+		times.push_back(now_ms() - start);
+		// ru_maxrss is in kilobytes on linux
+		peak_rss = std::max(peak_rss, static_cast<long>(usage.ru_maxrss));
+		status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+	}
+	std::sort(times.begin(), times.end());
+	double median = times.size() % 2 ? times[times.size() / 2]
+		: (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+	std::printf("%.3f %ld %d\n", median, peak_rss, status);
+	return 0;
+}
@@ -20,6 +20,16 @@ CFLAGS+=" -fsanitize=address -g3"
 ft_compile_output="/dev/null"
 std_compile_output="/dev/null"
 
+# timed mode (./do.sh --bench): optimized builds, no sanitizer
+BENCH_CFLAGS="-Wall -Wextra -Werror -std=c++98 -O2"
+bench_runs=${BENCH_RUNS:-5}
+bench_factor=${BENCH_FACTOR:-20}
+# runs faster than this are clamped to it, so process startup noise on
+# tiny tests cannot trip the factor
+bench_floor_ms=${BENCH_FLOOR_MS:-1}
+bench_runner="./bench_run.out"
+bench_slow=0
+
 function pheader () {
 printf "${EOC}${BOLD}${DBLUE}\
 # ****************************************************************************** #
@@ -153,6 +163,52 @@ cmp_one () {
 	clean_trailing_files
 }
 
+printBench () {
+	# 1=file 2=ft_ms 3=ft_rss 4=std_ms 5=std_rss 6=ratio 7=slow
+	printf "%-35s: FT: %9.2fms %8sKB | STD: %9.2fms %8sKB | x%7.2f %s\n" \
+		"$1" "$2" "$3" "$4" "$5" "$6" "$(getEmoji $7)"
+}
+
+bench_one () {
+	# 1=path/to/file
+	container=$(echo $1 | cut -d "/" -f 2)
+	file=$(echo $1 | cut -d "/" -f 3)
+	ft_bin="ft.$container.bench.out"
+	std_bin="std.$container.bench.out"
+
+	CFLAGS="$BENCH_CFLAGS" compile "$1" "ft"  "$ft_bin"  $ft_compile_output & ft_pid=$!;
+	CFLAGS="$BENCH_CFLAGS" compile "$1" "std" "$std_bin" $std_compile_output & std_pid=$!;
+	wait ${ft_pid}; ft_ret=$?;
+	wait ${std_pid}; std_ret=$?;
+
+	# tests meant not to compile have nothing to time
+	if [ ${ft_ret} -ne 0 ] || [ ${std_ret} -ne 0 ]; then
+		printf "%-35s: %s\n" "$container/$file" "skipped (does not compile)"
+		rm -f $ft_bin $std_bin
+		return
+	fi
+
+	# sequential, so the two builds never compete for the cpu
+	read ft_ms ft_rss ft_status <<< "$($bench_runner $bench_runs ./$ft_bin)"
+	read std_ms std_rss std_status <<< "$($bench_runner $bench_runs ./$std_bin)"
+	rm -f $ft_bin $std_bin
+
+	ratio=$(awk -v f="$ft_ms" -v s="$std_ms" -v m="$bench_floor_ms" \
+		'BEGIN { if (f < m) f = m; if (s < m) s = m; printf "%.2f", f / s }')
+	slow=$(awk -v r="$ratio" -v k="$bench_factor" 'BEGIN { print (r > k) ? 1 : 0 }')
+	[ "$slow" -eq 1 ] && bench_slow=$((bench_slow + 1))
+	printBench "$container/$file" $ft_ms $ft_rss $std_ms $std_rss $ratio $slow
+}
+
+do_bench () {
+	# 1=container_name
+	test_files=$(find "${srcs}/${1}" -type f -name '*.cpp' | sort)
+
+	for file in ${test_files[@]}; do
+		bench_one "${file}"
+	done
+}
+
 do_test () {
 	# 1=container_name
 	test_files=$(find "${srcs}/${1}" -type f -name '*.cpp' | sort)
@@ -164,14 +220,38 @@ do_test () {
 
 function main () {
 	pheader
-	containers=(vector map stack set)
+	containers=(vector map stack set unordered_map)
 	# containers=(vector list map stack queue deque multimap set multiset)
-	if [ $# -ne 0 ]; then
-		containers=($@);
+	bench=0
+	args=()
+	while [ $# -ne 0 ]; do
+		case $1 in
+			--bench) bench=1;;
+			--runs) bench_runs=$2; shift;;
+			--factor) bench_factor=$2; shift;;
+			*) args+=($1);;
+		esac
+		shift
+	done
+	if [ ${#args[@]} -ne 0 ]; then
+		containers=(${args[@]});
 	fi
 
+	if [ $bench -eq 1 ]; then
+		$CC -O2 -o $bench_runner bench_run.cpp || return 1
+		printf "%s runs per binary, flagging ft slower than x%s\n" $bench_runs $bench_factor
+	fi
 	for container in ${containers[@]}; do
 		printf "%40s\n" $container
-		do_test $container 2>/dev/null
+		if [ $bench -eq 1 ]; then
+			do_bench $container 2>/dev/null
+		else
+			do_test $container 2>/dev/null
+		fi
 	done
+	if [ $bench -eq 1 ]; then
+		rm -f $bench_runner
+		printf "%d test(s) over x%s\n" $bench_slow $bench_factor
+		[ $bench_slow -eq 0 ]
+	fi
 }
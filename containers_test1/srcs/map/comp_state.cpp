@@ -0,0 +1,54 @@
+#include "common.hpp"
+
+#define T1 int
+#define T2 int
+
+// a comparator with state: assignment and swap carry it along with the
+// elements, so lookups afterwards have to order keys the same way
+struct state_comp {
+	bool	rev;
+
+	state_comp(bool r = false) : rev(r) {}
+	bool operator()(const T1& a, const T1& b) const { return rev ? b < a : a < b; }
+};
+
+typedef TESTED_NAMESPACE::map<T1, T2, state_comp> T_MAP;
+
+static void	lookups(T_MAP &mp)
+{
+	mp[2] = 5;
+	mp[8] = 5;
+	mp[42] = 5;
+	std::cout << "find(3): " << (mp.find(3) != mp.end()) << std::endl;
+	std::cout << "find(100): " << (mp.find(100) != mp.end()) << std::endl;
+	std::cout << "erase(4): " << mp.erase(4) << std::endl;
+	std::cout << "erase(42): " << mp.erase(42) << std::endl;
+	std::cout << "lower_bound(5): " << mp.lower_bound(5)->first << std::endl;
+	std::cout << "upper_bound(5): " << mp.upper_bound(5)->first << std::endl;
+	std::cout << "key_comp()(1, 2): " << mp.key_comp()(1, 2) << std::endl;
+	printSize(mp);
+}
+
+int		main(void)
+{
+	T_MAP a((state_comp(false))), b((state_comp(true)));
+
+	for (int i = 0; i < 10; ++i)
+	{
+		a[i] = i;
+		b[i] = 10 * i;
+	}
+	a = b;
+	lookups(a);
+
+	T_MAP c((state_comp(false))), d((state_comp(true)));
+	for (int i = 0; i < 10; ++i)
+	{
+		c[i] = i;
+		d[i] = 10 * i;
+	}
+	c.swap(d);
+	lookups(c);
+	lookups(d);
+	return (0);
+}
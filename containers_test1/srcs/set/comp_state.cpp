@@ -0,0 +1,48 @@
+#include "common.hpp"
+
+#define T1 int
+
+// a comparator with state: the set has to order by the one it was built
+// with, and assignment and swap carry it along with the elements
+struct state_comp {
+	bool	rev;
+
+	state_comp(bool r = false) : rev(r) {}
+	bool operator()(const T1& a, const T1& b) const { return rev ? b < a : a < b; }
+};
+
+typedef TESTED_NAMESPACE::set<T1, state_comp> T_SET;
+
+static void	lookups(T_SET &st)
+{
+	st.insert(2);
+	st.insert(42);
+	std::cout << "find(3): " << (st.find(3) != st.end()) << std::endl;
+	std::cout << "erase(4): " << st.erase(4) << std::endl;
+	std::cout << "lower_bound(5): " << *st.lower_bound(5) << std::endl;
+	std::cout << "upper_bound(5): " << *st.upper_bound(5) << std::endl;
+	std::cout << "equal_range(6): " << *st.equal_range(6).first << " " << *st.equal_range(6).second << std::endl;
+	printSize(st);
+}
+
+int		main(void)
+{
+	T_SET a((state_comp(true)));
+	for (int i = 0; i < 10; ++i)
+		a.insert(i);
+	lookups(a);
+
+	T_SET b((state_comp(false)));
+	for (int i = 0; i < 10; ++i)
+		b.insert(i * 2);
+	b = a;
+	lookups(b);
+
+	T_SET c((state_comp(false)));
+	for (int i = 0; i < 10; ++i)
+		c.insert(i + 1);
+	c.swap(a);
+	lookups(c);
+	lookups(a);
+	return (0);
+}
@@ -0,0 +1,28 @@
+#include "../base.hpp"
+#include <map>
+#if !defined(USING_STD)
+# include "unordered_map.hpp"
+# define _unordered_map ft::unordered_map
+#else
+# include <tr1/unordered_map>
+# define _unordered_map std::tr1::unordered_map
+#endif /* !defined(STD) */
+
+// iteration order differs between implementations, so the content is
+// printed sorted by key
+template <typename T_MAP>
+void	printSize(T_MAP const &mp, bool print_content = 1)
+{
+	std::cout << "size: " << mp.size() << std::endl;
+	if (print_content)
+	{
+		std::map<typename T_MAP::key_type, typename T_MAP::mapped_type> sorted;
+		for (typename T_MAP::const_iterator it = mp.begin(); it != mp.end(); ++it)
+			sorted[it->first] = it->second;
+		std::cout << std::endl << "Content is:" << std::endl;
+		for (typename std::map<typename T_MAP::key_type, typename T_MAP::mapped_type>::iterator it = sorted.begin();
+			it != sorted.end(); ++it)
+			std::cout << "- key: " << it->first << " | value: " << it->second << std::endl;
+	}
+	std::cout << "###############################################" << std::endl;
+}
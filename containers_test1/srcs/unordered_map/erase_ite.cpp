@@ -0,0 +1,50 @@
+#include "common.hpp"
+
+#define T1 int
+#define T2 int
+
+// it = mp.erase(it) while iterating has to visit every element once, also
+// when erasing pulls an element of a run that wraps around the end of the
+// table back into the erased slot; many table sizes make sure some do
+static unsigned int seed = 42;
+
+static T1	next_key(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) % 4096;
+}
+
+int		main(void)
+{
+	int twice = 0;
+
+	for (int round = 0; round < 200; ++round)
+	{
+		_unordered_map<T1, T2> mp;
+		int n = 16 + round * 7;
+		for (int i = 0; i < n; ++i)
+			mp[next_key()] = round;
+
+		std::map<T1, int> seen;
+		size_t before = mp.size();
+		size_t erased = 0;
+		for (_unordered_map<T1, T2>::iterator it = mp.begin(); it != mp.end(); )
+		{
+			if (++seen[it->first] > 1)
+				++twice;
+			if (it->first % 2 == 0)
+			{
+				it = mp.erase(it);
+				++erased;
+			}
+			else
+				++it;
+		}
+		if (seen.size() != before || mp.size() != before - erased)
+			std::cout << "round " << round << ": visited " << seen.size() << " of " << before << std::endl;
+		if (round % 50 == 0)
+			printSize(mp, round == 0);
+	}
+	std::cout << "visited twice: " << twice << std::endl;
+	return (0);
+}
@@ -0,0 +1,193 @@
+#ifndef COUNTING_ALLOCATOR_HPP
+#define COUNTING_ALLOCATOR_HPP
+
+#include "memory_usage.hpp"
+#include "allocator_traits.hpp"
+
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <new>
+#include <ostream>
+
+namespace ft {
+
+	// allocation_stats ===========================================================
+	// What a counting_allocator saw: calls, bytes, live/peak bytes, live blocks
+	// with their estimated malloc overhead, and a histogram of request sizes by
+	// power of two. Not thread safe.
+
+	struct allocation_stats {
+		static const size_t	buckets = 24;
+
+		size_t			allocations;
+		size_t			deallocations;
+		size_t			bytes_allocated;
+		size_t			bytes_deallocated;
+		size_t			live_bytes;
+		size_t			peak_live_bytes;
+		size_t			live_blocks;
+		size_t			live_malloc_overhead;
+		size_t			histogram[buckets];
+		std::ostream*	trace;
+
+		allocation_stats() : trace(NULL) { reset(); }
+
+		// counters only; the trace stream stays attached
+		void reset() {
+			allocations = 0;
+			deallocations = 0;
+			bytes_allocated = 0;
+			bytes_deallocated = 0;
+			live_bytes = 0;
+			peak_live_bytes = 0;
+			live_blocks = 0;
+			live_malloc_overhead = 0;
+			for (size_t i = 0; i < buckets; i++)
+				histogram[i] = 0;
+		}
+
+		// bucket i counts requests of up to 8 << i bytes that did not fit the
+		// previous bucket; the last one also takes everything larger
+		static size_t bucket_of(size_t bytes) {
+			size_t i = 0;
+			for (size_t limit = 8; bytes > limit && i + 1 < buckets; limit <<= 1)
+				i++;
+			return i;
+		}
+
+		static size_t bucket_limit(size_t i) {
+			return static_cast<size_t>(8) << i;
+		}
+
+		void on_allocate(const void* p, size_t bytes) {
+			allocations++;
+			bytes_allocated += bytes;
+			live_bytes += bytes;
+			if (live_bytes > peak_live_bytes)
+				peak_live_bytes = live_bytes;
+			live_blocks++;
+			live_malloc_overhead += estimated_malloc_overhead(bytes);
+			histogram[bucket_of(bytes)]++;
+			if (trace)
+				*trace << "alloc " << bytes << ' ' << p << '\n';
+		}
+
+		void on_deallocate(const void* p, size_t bytes) {
+			deallocations++;
+			bytes_deallocated += bytes;
+			live_bytes -= bytes;
+			live_blocks--;
+			live_malloc_overhead -= estimated_malloc_overhead(bytes);
+			if (trace)
+				*trace << "free " << bytes << ' ' << p << '\n';
+		}
+
+		void report(std::ostream& os) const {
+			os << "allocations:       " << allocations << '\n'
+				<< "deallocations:     " << deallocations << '\n'
+				<< "bytes allocated:   " << bytes_allocated << '\n'
+				<< "bytes deallocated: " << bytes_deallocated << '\n'
+				<< "live bytes:        " << live_bytes << '\n'
+				<< "peak live bytes:   " << peak_live_bytes << '\n'
+				<< "live blocks:       " << live_blocks << " (+" << live_malloc_overhead << " B malloc overhead, estimated)\n"
+				<< "request sizes:" << '\n';
+			for (size_t i = 0; i < buckets; i++) {
+				if (histogram[i] == 0)
+					continue;
+				os << "  <= " << std::setw(9) << bucket_limit(i);
+				if (i + 1 == buckets)
+					os << '+';
+				os << " B: " << histogram[i] << '\n';
+			}
+		}
+
+		// the stats every default constructed counting_allocator reports to
+		static allocation_stats& global() {
+			static allocation_stats s;
+			return s;
+		}
+	};
+
+	inline std::ostream& operator<<(std::ostream& os, const allocation_stats& s) {
+		s.report(os);
+		return os;
+	}
+
+	// counting_allocator =========================================================
+	// A std::allocator replacement that reports every call to an
+	// allocation_stats (the global one unless given another). Rebound copies
+	// share the stats, so a map's node allocator counts into the same place.
+
+	template <typename T>
+	class counting_allocator {
+		public:
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef const T*	const_pointer;
+			typedef T&			reference;
+			typedef const T&	const_reference;
+			typedef size_t		size_type;
+			typedef ptrdiff_t	difference_type;
+
+			template <typename U>
+			struct rebind { typedef counting_allocator<U> other; };
+
+			// swapped containers take their memory's accounting with them
+			typedef ft::true_type	propagate_on_container_swap;
+
+		private:
+			allocation_stats*	_stats;
+
+			template <typename U>
+			friend class counting_allocator;
+
+		public:
+			counting_allocator() throw() : _stats(&allocation_stats::global()) {}
+			explicit counting_allocator(allocation_stats& stats) throw() : _stats(&stats) {}
+			counting_allocator(const counting_allocator& other) throw() : _stats(other._stats) {}
+			template <typename U>
+			counting_allocator(const counting_allocator<U>& other) throw() : _stats(other._stats) {}
+			~counting_allocator() throw() {}
+
+			counting_allocator& operator=(const counting_allocator& other) throw() {
+				_stats = other._stats;
+				return *this;
+			}
+
+			allocation_stats&	stats() const { return *_stats; }
+
+			pointer			address(reference x) const { return &x; }
+			const_pointer	address(const_reference x) const { return &x; }
+
+			pointer allocate(size_type n, const void* hint = 0) {
+				(void)hint;
+				if (n > max_size())
+					throw std::bad_alloc();
+				pointer p = static_cast<pointer>(::operator new(n * sizeof(T)));
+				_stats->on_allocate(p, n * sizeof(T));
+				return p;
+			}
+
+			void deallocate(pointer p, size_type n) {
+				if (p == NULL)
+					return;
+				_stats->on_deallocate(p, n * sizeof(T));
+				::operator delete(p);
+			}
+
+			size_type max_size() const throw() {
+				return std::numeric_limits<size_type>::max() / sizeof(T);
+			}
+
+			void construct(pointer p, const_reference val) { ::new (static_cast<void*>(p)) T(val); }
+			void destroy(pointer p) { p->~T(); }
+
+			template <typename U>
+			bool operator==(const counting_allocator<U>& other) const { return _stats == other._stats; }
+			template <typename U>
+			bool operator!=(const counting_allocator<U>& other) const { return _stats != other._stats; }
+	};
+}
+
+#endif
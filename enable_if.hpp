@@ -99,6 +99,10 @@ namespace ft {
 	}
 	// Pair =======================================================================
 
+	// tag for the pair constructor that builds each member straight from its own
+	// argument (the mapped value of a new map node, without a temporary)
+	struct piecewise_construct_t {};
+
 	template <class T1, class T2>
 	struct pair {
 		typedef T1 first_type;
@@ -114,6 +118,13 @@ namespace ft {
 
 		pair(const first_type& a, const second_type& b) : first(a), second(b) {}
 
+		template<class U, class V>
+		pair(piecewise_construct_t, const U& a, const V& b) : first(a), second(b) {}
+
+		// second is value-initialized in place
+		template<class U>
+		pair(piecewise_construct_t, const U& a) : first(a), second() {}
+
 		pair& operator=(const pair& other) {
 			if (this != &other) {
 				this->first = other.first;
@@ -163,6 +174,27 @@ namespace ft {
 		}
 	};
 
+	template <class T>
+	struct equal_to : public binary_function<T,T,bool> {
+		bool operator()(const T& x, const T& y) const {
+			return x == y;
+		}
+	};
+
+// key extraction ==============================================================
+
+	template <class Pair>
+	struct select_first {
+		typedef typename Pair::first_type result_type;
+		const result_type& operator()(const Pair& p) const { return p.first; }
+	};
+
+	template <class T>
+	struct identity {
+		typedef T result_type;
+		const T& operator()(const T& v) const { return v; }
+	};
+
 // equal
 	template <class InputIterator1, class InputIterator2>
 	bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
@@ -0,0 +1,61 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace ft {
+
+	// hash =======================================================================
+	// c++98 has no std::hash. Integral hashes are the identity; hash_table
+	// mixes the bits again before splitting them into position and tag.
+
+	template <typename T>
+	struct hash {};
+
+	template <typename T>
+	struct hash<T*> {
+		size_t operator()(T* p) const { return reinterpret_cast<size_t>(p); }
+	};
+
+#define FT_INTEGRAL_HASH(type) \
+	template <> \
+	struct hash<type> { \
+		size_t operator()(type v) const { return static_cast<size_t>(v); } \
+	};
+
+	FT_INTEGRAL_HASH(bool)
+	FT_INTEGRAL_HASH(char)
+	FT_INTEGRAL_HASH(signed char)
+	FT_INTEGRAL_HASH(unsigned char)
+	FT_INTEGRAL_HASH(wchar_t)
+	FT_INTEGRAL_HASH(short)
+	FT_INTEGRAL_HASH(unsigned short)
+	FT_INTEGRAL_HASH(int)
+	FT_INTEGRAL_HASH(unsigned int)
+	FT_INTEGRAL_HASH(long)
+	FT_INTEGRAL_HASH(unsigned long)
+	FT_INTEGRAL_HASH(long long)
+	FT_INTEGRAL_HASH(unsigned long long)
+
+#undef FT_INTEGRAL_HASH
+
+	// FNV-1a
+	inline size_t hash_bytes(const void* data, size_t len) {
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		size_t h = static_cast<size_t>(14695981039346656037ULL);
+		for (size_t i = 0; i < len; i++) {
+			h ^= p[i];
+			h *= static_cast<size_t>(1099511628211ULL);
+		}
+		return h;
+	}
+
+	template <>
+	struct hash<std::string> {
+		size_t operator()(const std::string& s) const { return hash_bytes(s.data(), s.size()); }
+	};
+
+}
+
+#endif
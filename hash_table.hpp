@@ -0,0 +1,615 @@
+#ifndef HASH_TABLE_HPP
+#define HASH_TABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include "iterator.hpp"
+#include "enable_if.hpp"
+#include "hash.hpp"
+#include "memory_usage.hpp"
+
+#if defined(__SSE2__) && !defined(FT_HASH_TABLE_NO_SIMD)
+# include <emmintrin.h>
+# define FT_HASH_TABLE_SSE2 1
+#endif
+
+// Open addressing table with one control byte per slot.
+//
+// A control byte is either EMPTY (0x80) or the low 7 bits of the element's
+// hash (so the sign bit tells full from empty). Probing is linear from the
+// home slot, but it reads 16 control bytes at a time and only compares keys
+// whose tag matches. The first 15 control bytes are mirrored after the last
+// slot so that an unaligned 16-byte load never has to wrap.
+//
+// Because the probe sequence is linear, erase can shift the following run of
+// elements back into the hole (backward shift deletion) instead of leaving a
+// tombstone, so lookups never slow down after heavy insert/erase churn.
+//
+// Iterators walk the slots from an empty one, the origin, rather than from
+// slot 0: a run can wrap around the end of the table, and a shift would then
+// pull an element already visited from the low slots into one still ahead.
+
+namespace ft {
+
+	namespace hash_detail {
+		typedef signed char	ctrl_t;
+
+		static const ctrl_t	EMPTY = -128;
+		static const size_t	GROUP_WIDTH = 16;
+
+#ifdef FT_HASH_TABLE_SSE2
+		struct group {
+			__m128i ctrl;
+
+			explicit group(const ctrl_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+			unsigned match(ctrl_t tag) const {
+				return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl));
+			}
+			unsigned match_empty() const {
+				return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(EMPTY), ctrl));
+			}
+		};
+#else
+		struct group {
+			const ctrl_t* ctrl;
+
+			explicit group(const ctrl_t* p) : ctrl(p) {}
+
+			unsigned match(ctrl_t tag) const {
+				unsigned mask = 0;
+				for (size_t i = 0; i < GROUP_WIDTH; i++) {
+					if (ctrl[i] == tag)
+						mask |= 1u << i;
+				}
+				return mask;
+			}
+			unsigned match_empty() const {
+				return match(EMPTY);
+			}
+		};
+#endif
+
+		inline unsigned lowest_bit(unsigned mask) {
+			return __builtin_ctz(mask);
+		}
+
+		// murmur3 finalizer, so identity hashes of sequential ints spread out
+		inline size_t mix(size_t h) {
+			h ^= h >> 33;
+			h *= static_cast<size_t>(0xff51afd7ed558ccdULL);
+			h ^= h >> 33;
+			return h;
+		}
+
+		inline size_t round_up_capacity(size_t n) {
+			size_t cap = GROUP_WIDTH;
+			while (cap < n)
+				cap <<= 1;
+			return cap;
+		}
+	}
+
+	// Iteration starts at an empty slot of the table (its origin), wraps around
+	// the end of the slots and stops when it is back at the origin. No run of
+	// elements spans an empty slot, so every run is visited in probe order.
+	template <typename T>
+	class hash_table_iterator : public ft::iterator<ft::forward_iterator_tag, T> {
+		public:
+			typedef	forward_iterator_tag			iterator_category;
+			typedef	T								value_type;
+			typedef	T*								pointer;
+			typedef	T&								reference;
+			typedef	std::ptrdiff_t					difference_type;
+
+		private:
+			typedef hash_detail::ctrl_t	ctrl_t;
+
+			const ctrl_t*	_ctrl;
+			const ctrl_t*	_ctrl_begin;
+			const ctrl_t*	_ctrl_end;
+			const ctrl_t*	_origin;
+			pointer			_slot;
+
+			// one slot forward; past the last slot of the round is end()
+			void step() {
+				++_ctrl;
+				++_slot;
+				if (_ctrl == _ctrl_end) {
+					_slot -= _ctrl_end - _ctrl_begin;
+					_ctrl = _ctrl_begin;
+				}
+				if (_ctrl == _origin) {
+					_slot += _ctrl_end - _ctrl;
+					_ctrl = _ctrl_end;
+				}
+			}
+
+			void skip_empty() {
+				while (_ctrl != _ctrl_end && *_ctrl == hash_detail::EMPTY)
+					step();
+			}
+
+		public:
+			hash_table_iterator() : _ctrl(NULL), _ctrl_begin(NULL), _ctrl_end(NULL), _origin(NULL), _slot(NULL) {}
+			hash_table_iterator(const ctrl_t* ctrl, const ctrl_t* ctrl_begin, const ctrl_t* ctrl_end, const ctrl_t* origin, pointer slot)
+				: _ctrl(ctrl), _ctrl_begin(ctrl_begin), _ctrl_end(ctrl_end), _origin(origin), _slot(slot) { skip_empty(); }
+			hash_table_iterator(const hash_table_iterator& other)
+				: _ctrl(other._ctrl), _ctrl_begin(other._ctrl_begin), _ctrl_end(other._ctrl_end), _origin(other._origin),
+				_slot(other._slot) {}
+			template <typename U>
+			hash_table_iterator(const hash_table_iterator<U>& other)
+				: _ctrl(other.ctrl()), _ctrl_begin(other.ctrl_begin()), _ctrl_end(other.ctrl_end()), _origin(other.origin()),
+				_slot(other.slot()) {}
+			~hash_table_iterator() {}
+
+			hash_table_iterator& operator=(const hash_table_iterator& other) {
+				_ctrl = other._ctrl;
+				_ctrl_begin = other._ctrl_begin;
+				_ctrl_end = other._ctrl_end;
+				_origin = other._origin;
+				_slot = other._slot;
+				return *this;
+			}
+
+			const ctrl_t*	ctrl() const { return _ctrl; }
+			const ctrl_t*	ctrl_begin() const { return _ctrl_begin; }
+			const ctrl_t*	ctrl_end() const { return _ctrl_end; }
+			const ctrl_t*	origin() const { return _origin; }
+			pointer			slot() const { return _slot; }
+
+			reference operator*() const { return *_slot; }
+			pointer operator->() const { return _slot; }
+
+			hash_table_iterator& operator++() {
+				step();
+				skip_empty();
+				return *this;
+			}
+			hash_table_iterator operator++(int) {
+				hash_table_iterator tmp(*this);
+				++(*this);
+				return tmp;
+			}
+	};
+
+	template <typename T1, typename T2>
+	bool operator==(const hash_table_iterator<T1>& lhs, const hash_table_iterator<T2>& rhs) { return lhs.ctrl() == rhs.ctrl(); }
+	template <typename T1, typename T2>
+	bool operator!=(const hash_table_iterator<T1>& lhs, const hash_table_iterator<T2>& rhs) { return lhs.ctrl() != rhs.ctrl(); }
+
+	template <typename Value, typename Key, typename KeyOfValue, typename Hash, typename KeyEqual, typename Alloc>
+	class hash_table {
+
+	// typedefs =========================================================================================
+
+		private:
+			typedef hash_detail::ctrl_t									ctrl_t;
+			typedef typename Alloc::template rebind<ctrl_t>::other		ctrl_alloc_type;
+
+		public:
+			typedef Key													key_type;
+			typedef Value												value_type;
+			typedef Hash												hasher;
+			typedef KeyEqual											key_equal;
+			typedef Alloc												allocator_type;
+			typedef size_t												size_type;
+			typedef ptrdiff_t											difference_type;
+			typedef typename allocator_type::pointer					pointer;
+			typedef typename allocator_type::const_pointer				const_pointer;
+			typedef typename allocator_type::reference					reference;
+			typedef typename allocator_type::const_reference			const_reference;
+			typedef ft::hash_table_iterator<value_type>					iterator;
+			typedef ft::hash_table_iterator<const value_type>			const_iterator;
+
+	// ==================================================================================================
+
+	// private members ==================================================================================
+
+		private:
+			hasher			_hash;
+			key_equal		_eq;
+			KeyOfValue		_key_of;
+			allocator_type	_alloc;
+			ctrl_alloc_type	_ctrl_alloc;
+			ctrl_t*			_ctrl;
+			pointer			_slots;
+			size_type		_capacity;
+			size_type		_size;
+			size_type		_growth_limit;
+			size_type		_origin;		// always an empty slot, where iteration starts
+			float			_max_load_factor;
+
+		public:
+			hash_table(const hasher& hf, const key_equal& eq, const allocator_type& alloc)
+				: _hash(hf), _eq(eq), _key_of(), _alloc(alloc), _ctrl_alloc(alloc), _ctrl(NULL), _slots(NULL),
+				_capacity(0), _size(0), _growth_limit(0), _origin(0), _max_load_factor(0.875f) {}
+
+			hash_table(const hash_table& x)
+				: _hash(x._hash), _eq(x._eq), _key_of(), _alloc(x._alloc), _ctrl_alloc(x._ctrl_alloc), _ctrl(NULL), _slots(NULL),
+				_capacity(0), _size(0), _growth_limit(0), _origin(0), _max_load_factor(x._max_load_factor) {
+				copy_from(x);
+			}
+
+			hash_table& operator=(const hash_table& x) {
+				if (this == &x)
+					return *this;
+				destroy_storage();
+				_hash = x._hash;
+				_eq = x._eq;
+				_max_load_factor = x._max_load_factor;
+				copy_from(x);
+				return *this;
+			}
+
+			~hash_table() {
+				destroy_storage();
+			}
+
+	// ==================================================================================================
+
+	// iterators ========================================================================================
+
+		public:
+			iterator		begin() { return make_iterator(_origin); }
+			const_iterator	begin() const { return make_iterator(_origin); }
+			iterator		end() { return make_iterator(_capacity); }
+			const_iterator	end() const { return make_iterator(_capacity); }
+
+	// ==================================================================================================
+
+	// private member func ==============================================================================
+
+		private:
+			iterator		make_iterator(size_type i) {
+				return iterator(_ctrl + i, _ctrl, _ctrl + _capacity, _ctrl + _origin, _slots + i);
+			}
+			const_iterator	make_iterator(size_type i) const {
+				return const_iterator(_ctrl + i, _ctrl, _ctrl + _capacity, _ctrl + _origin, _slots + i);
+			}
+
+			size_type	mask() const { return _capacity - 1; }
+			size_type	hash_of(const key_type& k) const { return hash_detail::mix(_hash(k)); }
+			static size_type	home_of(size_type h, size_type mask) { return (h >> 7) & mask; }
+			static ctrl_t		tag_of(size_type h) { return static_cast<ctrl_t>(h & 0x7F); }
+
+			void set_ctrl(size_type i, ctrl_t c) {
+				_ctrl[i] = c;
+				if (i < hash_detail::GROUP_WIDTH - 1)
+					_ctrl[_capacity + i] = c;
+			}
+
+			size_type growth_limit_for(size_type cap) const {
+				size_type limit = static_cast<size_type>(cap * _max_load_factor);
+				return limit < cap ? limit : cap - 1;
+			}
+
+			// returns _capacity when the key is absent
+			size_type find_index(const key_type& k, size_type h) const {
+				if (_capacity == 0)
+					return 0;
+				size_type pos = home_of(h, mask());
+				ctrl_t tag = tag_of(h);
+				while (true) {
+					hash_detail::group g(_ctrl + pos);
+					for (unsigned m = g.match(tag); m != 0; m &= m - 1) {
+						size_type i = (pos + hash_detail::lowest_bit(m)) & mask();
+						if (_eq(_key_of(_slots[i]), k))
+							return i;
+					}
+					if (g.match_empty() != 0)
+						return _capacity;
+					pos = (pos + hash_detail::GROUP_WIDTH) & mask();
+				}
+			}
+
+			static size_type find_empty(const ctrl_t* ctrl, size_type pos, size_type mask) {
+				while (true) {
+					unsigned m = hash_detail::group(ctrl + pos).match_empty();
+					if (m != 0)
+						return (pos + hash_detail::lowest_bit(m)) & mask;
+					pos = (pos + hash_detail::GROUP_WIDTH) & mask;
+				}
+			}
+
+			ctrl_t* allocate_ctrl(size_type cap) {
+				ctrl_t* ctrl = _ctrl_alloc.allocate(cap + hash_detail::GROUP_WIDTH - 1);
+				std::memset(ctrl, hash_detail::EMPTY, cap + hash_detail::GROUP_WIDTH - 1);
+				return ctrl;
+			}
+
+			void destroy_storage() {
+				if (_capacity == 0)
+					return;
+				for (size_type i = 0; i < _capacity; i++) {
+					if (_ctrl[i] != hash_detail::EMPTY)
+						_alloc.destroy(_slots + i);
+				}
+				_ctrl_alloc.deallocate(_ctrl, _capacity + hash_detail::GROUP_WIDTH - 1);
+				_alloc.deallocate(_slots, _capacity);
+				_ctrl = NULL;
+				_slots = NULL;
+				_capacity = 0;
+				_size = 0;
+				_growth_limit = 0;
+				_origin = 0;
+			}
+
+			// same capacity, so control bytes and slot positions carry over as is
+			void copy_from(const hash_table& x) {
+				if (x._capacity == 0)
+					return;
+				ctrl_t* ctrl = allocate_ctrl(x._capacity);
+				pointer slots = _alloc.allocate(x._capacity);
+				size_type i = 0;
+				try {
+					for (; i < x._capacity; i++) {
+						if (x._ctrl[i] != hash_detail::EMPTY)
+							_alloc.construct(slots + i, x._slots[i]);
+					}
+				} catch (...) {
+					while (i-- > 0) {
+						if (x._ctrl[i] != hash_detail::EMPTY)
+							_alloc.destroy(slots + i);
+					}
+					_ctrl_alloc.deallocate(ctrl, x._capacity + hash_detail::GROUP_WIDTH - 1);
+					_alloc.deallocate(slots, x._capacity);
+					throw;
+				}
+				std::memcpy(ctrl, x._ctrl, x._capacity + hash_detail::GROUP_WIDTH - 1);
+				_ctrl = ctrl;
+				_slots = slots;
+				_capacity = x._capacity;
+				_size = x._size;
+				_growth_limit = growth_limit_for(_capacity);
+				_origin = x._origin;
+			}
+
+			void resize(size_type new_capacity) {
+				ctrl_t* ctrl = allocate_ctrl(new_capacity);
+				pointer slots = _alloc.allocate(new_capacity);
+				size_type new_mask = new_capacity - 1;
+				size_type i = 0;
+				try {
+					for (; i < _capacity; i++) {
+						if (_ctrl[i] == hash_detail::EMPTY)
+							continue;
+						size_type h = hash_of(_key_of(_slots[i]));
+						size_type j = find_empty(ctrl, home_of(h, new_mask), new_mask);
+						_alloc.construct(slots + j, _slots[i]);
+						ctrl[j] = tag_of(h);
+						if (j < hash_detail::GROUP_WIDTH - 1)
+							ctrl[new_capacity + j] = tag_of(h);
+					}
+				} catch (...) {
+					for (size_type j = 0; j < new_capacity; j++) {
+						if (ctrl[j] != hash_detail::EMPTY)
+							_alloc.destroy(slots + j);
+					}
+					_ctrl_alloc.deallocate(ctrl, new_capacity + hash_detail::GROUP_WIDTH - 1);
+					_alloc.deallocate(slots, new_capacity);
+					throw;
+				}
+				size_type size = _size;
+				destroy_storage();
+				_ctrl = ctrl;
+				_slots = slots;
+				_capacity = new_capacity;
+				_size = size;
+				_growth_limit = growth_limit_for(new_capacity);
+				_origin = find_empty(ctrl, 0, new_mask);
+			}
+
+			// the key is known to be absent; h is its hash
+			size_type insert_new(const value_type& val, size_type h) {
+				if (_size >= _growth_limit) {
+					resize(_capacity == 0 ? hash_detail::GROUP_WIDTH : _capacity * 2);
+				}
+				size_type i = find_empty(_ctrl, home_of(h, mask()), mask());
+				_alloc.construct(_slots + i, val);
+				set_ctrl(i, tag_of(h));
+				++_size;
+				if (i == _origin)
+					_origin = find_empty(_ctrl, (i + 1) & mask(), mask());
+				return i;
+			}
+
+			// backward shift: pull each following element of the run into the hole
+			// unless that would move it in front of its home slot
+			void erase_index(size_type hole) {
+				_alloc.destroy(_slots + hole);
+				--_size;
+				size_type next = (hole + 1) & mask();
+				while (_ctrl[next] != hash_detail::EMPTY) {
+					size_type home = home_of(hash_of(_key_of(_slots[next])), mask());
+					if (((next - home) & mask()) >= ((next - hole) & mask())) {
+						_alloc.construct(_slots + hole, _slots[next]);
+						_alloc.destroy(_slots + next);
+						set_ctrl(hole, _ctrl[next]);
+						hole = next;
+					}
+					next = (next + 1) & mask();
+				}
+				set_ctrl(hole, hash_detail::EMPTY);
+			}
+
+	// ==================================================================================================
+
+	// capacity =========================================================================================
+
+		public:
+			bool		empty() const { return _size == 0; }
+			size_type	size() const { return _size; }
+			size_type	max_size() const { return _alloc.max_size(); }
+
+	// ==================================================================================================
+
+	// bucket interface / hash policy ===================================================================
+
+			size_type	bucket_count() const { return _capacity; }
+
+			float		load_factor() const { return _capacity == 0 ? 0.0f : static_cast<float>(_size) / _capacity; }
+
+			float		max_load_factor() const { return _max_load_factor; }
+
+			// at least one slot has to stay empty so that probing terminates; and
+			// below 1/16 size / ml would overflow size_type long before any
+			// table could be that sparse
+			void		max_load_factor(float ml) {
+				if (!(ml > 0.0f))
+					ml = 0.875f;
+				if (ml < 0.0625f)
+					ml = 0.0625f;
+				if (ml > 0.9375f)
+					ml = 0.9375f;
+				_max_load_factor = ml;
+				if (_capacity != 0) {
+					_growth_limit = growth_limit_for(_capacity);
+					if (_size > _growth_limit)
+						reserve(_size);
+				}
+			}
+
+			// an empty table asked for no buckets ends up unallocated
+			void		rehash(size_type n) {
+				size_type needed = _size == 0 ? 0 : static_cast<size_type>(_size / _max_load_factor) + 1;
+				if (n < needed)
+					n = needed;
+				if (n == 0) {
+					destroy_storage();
+					return;
+				}
+				size_type cap = hash_detail::round_up_capacity(n);
+				if (cap != _capacity)
+					resize(cap);
+			}
+
+			void		reserve(size_type n) {
+				if (n == 0 || (n <= _growth_limit && _capacity != 0))
+					return;
+				rehash(static_cast<size_type>(n / _max_load_factor) + 1);
+			}
+
+	// ==================================================================================================
+
+	// insert ===========================================================================================
+
+			pair<iterator, bool> insert(const value_type& val) {
+				const key_type& k = _key_of(val);
+				size_type h = hash_of(k);
+				size_type i = find_index(k, h);
+				if (i != _capacity)
+					return ft::make_pair(make_iterator(i), false);
+				return ft::make_pair(make_iterator(insert_new(val, h)), true);
+			}
+
+			template <typename InputIterator>
+			void insert(InputIterator first, InputIterator last,
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = NULL) {
+				for (; first != last; ++first)
+					insert(*first);
+			}
+
+			// map tables only: a hit returns the element as is, the default
+			// mapped value is built only when the key is missing
+			value_type& find_or_insert(const key_type& k) {
+				size_type h = hash_of(k);
+				size_type i = find_index(k, h);
+				if (i == _capacity)
+					i = insert_new(value_type(k, typename value_type::second_type()), h);
+				return _slots[i];
+			}
+
+	// ==================================================================================================
+
+	// erase ============================================================================================
+
+			// an element may be shifted into the erased slot, so the returned
+			// iterator points at that slot again when it is still occupied. The
+			// shift only moves elements of the same run, which never spans the
+			// origin, so they all come from slots the iteration has yet to reach.
+			iterator erase(const_iterator position) {
+				size_type i = position.ctrl() - _ctrl;
+				erase_index(i);
+				return make_iterator(i);
+			}
+
+			size_type erase(const key_type& k) {
+				size_type i = find_index(k, hash_of(k));
+				if (i == _capacity)
+					return 0;
+				erase_index(i);
+				return 1;
+			}
+
+			void clear() {
+				if (_size == 0)
+					return;
+				for (size_type i = 0; i < _capacity; i++) {
+					if (_ctrl[i] != hash_detail::EMPTY)
+						_alloc.destroy(_slots + i);
+				}
+				std::memset(_ctrl, hash_detail::EMPTY, _capacity + hash_detail::GROUP_WIDTH - 1);
+				_size = 0;
+				_origin = 0;
+			}
+
+	// ==================================================================================================
+
+	// swap =============================================================================================
+
+			void swap(hash_table& ref) {
+				if (this == &ref)
+					return;
+				std::swap(_hash, ref._hash);
+				std::swap(_eq, ref._eq);
+				std::swap(_alloc, ref._alloc);
+				std::swap(_ctrl_alloc, ref._ctrl_alloc);
+				std::swap(_ctrl, ref._ctrl);
+				std::swap(_slots, ref._slots);
+				std::swap(_capacity, ref._capacity);
+				std::swap(_size, ref._size);
+				std::swap(_growth_limit, ref._growth_limit);
+				std::swap(_origin, ref._origin);
+				std::swap(_max_load_factor, ref._max_load_factor);
+			}
+
+	// ==================================================================================================
+
+	// lookup ===========================================================================================
+
+			iterator find(const key_type& k) {
+				return make_iterator(find_index(k, hash_of(k)));
+			}
+
+			const_iterator find(const key_type& k) const {
+				return make_iterator(find_index(k, hash_of(k)));
+			}
+
+			size_type count(const key_type& k) const {
+				return find_index(k, hash_of(k)) != _capacity ? 1 : 0;
+			}
+
+	// ==================================================================================================
+
+	// observers ========================================================================================
+
+			hasher			hash_function() const { return _hash; }
+			key_equal		key_eq() const { return _eq; }
+			allocator_type	get_allocator() const { return _alloc; }
+
+			// the slot array (empty slots are overhead) and the control bytes
+			ft::memory_footprint memory_usage() const {
+				ft::memory_footprint m;
+				if (_capacity == 0)
+					return m;
+				m.add_blocks(_capacity * sizeof(value_type), 1, _size * sizeof(value_type));
+				m.add_blocks((_capacity + hash_detail::GROUP_WIDTH - 1) * sizeof(ctrl_t), 1, 0);
+				return m;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef HUGE_PAGES_HPP
+#define HUGE_PAGES_HPP
+
+#include "pmr.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+
+// Memory on 2 MB pages for containers too big for the TLB: a 10^8 entry map
+// or a multi-GB vector touched at random misses the TLB on nearly every
+// access with 4 KB pages. Regions are mapped 2 MB aligned and advised with
+// MADV_HUGEPAGE, so transparent huge pages back them when the kernel has THP
+// in "madvise" or "always" mode. Otherwise the advice is refused, silently,
+// and the memory stays on 4 KB pages.
+//   huge_page_allocator<T>    vector buffers: 1 MB or more mapped on their own
+//   pmr::huge_page_resource   node pools: an upstream carving small blocks out
+//                             of shared 2 MB regions, e.g. under
+//                             pmr::unsynchronized_pool_resource
+
+namespace ft {
+namespace huge_pages {
+
+	static const size_t	page_size = 2 * 1024 * 1024;
+	static const size_t	large_threshold = page_size / 2;	// smaller requests share pages
+
+	inline size_t round_up(size_t bytes) {
+		return (bytes + page_size - 1) & ~(page_size - 1);
+	}
+
+	// a 2 MB aligned anonymous mapping of round_up(bytes); NULL if mmap fails
+	inline void* map(size_t bytes) {
+		if (bytes == 0 || bytes > std::numeric_limits<size_t>::max() - 2 * page_size)
+			return NULL;
+		size_t size = round_up(bytes);
+		void* raw = mmap(NULL, size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED)
+			return NULL;
+		// over-map by one page, then trim both ends to the aligned part
+		char* start = static_cast<char*>(raw);
+		char* p = reinterpret_cast<char*>((reinterpret_cast<size_t>(start) + page_size - 1) & ~(page_size - 1));
+		if (p != start)
+			munmap(start, static_cast<size_t>(p - start));
+		if (p + size != start + size + page_size)
+			munmap(p + size, static_cast<size_t>(start + size + page_size - (p + size)));
+#ifdef MADV_HUGEPAGE
+		madvise(p, size, MADV_HUGEPAGE);
+#endif
+		return p;
+	}
+
+	inline void unmap(void* p, size_t bytes) {
+		if (p != NULL)
+			munmap(p, round_up(bytes));
+	}
+}
+
+	// Stateless: requests of large_threshold bytes or more get their own huge
+	// page mapping, smaller ones (a vector's first few growths) operator new.
+	template <typename T>
+	class huge_page_allocator {
+		public:
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef const T*	const_pointer;
+			typedef T&			reference;
+			typedef const T&	const_reference;
+			typedef size_t		size_type;
+			typedef ptrdiff_t	difference_type;
+
+			template <typename U>
+			struct rebind { typedef huge_page_allocator<U> other; };
+
+			huge_page_allocator() throw() {}
+			huge_page_allocator(const huge_page_allocator&) throw() {}
+			template <typename U>
+			huge_page_allocator(const huge_page_allocator<U>&) throw() {}
+			~huge_page_allocator() throw() {}
+
+			pointer			address(reference x) const { return &x; }
+			const_pointer	address(const_reference x) const { return &x; }
+
+			pointer allocate(size_type n, const void* hint = 0) {
+				(void)hint;
+				if (n > max_size())
+					throw std::bad_alloc();
+				size_t bytes = n * sizeof(T);
+				if (bytes < huge_pages::large_threshold)
+					return static_cast<pointer>(::operator new(bytes));
+				void* p = huge_pages::map(bytes);
+				if (p == NULL)
+					throw std::bad_alloc();
+				return static_cast<pointer>(p);
+			}
+
+			void deallocate(pointer p, size_type n) {
+				size_t bytes = n * sizeof(T);
+				if (bytes < huge_pages::large_threshold)
+					::operator delete(p);
+				else
+					huge_pages::unmap(p, bytes);
+			}
+
+			size_type max_size() const throw() {
+				return std::numeric_limits<size_type>::max() / sizeof(T);
+			}
+
+			void construct(pointer p, const_reference val) { ::new (static_cast<void*>(p)) T(val); }
+			void destroy(pointer p) { p->~T(); }
+
+			template <typename U>
+			bool operator==(const huge_page_allocator<U>&) const { return true; }
+			template <typename U>
+			bool operator!=(const huge_page_allocator<U>&) const { return false; }
+	};
+
+namespace pmr {
+
+	// Large requests are mapped on their own and unmapped on deallocate().
+	// Smaller ones are carved from shared 2 MB regions and only come back on
+	// release() or destruction, so put a pool in front to recycle them.
+	// Not thread safe.
+	class huge_page_resource : public memory_resource {
+		private:
+			struct region {
+				region*	next;
+			};
+
+			region*	_regions;
+			char*	_cursor;
+			char*	_end;
+			size_t	_mapped;
+
+			huge_page_resource(const huge_page_resource&);
+			huge_page_resource& operator=(const huge_page_resource&);
+
+			virtual void* do_allocate(size_t bytes, size_t alignment) {
+				if (bytes >= huge_pages::large_threshold) {
+					void* p = huge_pages::map(bytes);
+					if (p == NULL)
+						throw std::bad_alloc();
+					_mapped += huge_pages::round_up(bytes);
+					return p;
+				}
+				char* p = _cursor ? resource_detail::align_up(_cursor, alignment) : NULL;
+				if (p == NULL || p > _end || static_cast<size_t>(_end - p) < bytes) {
+					region* r = static_cast<region*>(huge_pages::map(huge_pages::page_size));
+					if (r == NULL)
+						throw std::bad_alloc();
+					r->next = _regions;
+					_regions = r;
+					_mapped += huge_pages::page_size;
+					_cursor = reinterpret_cast<char*>(r + 1);
+					_end = reinterpret_cast<char*>(r) + huge_pages::page_size;
+					p = resource_detail::align_up(_cursor, alignment);
+				}
+				_cursor = p + bytes;
+				return p;
+			}
+
+			virtual void do_deallocate(void* p, size_t bytes, size_t) {
+				if (bytes >= huge_pages::large_threshold) {
+					huge_pages::unmap(p, bytes);
+					_mapped -= huge_pages::round_up(bytes);
+				}
+			}
+
+			virtual bool do_is_equal(const memory_resource& other) const throw() {
+				return this == &other;
+			}
+
+		public:
+			huge_page_resource() : _regions(NULL), _cursor(NULL), _end(NULL), _mapped(0) {}
+			~huge_page_resource() { release(); }
+
+			// unmaps the shared regions; large blocks still out stay mapped
+			void release() {
+				while (_regions != NULL) {
+					region* next = _regions->next;
+					huge_pages::unmap(_regions, huge_pages::page_size);
+					_mapped -= huge_pages::page_size;
+					_regions = next;
+				}
+				_cursor = NULL;
+				_end = NULL;
+			}
+
+			// bytes currently mapped, regions and large blocks
+			size_t mapped() const { return _mapped; }
+	};
+}
+}
+
+#endif
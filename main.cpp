@@ -1,57 +1,59 @@
-#include "enable_if.hpp"
 #include "vector.hpp"
 #include "map.hpp"
 #include "set.hpp"
 #include "stack.hpp"
 
 #include <iostream>
-#include <iterator>
-#include <memory>
-#include <iostream>
-#include <time.h>
-#include <vector>
 #include <map>
 #include <set>
 #include <stack>
+#include <vector>
+
+// smoke check: the same operations on ft and std containers must agree.
+// timing lives in the bench suite (make bench).
 
 int main()
 {
 	std::vector<int> v1;
 	ft::vector<int> v2;
-
-	clock_t start, end;
-	double result;
-
-	start = clock();
-	for (int i = 0; i < 10000; i++)
-		v1.push_back(i);
-	end = clock();
-	result = (double)(end - start);
-	std::cout << "std::vector time : " << result << std::endl;
-
-	start = clock();
-	for (int i = 0; i < 10000; i++)
-		v2.push_back(i);
-	end = clock();
-	result = (double)(end - start);
-	std::cout << "ft::vector time : " << result << std::endl;
-
 	std::map<int, int> m1;
 	ft::map<int, int> m2;
-
-	start = clock();
-	for (int i = 0; i < 1000000; i++)
-		m1.insert(std::make_pair(i, i));
-	end = clock();
-	result = (double)(end - start);
-	std::cout << "std::map time : " << result << std::endl;
-
-	start = clock();
-	for (int i = 0; i < 1000000; i++)
-		m2.insert(ft::make_pair(i, i));
-	end = clock();
-	result = (double)(end - start);
-	std::cout << "ft::map time : " << result << std::endl;
+	std::set<int> s1;
+	ft::set<int> s2;
+	std::stack<int> st1;
+	ft::stack<int> st2;
+
+	for (int i = 0; i < 10000; i++) {
+		int k = (i * 7919) % 10007;
+		v1.push_back(k);
+		v2.push_back(k);
+		m1.insert(std::make_pair(k, i));
+		m2.insert(ft::make_pair(k, i));
+		s1.insert(k % 1000);
+		s2.insert(k % 1000);
+		st1.push(k);
+		st2.push(k);
+	}
+	for (int k = 0; k < 10007; k += 3) {
+		m1.erase(k);
+		m2.erase(k);
+	}
+
+	bool ok = v1.size() == v2.size() && m1.size() == m2.size()
+		&& s1.size() == s2.size() && st1.size() == st2.size();
+	for (size_t i = 0; ok && i < v1.size(); i++)
+		ok = v1[i] == v2[i];
+	std::map<int, int>::iterator mit1 = m1.begin();
+	for (ft::map<int, int>::iterator mit2 = m2.begin(); ok && mit2 != m2.end(); ++mit1, ++mit2)
+		ok = mit1->first == mit2->first && mit1->second == mit2->second;
+	std::set<int>::iterator sit1 = s1.begin();
+	for (ft::set<int>::iterator sit2 = s2.begin(); ok && sit2 != s2.end(); ++sit1, ++sit2)
+		ok = *sit1 == *sit2;
+	for (; ok && !st1.empty(); st1.pop(), st2.pop())
+		ok = st1.top() == st2.top();
+
+	std::cout << (ok ? "ft matches std" : "ft differs from std") << std::endl;
+	return ok ? 0 : 1;
 }
 
 // #include <iostream>
@@ -2,10 +2,15 @@
 #define MAP_HPP
 
 #include "red_black_tree.hpp"
+#include "node_handle.hpp"
+#include <algorithm>
+#include <cassert>
 #include <memory>
+#include <new>
 
 namespace ft{
-	template<typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	// Stats turns on the tree's rebalancing counters (see tree_stats.hpp)
+	template<typename Key, typename T, typename Compare = ft::less<Key>, typename Alloc = std::allocator<ft::pair<const Key, T> >, bool Stats = false>
 	class map{
 	public:
 		typedef Key key_type;
@@ -40,28 +45,63 @@ namespace ft{
 			}
 		};
 
+	private:
+		typedef ft::red_black_tree<value_type, value_compare, allocator_type, Stats>	tree_type;
+
+		// lets the tree search by key alone, without building a value_type
+		struct key_value_compare{
+			key_compare comp;
+			key_value_compare(const key_compare& c) : comp(c) {}
+			bool operator()(const key_type& k, const value_type& v) const{ return comp(k, v.first); }
+			bool operator()(const value_type& v, const key_type& k) const{ return comp(v.first, k); }
+		};
+
+		// builds the value straight into the node; mapped_type is constructed from obj
+		template<typename M>
+		struct value_constructor{
+			const key_type& key;
+			const M& obj;
+			value_constructor(const key_type& k, const M& o) : key(k), obj(o) {}
+			void operator()(value_type* p) const{
+				::new (static_cast<void*>(p)) value_type(ft::piecewise_construct_t(), key, obj);
+			}
+		};
+		// mapped_type is value-initialized in the node, not copied from a temporary
+		struct default_value_constructor{
+			const key_type& key;
+			default_value_constructor(const key_type& k) : key(k) {}
+			void operator()(value_type* p) const{
+				::new (static_cast<void*>(p)) value_type(ft::piecewise_construct_t(), key);
+			}
+		};
+
+	public:
+		typedef ft::map_node_handle<Key, T, typename tree_type::node_allocator_type> node_type;
+		typedef ft::insert_return_type<iterator, node_type> insert_return_type;
+
 	private:
 		key_compare														_comp;
-		allocator_type													_alloc;
-		ft::red_black_tree<value_type, value_compare, allocator_type>	_tree;
+		tree_type														_tree;
 	public:
 		explicit map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()) 
-		: _comp(comp), _alloc(alloc), _tree(value_compare(_comp), _alloc){}
+		: _comp(comp), _tree(value_compare(comp), alloc){}
 		
 		template<typename InputIterator>
 		map(InputIterator first, InputIterator last,
 		 const key_compare& comp = key_compare(), 
 		 const allocator_type& alloc = allocator_type()) 
-		 : _comp(comp), _alloc(alloc), _tree(value_compare(_comp), _alloc){
+		 : _comp(comp), _tree(value_compare(_comp), alloc){
 			insert(first, last);
 		}
-		map(const map& x) : _comp(x._comp), _alloc(x._alloc), _tree(x._tree){}
+		map(const map& x) : _comp(x._comp), _tree(x._tree){}
 		~map(){}
 
+		// _comp goes along with the tree: key lookups descend with it
 		map& operator=(const map& x){
 			if(this == &x)
 				return *this;
 			_tree = x._tree;
+			_comp = x._comp;
 			return *this;
 		}
 
@@ -82,7 +122,7 @@ namespace ft{
 		size_type max_size() const{return _tree.max_size();}
 
 		mapped_type& operator[](const key_type& k){
-			return (*((this->insert(ft::make_pair(k, mapped_type()))).first)).second;
+			return try_emplace(k).first->second;
 		}
 
 		//insert
@@ -97,80 +137,135 @@ namespace ft{
 			_tree.insert(first, last);
 		}
 
+		//try_emplace, insert_or_assign: mapped_type is only constructed when k is absent
+		pair<iterator, bool> try_emplace(const key_type& k){
+			return _tree.emplace_unique(k, key_value_compare(_comp), default_value_constructor(k));
+		}
+		template<typename M>
+		pair<iterator, bool> try_emplace(const key_type& k, const M& obj){
+			return _tree.emplace_unique(k, key_value_compare(_comp), value_constructor<M>(k, obj));
+		}
+		iterator try_emplace(iterator hint, const key_type& k){
+			(void)hint;
+			return try_emplace(k).first;
+		}
+		template<typename M>
+		iterator try_emplace(iterator hint, const key_type& k, const M& obj){
+			(void)hint;
+			return try_emplace(k, obj).first;
+		}
+		template<typename M>
+		pair<iterator, bool> insert_or_assign(const key_type& k, const M& obj){
+			pair<iterator, bool> ret = try_emplace(k, obj);
+			if (!ret.second)
+				ret.first->second = obj;
+			return ret;
+		}
+		template<typename M>
+		iterator insert_or_assign(iterator hint, const key_type& k, const M& obj){
+			(void)hint;
+			return insert_or_assign(k, obj).first;
+		}
+
+		//node handles
+		node_type extract(iterator position){
+			return node_type(_tree.extract_node(position), _tree.get_node_allocator());
+		}
+		node_type extract(const key_type& k){
+			iterator it = find(k);
+			if (it == end())
+				return node_type();
+			return extract(it);
+		}
+		// the node is freed by this tree's allocator later on, so it has to
+		// come from an equal one
+		insert_return_type insert(node_type nh){
+			insert_return_type ret;
+			if (nh.empty()){
+				ret.position = end();
+				ret.inserted = false;
+				return ret;
+			}
+			assert(nh.get_allocator() == _tree.get_node_allocator());
+			typename node_type::node_ptr node = nh.release();
+			pair<iterator, bool> res = _tree.reinsert_node(node);
+			ret.position = res.first;
+			ret.inserted = res.second;
+			if (!res.second)
+				ret.node = node_type(node, _tree.get_node_allocator());
+			return ret;
+		}
+		iterator insert(iterator hint, node_type nh){
+			(void)hint;
+			if (nh.empty())
+				return end();
+			return insert(nh).position;
+		}
+		// moves every node whose key is not already here; nothing is allocated or copied
+		template<typename C2, bool S2>
+		void merge(map<Key, T, C2, Alloc, S2>& source){
+			typedef typename map<Key, T, C2, Alloc, S2>::iterator source_iterator;
+			assert(source.get_allocator() == get_allocator());
+			for (source_iterator it = source.begin(); it != source.end(); ){
+				source_iterator next = it;
+				++next;
+				if (find(it->first) == end())
+					insert(source.extract(it));
+				it = next;
+			}
+		}
+
 		void erase(iterator position){
 			_tree.erase(position);
 		}
 		size_type erase(const key_type& k){
-			return _tree.erase(ft::make_pair(k, mapped_type()));
+			return _tree.erase_key(k, key_value_compare(_comp));
 		}
 		void erase(iterator first, iterator last){
 			_tree.erase(first, last);
 		}
 		void swap(map& x){
 			_tree.swap(x._tree);
+			std::swap(_comp, x._comp);
 		}
 		void clear(){
 			_tree.clear();
 		}
+		// keep_nodes: the nodes stay allocated and the next inserts reuse them
+		void clear(bool keep_nodes){
+			_tree.clear(keep_nodes);
+		}
+		size_type spare_nodes() const{
+			return _tree.spare_nodes();
+		}
 		key_compare key_comp() const{
-			return key_compare();
+			return _comp;
 		}
 		value_compare value_comp() const{
-			return value_compare(key_compare());
+			return value_compare(_comp);
 		}
 
 		iterator find(const key_type& k){
-			return _tree.find(ft::make_pair(k, mapped_type()));
+			return _tree.find_key(k, key_value_compare(_comp));
 		}
 		const_iterator find(const key_type& k) const{
-			return _tree.find(ft::make_pair(k, mapped_type()));
+			return _tree.find_key(k, key_value_compare(_comp));
 		}
 		size_type count(const key_type& k) const{
-			return _tree.count(ft::make_pair(k, mapped_type()));
+			return find(k) == end() ? 0 : 1;
 		}
 	
 		iterator lower_bound(const key_type& key) {
-				iterator it1 = this->begin();
-				iterator it2 = this->end();
-				while (it1 != it2) {
-					if (_comp(it1->first, key) == false)
-						break;
-					++it1;
-				}
-				return it1;
+			return _tree.lower_bound_key(key, key_value_compare(_comp));
 		}
-
 		const_iterator lower_bound(const key_type& key) const {
-				const_iterator it1 = this->begin();
-				const_iterator it2 = this->end();
-				while (it1 != it2) {
-					if (_comp(it1->first, key) == false)
-						break;
-					++it1;
-				}
-				return it1;
+			return _tree.lower_bound_key(key, key_value_compare(_comp));
 		}
-
 		iterator upper_bound(const key_type& key) {
-				iterator it1 = this->begin();
-				iterator it2 = this->end();
-				while (it1 != it2) {
-					if (_comp(key, it1->first) == true)
-						break;
-					++it1;
-				}
-				return it1;
+			return _tree.upper_bound_key(key, key_value_compare(_comp));
 		}
-	
 		const_iterator upper_bound(const key_type& key) const {
-				const_iterator it1 = this->begin();
-				const_iterator it2 = this->end();
-				while (it1 != it2) {
-					if (_comp(key, it1->first) == true)
-						break;
-					++it1;
-				}
-				return it1;
+			return _tree.upper_bound_key(key, key_value_compare(_comp));
 		}
 
 		pair<const_iterator, const_iterator> equal_range(const key_type& k) const{
@@ -184,43 +279,61 @@ namespace ft{
 			return ft::make_pair(it1, it2);
 		}
 		allocator_type get_allocator() const{
-			return allocator_type();
+			return _tree.get_allocator();
+		}
+
+		ft::memory_footprint memory_usage() const{
+			return _tree.memory_usage();
+		}
+
+		//statistics
+		const ft::tree_stats& stats() const{
+			return _tree.stats();
+		}
+		void reset_stats(){
+			_tree.reset_stats();
+		}
+		ft::tree_shape shape() const{
+			return _tree.shape();
+		}
+		bool verify() const{
+			return _tree.verify();
 		}
 	};
-	template <class Key, class T, class Compare, class Alloc>
-	void swap(map<Key, T, Compare, Alloc>& x, map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	void swap(map<Key, T, Compare, Alloc, Stats>& x, map<Key, T, Compare, Alloc, Stats>& y) {
 		x.swap(y);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator==(const map<Key, T, Compare, Alloc>& x, const map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	bool operator==(const map<Key, T, Compare, Alloc, Stats>& x, const map<Key, T, Compare, Alloc, Stats>& y) {
 		if (x.size() != y.size())
 			return false;
 		return ft::equal(x.begin(), x.end(), y.begin());
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator!=(const map<Key, T, Compare, Alloc>& x, const map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	bool operator!=(const map<Key, T, Compare, Alloc, Stats>& x, const map<Key, T, Compare, Alloc, Stats>& y) {
 		return !(x == y);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator<(const map<Key, T, Compare, Alloc>& x, const map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	bool operator<(const map<Key, T, Compare, Alloc, Stats>& x, const map<Key, T, Compare, Alloc, Stats>& y) {
 		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator<=(const map<Key, T, Compare, Alloc>& x, const map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	bool operator<=(const map<Key, T, Compare, Alloc, Stats>& x, const map<Key, T, Compare, Alloc, Stats>& y) {
 		return !(y < x);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator>(const map<Key, T, Compare, Alloc>& x, const map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	bool operator>(const map<Key, T, Compare, Alloc, Stats>& x, const map<Key, T, Compare, Alloc, Stats>& y) {
 		return y < x;
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator>=(const map<Key, T, Compare, Alloc>& x, const map<Key, T, Compare, Alloc>& y) {
+	template <class Key, class T, class Compare, class Alloc, bool Stats>
+	bool operator>=(const map<Key, T, Compare, Alloc, Stats>& x, const map<Key, T, Compare, Alloc, Stats>& y) {
 		return !(x < y);
 	}
 
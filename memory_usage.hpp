@@ -0,0 +1,60 @@
+#ifndef MEMORY_USAGE_HPP
+#define MEMORY_USAGE_HPP
+
+#include <cstddef>
+#include <ostream>
+
+namespace ft {
+
+	// What malloc adds on top of a request, for glibc on 64-bit: one size word
+	// per chunk, 16-byte granularity, 32-byte minimum chunk, and whole pages for
+	// requests past the mmap threshold. An estimate for other mallocs.
+	inline size_t estimated_malloc_overhead(size_t bytes) {
+		const size_t mmap_threshold = 128 * 1024;
+		size_t chunk;
+		if (bytes >= mmap_threshold)
+			chunk = (bytes + 2 * sizeof(size_t) + 4095) & ~static_cast<size_t>(4095);
+		else {
+			chunk = (bytes + sizeof(size_t) + 15) & ~static_cast<size_t>(15);
+			if (chunk < 32)
+				chunk = 32;
+		}
+		return chunk - bytes;
+	}
+
+	// Heap memory a container owns, as returned by memory_usage(). payload is
+	// size() * sizeof(value_type); overhead is every other byte the container
+	// asked its allocator for (node links and colour, spare vector capacity,
+	// empty hash slots and control bytes, B-tree inner nodes and unused leaf
+	// slots, the red-black tree's head node); allocator is the estimated malloc
+	// overhead of those blocks. Memory owned by the elements themselves (a
+	// std::string's buffer) and sizeof the container object are not included.
+	struct memory_footprint {
+		size_t	payload;
+		size_t	overhead;
+		size_t	allocator;
+		size_t	blocks;
+
+		memory_footprint() : payload(0), overhead(0), allocator(0), blocks(0) {}
+
+		// count blocks of `bytes` each, holding payload_bytes of elements in total
+		void add_blocks(size_t bytes, size_t count, size_t payload_bytes) {
+			if (count == 0)
+				return;
+			payload += payload_bytes;
+			overhead += bytes * count - payload_bytes;
+			allocator += estimated_malloc_overhead(bytes) * count;
+			blocks += count;
+		}
+
+		size_t	requested() const { return payload + overhead; }
+		size_t	total() const { return payload + overhead + allocator; }
+	};
+
+	inline std::ostream& operator<<(std::ostream& os, const memory_footprint& m) {
+		return os << "payload " << m.payload << " B, overhead " << m.overhead
+			<< " B, allocator " << m.allocator << " B (estimated), " << m.blocks << " blocks\n";
+	}
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef NODE_HANDLE_HPP
+#define NODE_HANDLE_HPP
+
+#include "red_black_tree_node.hpp"
+#include "enable_if.hpp"
+
+namespace ft {
+
+	// Owns a node extracted from a map or set (extract / insert / merge).
+	// c++98 has no move constructor, so copying a handle transfers ownership
+	// the way std::auto_ptr does: the source is left empty.
+	template <typename Value, typename NodeAlloc>
+	class node_handle_base {
+		public:
+			typedef Value					value_type;
+			typedef NodeAlloc				allocator_type;
+			typedef RedBlackTreeNode<Value>	node_type;
+			typedef node_type*				node_ptr;
+
+		protected:
+			mutable node_ptr	_node;
+			allocator_type		_alloc;
+
+		public:
+			node_handle_base() : _node(NULL), _alloc() {}
+			node_handle_base(node_ptr node, const allocator_type& alloc) : _node(node), _alloc(alloc) {}
+			node_handle_base(const node_handle_base& other) : _node(other.release()), _alloc(other._alloc) {}
+			~node_handle_base() { reset(); }
+
+			node_handle_base& operator=(const node_handle_base& other) {
+				if (this != &other) {
+					reset();
+					_alloc = other._alloc;
+					_node = other.release();
+				}
+				return *this;
+			}
+
+			bool			empty() const { return _node == NULL; }
+			allocator_type	get_allocator() const { return _alloc; }
+
+			// gives the node back to a tree; the handle becomes empty
+			node_ptr release() const {
+				node_ptr node = _node;
+				_node = NULL;
+				return node;
+			}
+
+			void reset() {
+				if (_node == NULL)
+					return;
+				_alloc.destroy(_node);
+				_alloc.deallocate(_node, 1);
+				_node = NULL;
+			}
+	};
+
+	template <typename Key, typename T, typename NodeAlloc>
+	class map_node_handle : public node_handle_base<ft::pair<const Key, T>, NodeAlloc> {
+		private:
+			typedef node_handle_base<ft::pair<const Key, T>, NodeAlloc>	base;
+
+		public:
+			typedef Key		key_type;
+			typedef T		mapped_type;
+
+			map_node_handle() : base() {}
+			map_node_handle(typename base::node_ptr node, const NodeAlloc& alloc) : base(node, alloc) {}
+			map_node_handle(const map_node_handle& other) : base(other) {}
+
+			map_node_handle& operator=(const map_node_handle& other) {
+				base::operator=(other);
+				return *this;
+			}
+
+			// the node is out of any tree, so its key may be changed before re-insertion
+			key_type&		key() const { return const_cast<key_type&>(this->_node->value.first); }
+			mapped_type&	mapped() const { return this->_node->value.second; }
+	};
+
+	template <typename Key, typename NodeAlloc>
+	class set_node_handle : public node_handle_base<Key, NodeAlloc> {
+		private:
+			typedef node_handle_base<Key, NodeAlloc>	base;
+
+		public:
+			set_node_handle() : base() {}
+			set_node_handle(typename base::node_ptr node, const NodeAlloc& alloc) : base(node, alloc) {}
+			set_node_handle(const set_node_handle& other) : base(other) {}
+
+			set_node_handle& operator=(const set_node_handle& other) {
+				base::operator=(other);
+				return *this;
+			}
+
+			Key&	value() const { return this->_node->value; }
+	};
+
+	template <typename Iterator, typename NodeHandle>
+	struct insert_return_type {
+		Iterator	position;
+		bool		inserted;
+		NodeHandle	node;
+	};
+}
+
+#endif
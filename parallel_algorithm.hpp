@@ -0,0 +1,440 @@
+#ifndef PARALLEL_ALGORITHM_HPP
+#define PARALLEL_ALGORITHM_HPP
+
+#include "enable_if.hpp"
+#include "iterator.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+// Parallel algorithms over random access ranges (ft::vector iterators,
+// pointers), run on the thread_pool the caller works for, or the default pool
+// of one worker per cpu. The range is halved recursively with
+// parallel_invoke down to a grain chosen from its size and the pool's: about
+// eight pieces per worker, never under par_detail::min_grain elements, so
+// idle workers have something to steal without the forks costing more than
+// the work. Ranges under two grains, or a pool of one worker, run
+// sequentially on the calling thread.
+//
+// Functions and comparators are called from several threads at once and must
+// not throw (see thread_pool.hpp). Elements must be copy constructible and
+// assignable; sort and stable_sort use a buffer of n copies.
+
+namespace ft {
+
+	namespace par_detail {
+
+		static const size_t	min_grain = 4096;
+		static const size_t	min_sort_grain = 8192;
+		static const size_t	pieces_per_worker = 8;
+		static const size_t	insertion_sort_max = 32;
+
+		// elements per leaf task; 0 means do not bother forking at all
+		inline size_t grain_for(size_t n, size_t floor) {
+			// checked first: a small range never starts the default pool
+			if (n < 2 * floor)
+				return 0;
+			size_t workers = thread_pool::current().size();
+			if (workers < 2)
+				return 0;
+			size_t grain = n / (workers * pieces_per_worker);
+			return grain < floor ? floor : grain;
+		}
+
+		template <typename It>
+		It nth(It it, size_t n) {
+			return it + static_cast<typename iterator_traits<It>::difference_type>(n);
+		}
+
+		// for_each, transform ===============================================
+
+		// calls body(begin, end) over index ranges of at most grain elements
+		template <typename Body>
+		struct split_task {
+			Body*	body;
+			size_t	begin;
+			size_t	end;
+			size_t	grain;
+
+			split_task(Body* b, size_t first, size_t last, size_t g) : body(b), begin(first), end(last), grain(g) {}
+
+			void operator()() {
+				if (end - begin <= grain) {
+					(*body)(begin, end);
+					return;
+				}
+				size_t mid = begin + (end - begin) / 2;
+				split_task left(body, begin, mid, grain);
+				split_task right(body, mid, end, grain);
+				parallel_invoke(left, right);
+			}
+		};
+
+		template <typename Body>
+		void split(Body& body, size_t n, size_t grain) {
+			split_task<Body> root(&body, 0, n, grain);
+			thread_pool::current().run(root);
+		}
+
+		template <typename It, typename F>
+		struct for_each_body {
+			It	first;
+			F	f;
+
+			for_each_body(It it, F fn) : first(it), f(fn) {}
+
+			// a copy of f per leaf, like std::for_each on each piece
+			void operator()(size_t begin, size_t end) const {
+				F fn = f;
+				It last = nth(first, end);
+				for (It it = nth(first, begin); it != last; ++it)
+					fn(*it);
+			}
+		};
+
+		template <typename In, typename Out, typename F>
+		struct transform_body {
+			In	first;
+			Out	out;
+			F	op;
+
+			transform_body(In in, Out o, F fn) : first(in), out(o), op(fn) {}
+
+			void operator()(size_t begin, size_t end) const {
+				In last = nth(first, end);
+				Out o = nth(out, begin);
+				for (In it = nth(first, begin); it != last; ++it, ++o)
+					*o = op(*it);
+			}
+		};
+
+		template <typename In1, typename In2, typename Out, typename F>
+		struct transform2_body {
+			In1	first1;
+			In2	first2;
+			Out	out;
+			F	op;
+
+			transform2_body(In1 in1, In2 in2, Out o, F fn) : first1(in1), first2(in2), out(o), op(fn) {}
+
+			void operator()(size_t begin, size_t end) const {
+				In1 last = nth(first1, end);
+				In2 it2 = nth(first2, begin);
+				Out o = nth(out, begin);
+				for (In1 it = nth(first1, begin); it != last; ++it, ++it2, ++o)
+					*o = op(*it, *it2);
+			}
+		};
+
+		// reduce ============================================================
+
+		// op folded over n >= 2 elements, left to right within each piece;
+		// result starts as a copy of init only because T need not have a
+		// default constructor
+		template <typename It, typename T, typename Op>
+		struct reduce_task {
+			It			first;
+			size_t		n;
+			size_t		grain;
+			const Op*	op;
+			T			result;
+
+			reduce_task(It it, size_t count, size_t g, const Op* fn, const T& init)
+				: first(it), n(count), grain(g), op(fn), result(init) {}
+
+			void operator()() {
+				if (n <= grain) {
+					result = (*op)(*first, *nth(first, 1));
+					It last = nth(first, n);
+					for (It it = nth(first, 2); it != last; ++it)
+						result = (*op)(result, *it);
+					return;
+				}
+				reduce_task left(first, n / 2, grain, op, result);
+				reduce_task right(nth(first, n / 2), n - n / 2, grain, op, result);
+				parallel_invoke(left, right);
+				result = (*op)(left.result, right.result);
+			}
+		};
+
+		// merge =============================================================
+
+		template <typename It, typename T, typename Compare>
+		size_t first_not_less(It first, size_t n, const T& value, const Compare& comp) {
+			size_t lo = 0;
+			while (n > 0) {
+				size_t half = n / 2;
+				if (comp(*nth(first, lo + half), value)) {
+					lo += half + 1;
+					n -= half + 1;
+				}
+				else
+					n = half;
+			}
+			return lo;
+		}
+
+		template <typename It, typename T, typename Compare>
+		size_t first_greater(It first, size_t n, const T& value, const Compare& comp) {
+			size_t lo = 0;
+			while (n > 0) {
+				size_t half = n / 2;
+				if (!comp(value, *nth(first, lo + half))) {
+					lo += half + 1;
+					n -= half + 1;
+				}
+				else
+					n = half;
+			}
+			return lo;
+		}
+
+		// stable: of equal elements, a's come first
+		template <typename In, typename Out, typename Compare>
+		void merge_runs(In a, size_t na, In b, size_t nb, Out out, const Compare& comp) {
+			In a_end = nth(a, na);
+			In b_end = nth(b, nb);
+			while (a != a_end && b != b_end) {
+				if (comp(*b, *a)) {
+					*out = *b;
+					++b;
+				}
+				else {
+					*out = *a;
+					++a;
+				}
+				++out;
+			}
+			for (; a != a_end; ++a, ++out)
+				*out = *a;
+			for (; b != b_end; ++b, ++out)
+				*out = *b;
+		}
+
+		// Splits the larger input at its middle and the other where that
+		// element would go, so both halves merge independently; the bounds
+		// keep a's elements ahead of equal b's.
+		template <typename In, typename Out, typename Compare>
+		struct merge_task {
+			In				a;
+			size_t			na;
+			In				b;
+			size_t			nb;
+			Out				out;
+			const Compare*	comp;
+			size_t			grain;
+
+			merge_task(In first1, size_t n1, In first2, size_t n2, Out o, const Compare* c, size_t g)
+				: a(first1), na(n1), b(first2), nb(n2), out(o), comp(c), grain(g) {}
+
+			void operator()() {
+				if (na + nb <= grain) {
+					merge_runs(a, na, b, nb, out, *comp);
+					return;
+				}
+				size_t ma;
+				size_t mb;
+				if (na >= nb) {
+					ma = na / 2;
+					mb = first_not_less(b, nb, *nth(a, ma), *comp);
+				}
+				else {
+					mb = nb / 2;
+					ma = first_greater(a, na, *nth(b, mb), *comp);
+				}
+				merge_task left(a, ma, b, mb, out, comp, grain);
+				merge_task right(nth(a, ma), na - ma, nth(b, mb), nb - mb, nth(out, ma + mb), comp, grain);
+				parallel_invoke(left, right);
+			}
+		};
+
+		// sort ==============================================================
+
+		// stable insertion sort, for the leaves of the merge sort
+		template <typename It, typename Compare>
+		void insertion_sort(It first, size_t n, const Compare& comp) {
+			typedef typename iterator_traits<It>::value_type value_type;
+			for (size_t i = 1; i < n; i++) {
+				value_type v = *nth(first, i);
+				size_t j = i;
+				while (j > 0 && comp(v, *nth(first, j - 1))) {
+					*nth(first, j) = *nth(first, j - 1);
+					j--;
+				}
+				*nth(first, j) = v;
+			}
+		}
+
+		template <typename In, typename Out>
+		void copy_run(In in, size_t n, Out out) {
+			for (size_t i = 0; i < n; i++, ++in, ++out)
+				*out = *in;
+		}
+
+		// Merge sort ping-ponging between the range a and the buffer b: the
+		// halves are sorted into the array the result does not go to, then
+		// merged into the one it does (b when to_buffer).
+		template <typename It, typename Buf, typename Compare>
+		void sequential_merge_sort(It a, Buf b, size_t n, bool to_buffer, const Compare& comp) {
+			if (n <= insertion_sort_max) {
+				insertion_sort(a, n, comp);
+				if (to_buffer)
+					copy_run(a, n, b);
+				return;
+			}
+			size_t half = n / 2;
+			sequential_merge_sort(a, b, half, !to_buffer, comp);
+			sequential_merge_sort(nth(a, half), nth(b, half), n - half, !to_buffer, comp);
+			if (to_buffer)
+				merge_runs(a, half, nth(a, half), n - half, b, comp);
+			else
+				merge_runs(b, half, nth(b, half), n - half, a, comp);
+		}
+
+		template <typename It, typename Buf, typename Compare>
+		struct sort_task {
+			It				a;
+			Buf				b;
+			size_t			n;
+			bool			to_buffer;
+			bool			stable;
+			const Compare*	comp;
+			size_t			grain;
+
+			sort_task(It first, Buf buf, size_t count, bool to_buf, bool st, const Compare* c, size_t g)
+				: a(first), b(buf), n(count), to_buffer(to_buf), stable(st), comp(c), grain(g) {}
+
+			void operator()() {
+				if (n <= grain) {
+					if (stable)
+						sequential_merge_sort(a, b, n, to_buffer, *comp);
+					else {
+						std::sort(a, nth(a, n), *comp);
+						if (to_buffer)
+							copy_run(a, n, b);
+					}
+					return;
+				}
+				size_t half = n / 2;
+				sort_task left(a, b, half, !to_buffer, stable, comp, grain);
+				sort_task right(nth(a, half), nth(b, half), n - half, !to_buffer, stable, comp, grain);
+				parallel_invoke(left, right);
+				if (to_buffer) {
+					merge_task<It, Buf, Compare> m(a, half, nth(a, half), n - half, b, comp, grain);
+					m();
+				}
+				else {
+					merge_task<Buf, It, Compare> m(b, half, nth(b, half), n - half, a, comp, grain);
+					m();
+				}
+			}
+		};
+
+		template <typename It, typename Compare>
+		void merge_sort(It first, It last, const Compare& comp, bool stable) {
+			typedef typename iterator_traits<It>::value_type value_type;
+			size_t n = static_cast<size_t>(last - first);
+			size_t grain = grain_for(n, min_sort_grain);
+			if (grain == 0 && !stable) {
+				std::sort(first, last, comp);
+				return;
+			}
+			if (n < 2)
+				return;
+			ft::vector<value_type> buffer(first, last);
+			if (grain == 0) {
+				sequential_merge_sort(first, &buffer[0], n, false, comp);
+				return;
+			}
+			sort_task<It, value_type*, Compare> root(first, &buffer[0], n, false, stable, &comp, grain);
+			thread_pool::current().run(root);
+		}
+	}
+
+	namespace par {
+
+		template <typename It, typename F>
+		void for_each(It first, It last, F f) {
+			size_t n = static_cast<size_t>(last - first);
+			size_t grain = par_detail::grain_for(n, par_detail::min_grain);
+			par_detail::for_each_body<It, F> body(first, f);
+			if (grain == 0)
+				body(0, n);
+			else
+				par_detail::split(body, n, grain);
+		}
+
+		template <typename In, typename Out, typename F>
+		Out transform(In first, In last, Out out, F op) {
+			size_t n = static_cast<size_t>(last - first);
+			size_t grain = par_detail::grain_for(n, par_detail::min_grain);
+			par_detail::transform_body<In, Out, F> body(first, out, op);
+			if (grain == 0)
+				body(0, n);
+			else
+				par_detail::split(body, n, grain);
+			return par_detail::nth(out, n);
+		}
+
+		template <typename In1, typename In2, typename Out, typename F>
+		Out transform(In1 first1, In1 last1, In2 first2, Out out, F op) {
+			size_t n = static_cast<size_t>(last1 - first1);
+			size_t grain = par_detail::grain_for(n, par_detail::min_grain);
+			par_detail::transform2_body<In1, In2, Out, F> body(first1, first2, out, op);
+			if (grain == 0)
+				body(0, n);
+			else
+				par_detail::split(body, n, grain);
+			return par_detail::nth(out, n);
+		}
+
+		// Returns init op x0 op x1 ... op xn-1: init is the leftmost operand,
+		// as in the sequential fold, and the order of the elements is kept, so
+		// op need not be commutative. It must be associative, since pieces are
+		// folded separately and then combined. Besides op(T, element) it is
+		// called as op(element, element) and op(T, T).
+		template <typename It, typename T, typename Op>
+		T reduce(It first, It last, T init, Op op) {
+			size_t n = static_cast<size_t>(last - first);
+			size_t grain = par_detail::grain_for(n, par_detail::min_grain);
+			if (grain == 0) {
+				for (; first != last; ++first)
+					init = op(init, *first);
+				return init;
+			}
+			par_detail::reduce_task<It, T, Op> root(first, n, grain, &op, init);
+			thread_pool::current().run(root);
+			return op(init, root.result);
+		}
+
+		template <typename It, typename T>
+		T reduce(It first, It last, T init) {
+			return par::reduce(first, last, init, std::plus<T>());
+		}
+
+		template <typename It, typename Compare>
+		void sort(It first, It last, Compare comp) {
+			par_detail::merge_sort(first, last, comp, false);
+		}
+
+		template <typename It>
+		void sort(It first, It last) {
+			par::sort(first, last, ft::less<typename iterator_traits<It>::value_type>());
+		}
+
+		template <typename It, typename Compare>
+		void stable_sort(It first, It last, Compare comp) {
+			par_detail::merge_sort(first, last, comp, true);
+		}
+
+		template <typename It>
+		void stable_sort(It first, It last) {
+			par::stable_sort(first, last, ft::less<typename iterator_traits<It>::value_type>());
+		}
+	}
+}
+
+#endif
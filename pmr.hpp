@@ -0,0 +1,583 @@
+#ifndef PMR_HPP
+#define PMR_HPP
+
+#include "allocator_traits.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <pthread.h>
+
+// Allocation strategy chosen at run time instead of in the container type,
+// after C++17's std::pmr. A container over polymorphic_allocator<T> is one
+// type whatever memory_resource it draws from, so the resource can come from
+// configuration:
+//   new_delete_resource()            operator new / delete
+//   null_memory_resource()           throws bad_alloc; for asserting nothing allocates
+//   monotonic_buffer_resource        bump allocation, freed on release() or destruction
+//   unsynchronized_pool_resource     free lists per block size, one thread
+//   synchronized_pool_resource       the same behind a mutex
+// The default resource (new_delete unless set_default_resource() says
+// otherwise) serves default constructed allocators and container copies.
+
+namespace ft {
+namespace pmr {
+
+	class memory_resource {
+		public:
+			static const size_t	max_align = 16;		// what operator new guarantees
+
+			virtual ~memory_resource() {}
+
+			void* allocate(size_t bytes, size_t alignment = max_align) {
+				return do_allocate(bytes, alignment);
+			}
+			void deallocate(void* p, size_t bytes, size_t alignment = max_align) {
+				do_deallocate(p, bytes, alignment);
+			}
+			bool is_equal(const memory_resource& other) const throw() {
+				return do_is_equal(other);
+			}
+
+		private:
+			virtual void*	do_allocate(size_t bytes, size_t alignment) = 0;
+			virtual void	do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+			virtual bool	do_is_equal(const memory_resource& other) const throw() = 0;
+	};
+
+	inline bool operator==(const memory_resource& a, const memory_resource& b) {
+		return &a == &b || a.is_equal(b);
+	}
+
+	inline bool operator!=(const memory_resource& a, const memory_resource& b) {
+		return !(a == b);
+	}
+
+	namespace resource_detail {
+
+		inline size_t align_up(size_t n, size_t align) {
+			return (n + align - 1) & ~(align - 1);
+		}
+
+		inline char* align_up(char* p, size_t align) {
+			return reinterpret_cast<char*>(align_up(reinterpret_cast<size_t>(p), align));
+		}
+
+		// largest power of two dividing n: the alignment every n-byte block of
+		// an aligned array keeps
+		inline size_t lowest_bit(size_t n) {
+			return n & (~n + 1);
+		}
+
+		// memory taken from an upstream resource, with its bookkeeping in a
+		// footer after the caller's bytes so alignment costs nothing extra
+		class upstream_list {
+			private:
+				struct footer {
+					footer*	prev;
+					footer*	next;
+					size_t	bytes;		// whole block, footer included
+					size_t	align;
+				};
+
+				memory_resource*	_upstream;
+				footer*				_head;
+
+				upstream_list(const upstream_list&);
+				upstream_list& operator=(const upstream_list&);
+
+				static size_t footer_offset(size_t bytes) {
+					return align_up(bytes, __alignof__(footer));
+				}
+
+				static char* start_of(footer* f) {
+					return reinterpret_cast<char*>(f) - (f->bytes - sizeof(footer));
+				}
+
+			public:
+				explicit upstream_list(memory_resource* upstream) : _upstream(upstream), _head(NULL) {}
+
+				memory_resource* upstream() const { return _upstream; }
+
+				void* allocate(size_t bytes, size_t align) {
+					if (bytes > std::numeric_limits<size_t>::max() - sizeof(footer) - __alignof__(footer))
+						throw std::bad_alloc();
+					size_t offset = footer_offset(bytes);
+					if (align < __alignof__(footer))
+						align = __alignof__(footer);
+					char* p = static_cast<char*>(_upstream->allocate(offset + sizeof(footer), align));
+					footer* f = reinterpret_cast<footer*>(p + offset);
+					f->prev = NULL;
+					f->next = _head;
+					f->bytes = offset + sizeof(footer);
+					f->align = align;
+					if (_head != NULL)
+						_head->prev = f;
+					_head = f;
+					return p;
+				}
+
+				void deallocate(void* p, size_t bytes) {
+					footer* f = reinterpret_cast<footer*>(static_cast<char*>(p) + footer_offset(bytes));
+					if (f->prev != NULL)
+						f->prev->next = f->next;
+					else
+						_head = f->next;
+					if (f->next != NULL)
+						f->next->prev = f->prev;
+					_upstream->deallocate(p, f->bytes, f->align);
+				}
+
+				void release() {
+					while (_head != NULL) {
+						footer* f = _head;
+						_head = f->next;
+						_upstream->deallocate(start_of(f), f->bytes, f->align);
+					}
+				}
+		};
+	}
+
+	// global resources ===========================================================
+
+	class new_delete_memory_resource : public memory_resource {
+		private:
+			// operator new only knows max_align; stricter requests over-allocate
+			// and keep the original pointer just below the aligned block
+			virtual void* do_allocate(size_t bytes, size_t alignment) {
+				if (alignment <= max_align)
+					return ::operator new(bytes);
+				if (bytes > std::numeric_limits<size_t>::max() - alignment - sizeof(void*))
+					throw std::bad_alloc();
+				char* raw = static_cast<char*>(::operator new(bytes + alignment + sizeof(void*)));
+				char* p = resource_detail::align_up(raw + sizeof(void*), alignment);
+				reinterpret_cast<void**>(p)[-1] = raw;
+				return p;
+			}
+
+			virtual void do_deallocate(void* p, size_t, size_t alignment) {
+				if (alignment <= max_align)
+					::operator delete(p);
+				else
+					::operator delete(static_cast<void**>(p)[-1]);
+			}
+
+			virtual bool do_is_equal(const memory_resource& other) const throw() {
+				return this == &other;
+			}
+	};
+
+	class null_memory_resource_type : public memory_resource {
+		private:
+			virtual void*	do_allocate(size_t, size_t) { throw std::bad_alloc(); }
+			virtual void	do_deallocate(void*, size_t, size_t) {}
+			virtual bool	do_is_equal(const memory_resource& other) const throw() { return this == &other; }
+	};
+
+	inline memory_resource* new_delete_resource() throw() {
+		static new_delete_memory_resource resource;
+		return &resource;
+	}
+
+	inline memory_resource* null_memory_resource() throw() {
+		static null_memory_resource_type resource;
+		return &resource;
+	}
+
+	namespace resource_detail {
+		inline memory_resource*& default_resource() {
+			static memory_resource* resource = new_delete_resource();
+			return resource;
+		}
+	}
+
+	inline memory_resource* get_default_resource() throw() {
+		return __atomic_load_n(&resource_detail::default_resource(), __ATOMIC_ACQUIRE);
+	}
+
+	// NULL restores new_delete_resource(); returns the previous default
+	inline memory_resource* set_default_resource(memory_resource* r) throw() {
+		if (r == NULL)
+			r = new_delete_resource();
+		return __atomic_exchange_n(&resource_detail::default_resource(), r, __ATOMIC_ACQ_REL);
+	}
+
+	// monotonic_buffer_resource ===================================================
+
+	// Hands out memory from a cursor that only moves forward: the caller's
+	// buffer first, then chunks from upstream that double in size.
+	// deallocate() does nothing; release() and the destructor return every
+	// chunk. Not thread safe.
+	class monotonic_buffer_resource : public memory_resource {
+		private:
+			static const size_t	default_initial_size = 1024;
+
+			resource_detail::upstream_list	_chunks;
+			char*							_buffer;
+			size_t							_buffer_size;
+			size_t							_initial_size;
+			size_t							_next_size;
+			char*							_cursor;
+			char*							_end;
+
+			monotonic_buffer_resource(const monotonic_buffer_resource&);
+			monotonic_buffer_resource& operator=(const monotonic_buffer_resource&);
+
+			void grow(size_t bytes, size_t alignment) {
+				if (bytes > std::numeric_limits<size_t>::max() / 2 - alignment)
+					throw std::bad_alloc();
+				size_t size = _next_size > bytes + alignment ? _next_size : bytes + alignment;
+				_cursor = static_cast<char*>(_chunks.allocate(size, max_align));
+				_end = _cursor + size;
+				_next_size = size * 2;
+			}
+
+			virtual void* do_allocate(size_t bytes, size_t alignment) {
+				char* p = _cursor ? resource_detail::align_up(_cursor, alignment) : NULL;
+				if (p == NULL || p > _end || static_cast<size_t>(_end - p) < bytes) {
+					grow(bytes, alignment);
+					p = resource_detail::align_up(_cursor, alignment);
+				}
+				_cursor = p + bytes;
+				return p;
+			}
+
+			virtual void do_deallocate(void*, size_t, size_t) {}
+
+			virtual bool do_is_equal(const memory_resource& other) const throw() {
+				return this == &other;
+			}
+
+		public:
+			explicit monotonic_buffer_resource(memory_resource* upstream = get_default_resource())
+				: _chunks(upstream), _buffer(NULL), _buffer_size(0), _initial_size(default_initial_size),
+				_next_size(default_initial_size), _cursor(NULL), _end(NULL) {}
+
+			monotonic_buffer_resource(size_t initial_size, memory_resource* upstream = get_default_resource())
+				: _chunks(upstream), _buffer(NULL), _buffer_size(0), _initial_size(initial_size ? initial_size : 1),
+				_next_size(_initial_size), _cursor(NULL), _end(NULL) {}
+
+			monotonic_buffer_resource(void* buffer, size_t size, memory_resource* upstream = get_default_resource())
+				: _chunks(upstream), _buffer(static_cast<char*>(buffer)), _buffer_size(size),
+				_initial_size(size ? size : default_initial_size), _next_size(_initial_size),
+				_cursor(_buffer), _end(_buffer + size) {}
+
+			~monotonic_buffer_resource() { release(); }
+
+			void release() {
+				_chunks.release();
+				_cursor = _buffer;
+				_end = _buffer + _buffer_size;
+				_next_size = _initial_size;
+			}
+
+			memory_resource* upstream_resource() const { return _chunks.upstream(); }
+	};
+
+	// pool resources =============================================================
+
+	// zero picks the default
+	struct pool_options {
+		size_t	max_blocks_per_chunk;
+		size_t	largest_required_pool_block;
+
+		pool_options() : max_blocks_per_chunk(0), largest_required_pool_block(0) {}
+	};
+
+	// One pool per block size: 8, 16, 24, 32, 48, 64, 96 .. up to
+	// largest_required_pool_block, so a tree node wastes at most a third of its
+	// block. A pool carves chunks from upstream (16 blocks, doubling up to
+	// max_blocks_per_chunk) and recycles freed blocks through a free list.
+	// Larger requests go straight to upstream. Everything is returned on
+	// release() or destruction. Not thread safe.
+	class unsynchronized_pool_resource : public memory_resource {
+		private:
+			struct pool {
+				size_t	block_size;
+				size_t	next_blocks;	// blocks in the next chunk
+				void*	free_list;
+				char*	cursor;			// unused part of the newest chunk
+				char*	end;
+			};
+
+			static const size_t	max_pools = 48;
+			static const size_t	first_chunk_blocks = 16;
+
+			pool_options					_options;
+			resource_detail::upstream_list	_chunks;
+			pool							_pools[max_pools];
+			size_t							_pool_count;
+
+			unsynchronized_pool_resource(const unsynchronized_pool_resource&);
+			unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&);
+
+			void init(const pool_options& opts) {
+				_options = opts;
+				if (_options.max_blocks_per_chunk == 0)
+					_options.max_blocks_per_chunk = 1024;
+				if (_options.max_blocks_per_chunk < first_chunk_blocks)
+					_options.max_blocks_per_chunk = first_chunk_blocks;
+				if (_options.largest_required_pool_block == 0)
+					_options.largest_required_pool_block = 4096;
+				if (_options.largest_required_pool_block > (size_t(1) << 20))
+					_options.largest_required_pool_block = size_t(1) << 20;
+				_pool_count = 0;
+				for (size_t s = 8; ; s *= 2) {
+					add_pool(s);
+					if (s >= _options.largest_required_pool_block)
+						break;
+					if (s < 16)
+						continue;
+					add_pool(s + s / 2);
+					if (s + s / 2 >= _options.largest_required_pool_block)
+						break;
+				}
+				_options.largest_required_pool_block = _pools[_pool_count - 1].block_size;
+			}
+
+			void add_pool(size_t block_size) {
+				pool& p = _pools[_pool_count++];
+				p.block_size = block_size;
+				reset(p);
+			}
+
+			void reset(pool& p) {
+				p.next_blocks = first_chunk_blocks;
+				p.free_list = NULL;
+				p.cursor = NULL;
+				p.end = NULL;
+			}
+
+			// the smallest pool whose blocks are big and aligned enough; NULL if none
+			pool* pool_for(size_t bytes, size_t alignment) {
+				if (bytes > _options.largest_required_pool_block)
+					return NULL;
+				for (size_t i = 0; i < _pool_count; i++)
+					if (_pools[i].block_size >= bytes && resource_detail::lowest_bit(_pools[i].block_size) >= alignment)
+						return &_pools[i];
+				return NULL;
+			}
+
+			void refill(pool& p) {
+				size_t bytes = p.block_size * p.next_blocks;
+				p.cursor = static_cast<char*>(_chunks.allocate(bytes, resource_detail::lowest_bit(p.block_size)));
+				p.end = p.cursor + bytes;
+				if (p.next_blocks < _options.max_blocks_per_chunk)
+					p.next_blocks *= 2;
+				if (p.next_blocks > _options.max_blocks_per_chunk)
+					p.next_blocks = _options.max_blocks_per_chunk;
+			}
+
+			virtual void* do_allocate(size_t bytes, size_t alignment) {
+				pool* p = pool_for(bytes, alignment);
+				if (p == NULL)
+					return _chunks.allocate(bytes, alignment);
+				if (p->free_list != NULL) {
+					void* block = p->free_list;
+					p->free_list = *static_cast<void**>(block);
+					return block;
+				}
+				if (p->cursor == p->end)
+					refill(*p);
+				void* block = p->cursor;
+				p->cursor += p->block_size;
+				return block;
+			}
+
+			virtual void do_deallocate(void* block, size_t bytes, size_t alignment) {
+				pool* p = pool_for(bytes, alignment);
+				if (p == NULL) {
+					_chunks.deallocate(block, bytes);
+					return;
+				}
+				*static_cast<void**>(block) = p->free_list;
+				p->free_list = block;
+			}
+
+			virtual bool do_is_equal(const memory_resource& other) const throw() {
+				return this == &other;
+			}
+
+		public:
+			explicit unsynchronized_pool_resource(memory_resource* upstream = get_default_resource())
+				: _chunks(upstream) {
+				init(pool_options());
+			}
+
+			unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream = get_default_resource())
+				: _chunks(upstream) {
+				init(opts);
+			}
+
+			~unsynchronized_pool_resource() { release(); }
+
+			void release() {
+				_chunks.release();
+				for (size_t i = 0; i < _pool_count; i++)
+					reset(_pools[i]);
+			}
+
+			memory_resource*	upstream_resource() const { return _chunks.upstream(); }
+			pool_options		options() const { return _options; }
+	};
+
+	// unsynchronized_pool_resource behind one mutex, for containers shared
+	// between threads or a resource shared by per-thread containers
+	class synchronized_pool_resource : public memory_resource {
+		private:
+			class lock {
+				private:
+					pthread_mutex_t&	_mutex;
+
+					lock(const lock&);
+					lock& operator=(const lock&);
+
+				public:
+					explicit lock(pthread_mutex_t& mutex) : _mutex(mutex) { pthread_mutex_lock(&_mutex); }
+					~lock() { pthread_mutex_unlock(&_mutex); }
+			};
+
+			mutable pthread_mutex_t			_mutex;
+			unsynchronized_pool_resource	_pool;
+
+			synchronized_pool_resource(const synchronized_pool_resource&);
+			synchronized_pool_resource& operator=(const synchronized_pool_resource&);
+
+			virtual void* do_allocate(size_t bytes, size_t alignment) {
+				lock guard(_mutex);
+				return _pool.allocate(bytes, alignment);
+			}
+
+			virtual void do_deallocate(void* p, size_t bytes, size_t alignment) {
+				lock guard(_mutex);
+				_pool.deallocate(p, bytes, alignment);
+			}
+
+			virtual bool do_is_equal(const memory_resource& other) const throw() {
+				return this == &other;
+			}
+
+		public:
+			explicit synchronized_pool_resource(memory_resource* upstream = get_default_resource())
+				: _pool(upstream) {
+				pthread_mutex_init(&_mutex, NULL);
+			}
+
+			synchronized_pool_resource(const pool_options& opts, memory_resource* upstream = get_default_resource())
+				: _pool(opts, upstream) {
+				pthread_mutex_init(&_mutex, NULL);
+			}
+
+			~synchronized_pool_resource() {
+				release();
+				pthread_mutex_destroy(&_mutex);
+			}
+
+			void release() {
+				lock guard(_mutex);
+				_pool.release();
+			}
+
+			memory_resource*	upstream_resource() const { return _pool.upstream_resource(); }
+			pool_options		options() const { return _pool.options(); }
+	};
+
+	// polymorphic_allocator ======================================================
+
+	// Allocates from a memory_resource* chosen at construction; copies and
+	// rebinds share it. Nothing propagates on assignment or swap, and a
+	// container's copy constructor gets the default resource, not the source's.
+	template <typename T>
+	class polymorphic_allocator {
+		public:
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef const T*	const_pointer;
+			typedef T&			reference;
+			typedef const T&	const_reference;
+			typedef size_t		size_type;
+			typedef ptrdiff_t	difference_type;
+
+			template <typename U>
+			struct rebind { typedef polymorphic_allocator<U> other; };
+
+		private:
+			memory_resource*	_resource;
+
+		public:
+			polymorphic_allocator() throw() : _resource(get_default_resource()) {}
+			polymorphic_allocator(memory_resource* r) throw() : _resource(r) {}
+			polymorphic_allocator(const polymorphic_allocator& other) throw() : _resource(other._resource) {}
+			template <typename U>
+			polymorphic_allocator(const polymorphic_allocator<U>& other) throw() : _resource(other.resource()) {}
+			~polymorphic_allocator() throw() {}
+
+			polymorphic_allocator& operator=(const polymorphic_allocator& other) throw() {
+				_resource = other._resource;
+				return *this;
+			}
+
+			memory_resource*	resource() const { return _resource; }
+
+			polymorphic_allocator select_on_container_copy_construction() const {
+				return polymorphic_allocator();
+			}
+
+			pointer			address(reference x) const { return &x; }
+			const_pointer	address(const_reference x) const { return &x; }
+
+			pointer allocate(size_type n, const void* hint = 0) {
+				(void)hint;
+				if (n > max_size())
+					throw std::bad_alloc();
+				return static_cast<pointer>(_resource->allocate(n * sizeof(T), __alignof__(T)));
+			}
+
+			void deallocate(pointer p, size_type n) {
+				if (p != NULL)
+					_resource->deallocate(p, n * sizeof(T), __alignof__(T));
+			}
+
+			size_type max_size() const throw() {
+				return std::numeric_limits<size_type>::max() / sizeof(T);
+			}
+
+			void construct(pointer p, const_reference val) { ::new (static_cast<void*>(p)) T(val); }
+			void destroy(pointer p) { p->~T(); }
+	};
+
+	template <typename T, typename U>
+	bool operator==(const polymorphic_allocator<T>& a, const polymorphic_allocator<U>& b) {
+		return *a.resource() == *b.resource();
+	}
+
+	template <typename T, typename U>
+	bool operator!=(const polymorphic_allocator<T>& a, const polymorphic_allocator<U>& b) {
+		return !(a == b);
+	}
+
+	// containers =================================================================
+	// C++98 has no alias templates: ft::pmr::map<K, V>::type is
+	// ft::map<K, V, ft::less<K>, polymorphic_allocator<ft::pair<const K, V> > >.
+
+	template <typename T>
+	struct vector {
+		typedef ft::vector<T, polymorphic_allocator<T> >	type;
+	};
+
+	template <typename Key, typename T, typename Compare = ft::less<Key> >
+	struct map {
+		typedef ft::map<Key, T, Compare, polymorphic_allocator<ft::pair<const Key, T> > >	type;
+	};
+
+	template <typename Key, typename Compare = ft::less<Key> >
+	struct set {
+		typedef ft::set<Key, Compare, polymorphic_allocator<Key> >	type;
+	};
+}
+}
+
+#endif
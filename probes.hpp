@@ -0,0 +1,83 @@
+#ifndef PROBES_HPP
+#define PROBES_HPP
+
+// Static tracepoints on the container hot paths, for attaching bpftrace or
+// perf to a running process. Off unless built with -DFT_CONTAINERS_PROBES;
+// then every FT_PROBEn expands to nothing and costs nothing.
+//
+// With <sys/sdt.h> (systemtap-sdt-dev) the probes are USDT notes of provider
+// ft_containers: a nop at the site, the arguments described in .note.stapsdt.
+//   bpftrace -e 'usdt:./prog:ft_containers:vector_reserve { @bytes = sum(arg3); }'
+// Without the header each probe is a call to an empty, never inlined
+// function ft_probe_<name> taking the same arguments, for uprobes:
+//   bpftrace -e 'uprobe:./prog:ft_probe_vector_reserve { @bytes = sum(arg3); }'
+//
+// probe				arguments
+// vector_reserve		vector*, old capacity, new capacity, bytes copied
+// tree_insert			tree*, size after, 1 if inserted / 0 if the key existed
+// tree_erase			tree*, size after
+// tree_clear			tree*, size before
+// tree_node_alloc		tree*, node*, node size in bytes
+// tree_node_free		tree*, node*
+
+#ifdef FT_CONTAINERS_PROBES
+
+# if defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#   define FT_PROBES_SDT 1
+#  endif
+# endif
+
+# ifdef FT_PROBES_SDT
+#  include <sys/sdt.h>
+#  define FT_PROBE2(name, a1, a2)			DTRACE_PROBE2(ft_containers, name, a1, a2)
+#  define FT_PROBE3(name, a1, a2, a3)		DTRACE_PROBE3(ft_containers, name, a1, a2, a3)
+#  define FT_PROBE4(name, a1, a2, a3, a4)	DTRACE_PROBE4(ft_containers, name, a1, a2, a3, a4)
+# else
+
+namespace ft {
+	template <typename T>
+	inline unsigned long probe_arg(const T& v) { return static_cast<unsigned long>(v); }
+
+	template <typename T>
+	inline unsigned long probe_arg(T* p) { return reinterpret_cast<unsigned long>(p); }
+}
+
+// noclone keeps GCC from specialising the function on constant arguments
+// under another symbol name; the asm keeps the call and its arguments alive.
+#  if defined(__clang__)
+#   define FT_PROBE_ATTRIBUTES __attribute__((noinline, used))
+#  else
+#   define FT_PROBE_ATTRIBUTES __attribute__((noinline, noclone, used))
+#  endif
+
+#  define FT_DEFINE_PROBE(name) \
+	extern "C" inline FT_PROBE_ATTRIBUTES void ft_probe_##name(unsigned long a1, unsigned long a2, \
+		unsigned long a3, unsigned long a4) { \
+		__asm__ __volatile__("" : : "r"(a1), "r"(a2), "r"(a3), "r"(a4) : "memory"); \
+	}
+
+FT_DEFINE_PROBE(vector_reserve)
+FT_DEFINE_PROBE(tree_insert)
+FT_DEFINE_PROBE(tree_erase)
+FT_DEFINE_PROBE(tree_clear)
+FT_DEFINE_PROBE(tree_node_alloc)
+FT_DEFINE_PROBE(tree_node_free)
+
+#  undef FT_DEFINE_PROBE
+
+#  define FT_PROBE2(name, a1, a2) \
+	ft_probe_##name(ft::probe_arg(a1), ft::probe_arg(a2), 0, 0)
+#  define FT_PROBE3(name, a1, a2, a3) \
+	ft_probe_##name(ft::probe_arg(a1), ft::probe_arg(a2), ft::probe_arg(a3), 0)
+#  define FT_PROBE4(name, a1, a2, a3, a4) \
+	ft_probe_##name(ft::probe_arg(a1), ft::probe_arg(a2), ft::probe_arg(a3), ft::probe_arg(a4))
+# endif
+
+#else
+# define FT_PROBE2(name, a1, a2)			((void)0)
+# define FT_PROBE3(name, a1, a2, a3)		((void)0)
+# define FT_PROBE4(name, a1, a2, a3, a4)	((void)0)
+#endif
+
+#endif
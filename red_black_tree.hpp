@@ -6,12 +6,27 @@
 #include "iterator.hpp"
 #include "reverse_iterator.hpp"
 #include "enable_if.hpp"
+#include "tree_stats.hpp"
+#include "memory_usage.hpp"
+#include "probes.hpp"
+#include "allocator_traits.hpp"
+#include <algorithm>
+#include <cassert>
 #include <memory>
 
+// FT_RB_TREE_VERIFY 를 정의하고 빌드하면 삽입/삭제마다 verify() 로 불변식을
+// 전부 검사한다 (O(n)). 디버그 전용.
+#ifdef FT_RB_TREE_VERIFY
+# define FT_RB_TREE_CHECK() assert(verify())
+#else
+# define FT_RB_TREE_CHECK() ((void)0)
+#endif
+
 namespace ft{
 
-	template <typename T, typename Compare, typename Alloc = std::allocator<T> >
-	class red_black_tree {
+	// Stats 가 true 면 회전/재색칠/비교 횟수를 연산 종류별로 센다 (tree_stats.hpp).
+	template <typename T, typename Compare, typename Alloc = std::allocator<T>, bool Stats = false>
+	class red_black_tree : private tree_stats_recorder<Stats> {
 
 	// typedefs =========================================================================================
 	
@@ -34,6 +49,8 @@ namespace ft{
 			typedef ft::tree_const_iterator<value_type>					const_iterator;
 			typedef ft::reverse_iterator<iterator>						reverse_iterator;
 			typedef ft::reverse_iterator<const_iterator>				const_reverse_iterator;
+			typedef node_alloc_type										node_allocator_type;
+			typedef ft::tree_stats										stats_type;
 
 	// ==================================================================================================
 
@@ -46,14 +63,19 @@ namespace ft{
 			node_alloc_type	_node_alloc;
 			node_ptr		_head_node;
 			size_type		_size;
+			node_ptr		_spare;			// 값을 파괴한 채 보관 중인 노드들, parent 로 연결
+			size_type		_spare_count;
 
 		public :
-			red_black_tree(value_compare const& comp, allocator_type const& alloc, node_alloc_type const& node_alloc = node_alloc_type())
-				: _comp(comp), _alloc(alloc), _node_alloc(node_alloc), _head_node(NULL), _size(0) {
+			// 노드 할당자는 alloc 을 rebind 해 만든다. 상태(아레나, 카운터)를 그대로 공유한다.
+			red_black_tree(value_compare const& comp, allocator_type const& alloc)
+				: _comp(comp), _alloc(alloc), _node_alloc(alloc), _head_node(NULL), _size(0), _spare(NULL), _spare_count(0) {
 				_head_node = _node_alloc.allocate(1);
 				_node_alloc.construct(_head_node, node_type());
 			}
-			red_black_tree(const red_black_tree& x) : _comp(x._comp), _alloc(x._alloc), _node_alloc(x._node_alloc), _head_node(NULL), _size(0) {
+			red_black_tree(const red_black_tree& x) : tree_stats_recorder<Stats>(x), _comp(x._comp),
+				_alloc(allocator_traits<allocator_type>::select_on_container_copy_construction(x._alloc)),
+				_node_alloc(_alloc), _head_node(NULL), _size(0), _spare(NULL), _spare_count(0) {
 				_head_node = _node_alloc.allocate(1);
 				_node_alloc.construct(_head_node, node_type());
 				if(x.get_root() != NULL){
@@ -66,18 +88,35 @@ namespace ft{
 				if (this == &x) {
 					return *this;
 				}
-				clear();
 				_comp = x._comp;
-				_alloc = x._alloc;
-				_node_alloc = x._node_alloc;
+				if (!ft::allocator_propagates_on_copy(_alloc, x._alloc)) {
+					// 기존 노드는 해제하지 않고 여분 목록에 넣어 copy_tree 가 다시 쓴다.
+					// 남는 노드만 복사가 끝난 뒤 해제한다.
+					clear(true);
+				}
+				else {
+					// 헤드 노드도 지금 할당자에서 받은 것이므로 새 할당자로 바꿔 받는다.
+					clear();
+					node_alloc_type	node_alloc(x._alloc);
+					node_ptr		head = node_alloc.allocate(1);
+					node_alloc.construct(head, node_type());
+					_node_alloc.destroy(_head_node);
+					_node_alloc.deallocate(_head_node, 1);
+					_head_node = head;
+					_alloc = x._alloc;
+					_node_alloc = node_alloc;
+				}
 				if(x.get_root() != NULL){
 					copy_tree(x.get_root());
 				}
 				_size = x._size;
+				release_spare();
 				return *this;
 			}
 
 			virtual ~red_black_tree() {
+				if (destruction_is_trivial<node_alloc_type, value_type>::value)
+					return;
 				clear();
 				_node_alloc.destroy(_head_node);
 				_node_alloc.deallocate(_head_node, 1);
@@ -120,21 +159,134 @@ namespace ft{
 				}
 			}
 
-			void delete_tree(node_ptr node){
+			// 값 노드의 할당/해제는 모두 여기를 거친다 (probes.hpp 의 tree_node_alloc / tree_node_free).
+			// 여분 노드가 있으면 할당자 대신 그것을 꺼내 쓴다.
+			node_ptr allocate_node(){
+				if (_spare != NULL) {
+					node_ptr node = _spare;
+					_spare = node->parent;
+					_spare_count--;
+					return node;
+				}
+				node_ptr node = _node_alloc.allocate(1);
+				FT_PROBE3(tree_node_alloc, this, node, sizeof(node_type));
+				return node;
+			}
+
+			void deallocate_node(node_ptr node){
+				FT_PROBE2(tree_node_free, this, node);
+				_node_alloc.deallocate(node, 1);
+			}
+
+			// 값이 이미 파괴된 노드를 여분 목록에 넣는다
+			void recycle_node(node_ptr node){
+				node->parent = _spare;
+				_spare = node;
+				_spare_count++;
+			}
+
+			void release_spare(){
+				while (_spare != NULL) {
+					node_ptr next = _spare->parent;
+					deallocate_node(_spare);
+					_spare = next;
+				}
+				_spare_count = 0;
+			}
+
+			node_ptr create_node(const value_type& val, Color color){
+				node_ptr node = allocate_node();
+				try {
+					_alloc.construct(&node->value, val);
+				} catch (...) {
+					deallocate_node(node);
+					throw;
+				}
+				node->color = color;
+				node->left = NULL;
+				node->right = NULL;
+				node->parent = NULL;
+				return node;
+			}//create_node
+
+			// 후위 순회로 해제한다. 재귀도 스택도 없이 부모 포인터로 올라가고,
+			// 해제한 자식의 링크는 끊어 두어 각 간선을 한 번씩만 오르내린다. O(n)
+			// keep_nodes 면 값만 파괴하고 노드는 여분 목록에 넣는다.
+			void delete_tree(node_ptr node, bool keep_nodes){
 				if (node == NULL)
 					return;
-				delete_tree(node->left);
-				delete_tree(node->right);
-				_node_alloc.destroy(node);
-				_node_alloc.deallocate(node, 1);
+				node_ptr stop = node->parent;
+				while (node != stop) {
+					if (node->left != NULL)
+						node = node->left;
+					else if (node->right != NULL)
+						node = node->right;
+					else {
+						node_ptr parent = node->parent;
+						if (parent != stop) {
+							if (parent->left == node)
+								parent->left = NULL;
+							else
+								parent->right = NULL;
+						}
+						_node_alloc.destroy(node);
+						if (keep_nodes)
+							recycle_node(node);
+						else
+							deallocate_node(node);
+						node = parent;
+					}
+				}
 			}//delete_tree
 
-			void copy_tree(node_ptr node){
-				if (node == NULL)
+			// 모양과 색을 그대로 복제한다. 비교도 재균형도 없는 O(n), 역시 반복문으로.
+			// 원본 노드를 읽은 김에 두 자식을 함께 복제하고 왼쪽부터 내려간다.
+			void copy_tree(node_ptr src){
+				if (src == NULL)
 					return;
-				insert_value(node->value);
-				copy_tree(node->left);
-				copy_tree(node->right);
+				try {
+					node_ptr dst = create_node(src->value, src->color);
+					node_ptr s = src;
+					set_root(dst);
+					_size = 1;
+					while (true) {
+						if (s->left != NULL) {
+							dst->left = create_node(s->left->value, s->left->color);
+							dst->left->parent = dst;
+							_size++;
+						}
+						if (s->right != NULL) {
+							dst->right = create_node(s->right->value, s->right->color);
+							dst->right->parent = dst;
+							_size++;
+						}
+						if (s->left != NULL) {
+							s = s->left;
+							dst = dst->left;
+							continue;
+						}
+						if (s->right != NULL) {
+							s = s->right;
+							dst = dst->right;
+							continue;
+						}
+						while (s != src) {
+							node_ptr child = s;
+							s = s->parent;
+							dst = dst->parent;
+							if (child == s->left && s->right != NULL) {
+								s = s->right;
+								dst = dst->right;
+								break;
+							}
+						}
+						if (s == src)
+							break;
+					}
+				} catch (...) {
+					clear();
+					throw;
+				}
 			}//copy_tree
 
 			void rotate_left(node_ptr node){
@@ -142,6 +294,7 @@ namespace ft{
 
 				if (right_child == NULL)//오른쪽 자식이 null인지 확인합니다. 만약 그렇다면, 그 기능은 아무것도 하지 않고 돌아온다.
 					return;
+				this->count_rotation();
 				node->right = right_child->left;
 				if (node->right != NULL)
 					node->right->parent = node;// 오른쪽 하위노드에 대한 상위 및 하위 포인터를 업데이트하여 오른쪽 하위노드가 회전할 노드의 새 상위노드가 되도록 합니다.
@@ -161,6 +314,7 @@ namespace ft{
 
 				if (left_child == NULL)
 					return;
+				this->count_rotation();
 				node->left = left_child->right;
 				if (node->left != NULL)
 					node->left->parent = node;
@@ -232,8 +386,27 @@ namespace ft{
 			void set_color(node_ptr node, Color color){
 				if(node == NULL)
 					return;
+				if (node->color != color)
+					this->count_recoloring(1);
 				node->color = color;
 			}
+
+			void swap_color(node_ptr a, node_ptr b){
+				if (a->color != b->color)
+					this->count_recoloring(2);
+				std::swap(a->color, b->color);
+			}
+
+			bool compare_less(const value_type& a, const value_type& b) const {
+				this->count_comparison();
+				return _comp(a, b);
+			}
+
+			template <typename KeyValueCompare, typename A, typename B>
+			bool compare_less(KeyValueCompare& comp, const A& a, const B& b) const {
+				this->count_comparison();
+				return comp(a, b);
+			}
 	// ==================================================================================================
 
 	// capacity =========================================================================================
@@ -261,18 +434,18 @@ namespace ft{
 					return ft::make_pair(iterator(node), true);
 				}
 				while (tmp) {
-					if (_comp(node->value, tmp->value)) {
+					if (compare_less(node->value, tmp->value)) {
 						parent = tmp;
 						tmp = tmp->left;
 					}
-					else if (_comp(tmp->value, node->value)) {
+					else if (compare_less(tmp->value, node->value)) {
 						parent = tmp;
 						tmp = tmp->right;
 					}
 					else
 						return ft::make_pair(iterator(tmp), false);
 				}
-				if (_comp(parent->value, node->value)) {
+				if (compare_less(parent->value, node->value)) {
 					parent->right = node;
 					node->parent = parent;
 				} else {
@@ -283,18 +456,24 @@ namespace ft{
 			}
 
 			pair<iterator, bool> insert_value(const value_type& val){
-				node_ptr node = _node_alloc.allocate(1);
-
-				_node_alloc.construct(node, node_type(val));
+				this->stats_begin(tree_insert_op);
+				bool reused = _spare != NULL;
+				node_ptr node = create_node(val, RED);
 				pair<iterator, bool> ret = insert_node(node);
 				if(ret.second == true){
 					_size++;
 					insert_fixup(node);
+					FT_RB_TREE_CHECK();
 				}
 				else{
+					// 여분 목록에서 꺼낸 노드는 다시 돌려놓는다
 					_node_alloc.destroy(node);
-					_node_alloc.deallocate(node, 1);
+					if (reused)
+						recycle_node(node);
+					else
+						deallocate_node(node);
 				}
+				FT_PROBE3(tree_insert, this, _size, ret.second);
 				return ret;
 			}
 			void insert_fixup(node_ptr node) {
@@ -332,7 +511,7 @@ namespace ft{
 							if (parent == grand_parent->right) {
 								rotate_left(grand_parent);
 							}
-							std::swap(parent->color, grand_parent->color);
+							swap_color(parent, grand_parent);
 							node = parent;
 						}
 					} else if (parent == grand_parent->right) {
@@ -355,7 +534,7 @@ namespace ft{
 							if (parent == grand_parent->right) {
 								rotate_left(grand_parent);
 							}
-							std::swap(parent->color, grand_parent->color);
+							swap_color(parent, grand_parent);
 							node = parent;
 						}
 					}
@@ -380,11 +559,61 @@ namespace ft{
 					insert(*it);
 				}
 			}
+
+			// 키로 자리를 먼저 찾고, 키가 없을 때만 노드를 할당해 값을 그 자리에 생성한다.
+			// comp 는 (key, value) / (value, key) 양쪽 순서를 모두 받는다.
+			template <typename K, typename KeyValueCompare, typename Constructor>
+			pair<iterator, bool> emplace_unique(const K& k, KeyValueCompare comp, Constructor construct){
+				node_ptr parent = NULL;
+				node_ptr tmp = get_root();
+				bool is_left = true;
+
+				this->stats_begin(tree_insert_op);
+				while (tmp) {
+					if (compare_less(comp, k, tmp->value)) {
+						parent = tmp;
+						tmp = tmp->left;
+						is_left = true;
+					}
+					else if (compare_less(comp, tmp->value, k)) {
+						parent = tmp;
+						tmp = tmp->right;
+						is_left = false;
+					}
+					else {
+						FT_PROBE3(tree_insert, this, _size, false);
+						return ft::make_pair(iterator(tmp), false);
+					}
+				}
+				node_ptr node = allocate_node();
+				try {
+					construct(&node->value);
+				} catch (...) {
+					deallocate_node(node);
+					throw;
+				}
+				node->color = RED;
+				node->left = NULL;
+				node->right = NULL;
+				node->parent = parent;
+				if (parent == NULL)
+					set_root(node);
+				else if (is_left)
+					parent->left = node;
+				else
+					parent->right = node;
+				_size++;
+				insert_fixup(node);
+				FT_RB_TREE_CHECK();
+				FT_PROBE3(tree_insert, this, _size, true);
+				return ft::make_pair(iterator(node), true);
+			}
 		
 
 	// erase ============================================================================================
 			void erase(const_iterator position){
-				delete_value(*position);
+				this->stats_begin(tree_erase_op);
+				erase_node(position.base());
 			}
 
 			size_type erase(const value_type& val){
@@ -398,152 +627,188 @@ namespace ft{
 			}
 
 			size_t delete_value(const value_type& val){
-				node_ptr node = delete_node(get_root(), val);
-				if(node == NULL)
+				this->stats_begin(tree_erase_op);
+				node_ptr node = find_node(val);
+				if (node == NULL)
 					return 0;
-				delete_fixup(node);
-				_size--;
+				erase_node(node);
 				return 1;
 			}
 
-			node_ptr delete_node(node_ptr node, const value_type& val){
+			// 키로 찾아 지운다. 탐색 비교도 erase 통계에 들어간다.
+			template <typename K, typename KeyValueCompare>
+			size_type erase_key(const K& k, KeyValueCompare comp){
+				this->stats_begin(tree_erase_op);
+				node_ptr node = find_key_node(k, comp);
 				if (node == NULL)
-					return node;
-				if (_comp(node->value, val))
-					return delete_node(node->right, val);
-				if (_comp(val, node->value))
-					return delete_node(node->left, val);
-				if (node->left == NULL || node->right == NULL)
-					return node;
+					return 0;
+				erase_node(node);
+				return 1;
+			}
 
-				node_ptr tmp = min_value_node(node->right);
-				if (tmp->parent == node) {
-					if (node->parent && node->parent->left == node)
-						node->parent->left = tmp;
-					if (node->parent && node->parent->right == node)
-						node->parent->right = tmp;
-					tmp->left = node->left;
-					node->left->parent = tmp;
-					node->left = NULL;
-					tmp->parent = node->parent;
-					node->parent = tmp;
-					node->right = tmp->right;
-					tmp->right = node;
-					std::swap(tmp->color, node->color);
-				} else {
-					if (node->parent && node->parent->left == node)
-						node->parent->left = tmp;
-					if (node->parent && node->parent->right == node)
-						node->parent->right = tmp;
-					if (tmp->parent->left == tmp)
-						tmp->parent->left = node;
-					if (tmp->parent->right == tmp)
-						tmp->parent->right = node;
-					node_ptr tmp2 = tmp->parent;
-					node->right->parent = tmp;
-					tmp->parent = node->parent;
-					node->parent = tmp2;
-					tmp->left = node->left;
-					node->left->parent = tmp;
-					node->left = NULL;
-					tmp2 = tmp->right;
-					tmp->right = node->right;
-					node->right = tmp2;
-					std::swap(tmp->color, node->color);
-				}
-				return delete_node(tmp->right, val);
-			}
-
-			void delete_fixup(node_ptr node){
-				if (node == NULL)
-					return;
-				if (node == get_root()) {//root delete fixup
-					if (node->right)
-						set_root(node->right);
-					else
-						set_root(node->left);
-						_node_alloc.destroy(node);
-						_node_alloc.deallocate(node, 1);
-						set_color(get_root(), BLACK);
-					return;
+		private:
+			void erase_node(node_ptr node){
+				unlink_node(node);
+				_node_alloc.destroy(node);
+				deallocate_node(node);
+				_size--;
+				FT_RB_TREE_CHECK();
+				FT_PROBE2(tree_erase, this, _size);
+			}
+
+		public:
+
+	// ==================================================================================================
+
+	// node handles =====================================================================================
+	// 노드를 해제하지 않고 트리에서 떼어내거나(extract) 다시 붙인다(reinsert).
+	// 값은 복사되지 않고 노드 자체가 옮겨지므로 할당도 일어나지 않는다.
+
+			node_ptr extract_node(const_iterator position){
+				node_ptr node = position.base();
+				this->stats_begin(tree_erase_op);
+				unlink_node(node);
+				_size--;
+				FT_RB_TREE_CHECK();
+				node->left = NULL;
+				node->right = NULL;
+				node->parent = NULL;
+				return node;
+			}
+
+			// on failure the node is left untouched and still owned by the caller
+			pair<iterator, bool> reinsert_node(node_ptr node){
+				node->left = NULL;
+				node->right = NULL;
+				node->parent = NULL;
+				node->color = RED;
+				this->stats_begin(tree_insert_op);
+				pair<iterator, bool> ret = insert_node(node);
+				if (ret.second == true){
+					_size++;
+					insert_fixup(node);
+					FT_RB_TREE_CHECK();
 				}
-				if (get_color(node) == RED || get_color(node->left) == RED|| get_color(node->right) == RED) {
-					node_ptr child = node->left != NULL ? node->left : node->right;
+				return ret;
+			}
 
-					if (node == node->parent->left)
-						node->parent->left = child;
-					else
-						node->parent->right = child;
-					if (child != NULL)
-						child->parent = node->parent;
-					set_color(child, BLACK);
-					_node_alloc.destroy(node);
-					_node_alloc.deallocate(node, 1);
-					return;//delete red node 
-				}
-				node_ptr s = NULL;
-				node_ptr p = NULL;
-				node_ptr tmp = node;
-				set_color(tmp, DUB_BLACK);
-				while (tmp != get_root() && get_color(tmp) == DUB_BLACK) {
-					p = tmp->parent;
-					s = (tmp == p->left) ? p->right : p->left;
-					if (get_color(s) == RED){//case 1
-						set_color(s, BLACK);
-						set_color(p, RED);
-						if (s == p->right)
-							rotate_left(p);
-						if (s == p->left)
-							rotate_right(p);
-					}
-					else if (get_color(s->left) == BLACK && get_color(s->right) == BLACK){
-						set_color(s, RED);
-						if (get_color(p) == RED)
-							set_color(p, BLACK);
-						else
-							set_color(p, DUB_BLACK);
-						tmp = p;//case 2
+			allocator_type get_allocator() const {
+				return _alloc;
+			}
+
+			node_alloc_type get_node_allocator() const {
+				return _node_alloc;
+			}
+
+	// ==================================================================================================
+
+	// unlink ===========================================================================================
+		private:
+			void replace_child(node_ptr old_child, node_ptr new_child){
+				node_ptr parent = get_parent(old_child);
+				if (parent == NULL)
+					set_root(new_child);
+				else if (old_child == parent->left)
+					parent->left = new_child;
+				else
+					parent->right = new_child;
+				if (new_child != NULL && parent != NULL)
+					new_child->parent = parent;
+			}
+
+			// 노드를 트리에서 분리한다. 자식이 둘이면 값을 옮기지 않고 후속 노드를
+			// 그 자리에 연결하므로, 다른 원소를 가리키는 iterator는 그대로 유효하다.
+			void unlink_node(node_ptr node){
+				node_ptr child;
+				node_ptr child_parent;
+
+				if (node->left == NULL || node->right == NULL) {
+					child = node->left != NULL ? node->left : node->right;
+					child_parent = get_parent(node);
+					replace_child(node, child);
+				} else {
+					node_ptr next = min_value_node(node->right);
+					child = next->right;
+					if (next->parent == node) {
+						child_parent = next;
+					} else {
+						child_parent = next->parent;
+						child_parent->left = child;
+						if (child != NULL)
+							child->parent = child_parent;
+						next->right = node->right;
+						node->right->parent = next;
 					}
-					else {
-						if ((tmp == p->left && get_color(s->right) == BLACK) 
-						|| (tmp == p->right && get_color(s->left) == BLACK)){
-							if (s == p->right) {
-								set_color(s->left, BLACK);
-								set_color(s, RED);
-								rotate_right(s);
-								s = p->right;
-							}
-							if (s == p->left) {
-								set_color(s->right, BLACK);
-								set_color(s, RED);
-								rotate_left(s);
-								s = p->left;
+					next->left = node->left;
+					node->left->parent = next;
+					replace_child(node, next);
+					swap_color(next, node);
+				}
+				if (node->color == BLACK)
+					erase_fixup(child, child_parent);
+			}
+
+			// child는 제거된 자리를 물려받은 노드(NULL일 수 있음)이고, 그 경로에
+			// 검은 노드가 하나 부족하다.
+			void erase_fixup(node_ptr child, node_ptr parent){
+				while (child != get_root() && get_color(child) == BLACK) {
+					if (child == parent->left) {
+						node_ptr sibling = parent->right;
+						if (get_color(sibling) == RED) {
+							set_color(sibling, BLACK);
+							set_color(parent, RED);
+							rotate_left(parent);
+							sibling = parent->right;
+						}
+						if (get_color(sibling->left) == BLACK && get_color(sibling->right) == BLACK) {
+							set_color(sibling, RED);
+							child = parent;
+							parent = get_parent(child);
+						} else {
+							if (get_color(sibling->right) == BLACK) {
+								set_color(sibling->left, BLACK);
+								set_color(sibling, RED);
+								rotate_right(sibling);
+								sibling = parent->right;
 							}
+							set_color(sibling, get_color(parent));
+							set_color(parent, BLACK);
+							set_color(sibling->right, BLACK);
+							rotate_left(parent);
+							child = get_root();
 						}
-						if (s == p->right) {
-							set_color(s, get_color(p));
-							set_color(p, BLACK);
-							set_color(s->right, BLACK);
-							rotate_left(p);
+					} else {
+						node_ptr sibling = parent->left;
+						if (get_color(sibling) == RED) {
+							set_color(sibling, BLACK);
+							set_color(parent, RED);
+							rotate_right(parent);
+							sibling = parent->left;
 						}
-						if (s == p->left) {
-							set_color(s, get_color(p));
-							set_color(p, BLACK);
-							set_color(s->left, BLACK);
-							rotate_right(p);
+						if (get_color(sibling->left) == BLACK && get_color(sibling->right) == BLACK) {
+							set_color(sibling, RED);
+							child = parent;
+							parent = get_parent(child);
+						} else {
+							if (get_color(sibling->left) == BLACK) {
+								set_color(sibling->right, BLACK);
+								set_color(sibling, RED);
+								rotate_left(sibling);
+								sibling = parent->left;
+							}
+							set_color(sibling, get_color(parent));
+							set_color(parent, BLACK);
+							set_color(sibling->left, BLACK);
+							rotate_right(parent);
+							child = get_root();
 						}
-						break;
 					}
 				}
-				if (node == node->parent->left)
-					node->parent->left = NULL;
-				else
-					node->parent->right = NULL;
-				_node_alloc.destroy(node);
-				_node_alloc.deallocate(node, 1);
-				set_color(get_root(), BLACK);
+				set_color(child, BLACK);
 			}
-			
+		public:
+
+	// ==================================================================================================
 
 	// swap =============================================================================================
 
@@ -552,55 +817,136 @@ namespace ft{
 					return;
 				}
 				value_compare	tmp_comp = ref._comp;
-				allocator_type	tmp_alloc = ref._alloc;
-				node_alloc_type	tmp_node_alloc = ref._node_alloc;
 				node_ptr		tmp_head_node = ref._head_node;
 				size_type		tmp_size = ref._size;
+				node_ptr		tmp_spare = ref._spare;
+				size_type		tmp_spare_count = ref._spare_count;
 
 				ref._comp = _comp;
-				ref._alloc = _alloc;
-				ref._node_alloc = _node_alloc;
 				ref._head_node = _head_node;
 				ref._size = _size;
+				ref._spare = _spare;
+				ref._spare_count = _spare_count;
 
 				_comp = tmp_comp;
-				_alloc = tmp_alloc;
-				_node_alloc = tmp_node_alloc;
 				_head_node = tmp_head_node;
 				_size = tmp_size;
+				_spare = tmp_spare;
+				_spare_count = tmp_spare_count;
+				ft::swap_allocators(_alloc, ref._alloc);
+				ft::swap_allocators(_node_alloc, ref._node_alloc);
 			}
 
 	// ==================================================================================================
 
 	// clear ============================================================================================
 
+			// 보관 중인 여분 노드까지 모두 해제한다.
 			void clear() {
-				delete_tree(_head_node->parent);
+				clear(false);
+				release_spare();
+			}
+
+			// keep_nodes 면 노드를 해제하지 않고 보관해 두었다가 다음 삽입에 다시 쓴다.
+			// 같은 크기로 비우고 다시 채우는 주기에서 할당/해제가 사라진다.
+			// 보관분은 clear(), 대입, 소멸 때 해제된다.
+			void clear(bool keep_nodes) {
+				FT_PROBE2(tree_clear, this, _size);
+				delete_tree(get_root(), keep_nodes);
 				set_root(NULL);
 				_size = 0;
 			}
 
+			size_type spare_nodes() const { return _spare_count; }
+
 	// ==================================================================================================
 
 	// find =============================================================================================
 		iterator find(const value_type& v) const {
+				this->stats_begin(tree_lookup_op);
+				node_ptr tmp = find_node(v);
+				if (tmp == NULL) {
+					return (iterator(this->_head_node));
+				}
+				return (iterator(tmp));
+			}
+
+			template <typename K, typename KeyValueCompare>
+			iterator find_key(const K& k, KeyValueCompare comp) const {
+				this->stats_begin(tree_lookup_op);
+				node_ptr tmp = find_key_node(k, comp);
+				if (tmp == NULL) {
+					return (iterator(this->_head_node));
+				}
+				return (iterator(tmp));
+			}
+
+			// 키보다 작지 않은 첫 노드 / 키보다 큰 첫 노드. 루트에서 한 번만 내려간다.
+			template <typename K, typename KeyValueCompare>
+			iterator lower_bound_key(const K& k, KeyValueCompare comp) const {
 				node_ptr tmp = get_root();
-				
+				node_ptr ret = _head_node;
+
+				this->stats_begin(tree_lookup_op);
 				while (tmp != NULL) {
-					if (!_comp(tmp->value, v) && !_comp(v, tmp->value)) {
-						break;
-					} else if (_comp(tmp->value, v)) {
+					if (!compare_less(comp, tmp->value, k)) {
+						ret = tmp;
+						tmp = tmp->left;
+					}
+					else
 						tmp = tmp->right;
-					} else {
+				}
+				return (iterator(ret));
+			}
+
+			template <typename K, typename KeyValueCompare>
+			iterator upper_bound_key(const K& k, KeyValueCompare comp) const {
+				node_ptr tmp = get_root();
+				node_ptr ret = _head_node;
+
+				this->stats_begin(tree_lookup_op);
+				while (tmp != NULL) {
+					if (compare_less(comp, k, tmp->value)) {
+						ret = tmp;
 						tmp = tmp->left;
 					}
+					else
+						tmp = tmp->right;
 				}
-				if (tmp == NULL) {
-					return (iterator(this->_head_node));
+				return (iterator(ret));
+			}
+
+		private:
+			node_ptr find_node(const value_type& v) const {
+				node_ptr tmp = get_root();
+
+				while (tmp != NULL) {
+					if (compare_less(v, tmp->value))
+						tmp = tmp->left;
+					else if (compare_less(tmp->value, v))
+						tmp = tmp->right;
+					else
+						return tmp;
 				}
-				return (iterator(tmp));
+				return NULL;
 			}
 
+			template <typename K, typename KeyValueCompare>
+			node_ptr find_key_node(const K& k, KeyValueCompare& comp) const {
+				node_ptr tmp = get_root();
+
+				while (tmp != NULL) {
+					if (compare_less(comp, k, tmp->value))
+						tmp = tmp->left;
+					else if (compare_less(comp, tmp->value, k))
+						tmp = tmp->right;
+					else
+						return tmp;
+				}
+				return NULL;
+			}
+
+		public:
 	// ==================================================================================================
 
 	// count ============================================================================================
@@ -613,7 +959,7 @@ namespace ft{
 				}
 				size_type count = 0;
 				for (iterator it = tmp; it != end(); ++it) {
-					if (!_comp(*it, v) && !_comp(v, *it)) {
+					if (!compare_less(*it, v) && !compare_less(v, *it)) {
 						++count;
 					}
 				}
@@ -622,10 +968,141 @@ namespace ft{
 
 	// ==================================================================================================
 
+	// statistics =======================================================================================
+	// stats() 는 Stats 가 true 일 때만 값이 쌓인다. shape() 와 verify() 는 항상 쓸 수 있고
+	// 트리 전체를 한 번 도는 O(n) 이다.
 
+		public:
+			// 노드마다 값 + 색 + 포인터 셋, 그리고 헤드 노드 하나.
+			ft::memory_footprint memory_usage() const {
+				ft::memory_footprint m;
+				m.add_blocks(sizeof(node_type), _size, _size * sizeof(value_type));
+				m.add_blocks(sizeof(node_type), 1 + _spare_count, 0);
+				return m;
+			}
 
+			using tree_stats_recorder<Stats>::stats;
+			using tree_stats_recorder<Stats>::reset_stats;
+
+			ft::tree_shape shape() const {
+				shape_visitor v;
+				v.shape.size = 0;
+				v.shape.height = 0;
+				v.shape.black_height = 0;
+				v.shape.average_depth = 0;
+				v.depth_sum = 0;
+				walk(v);
+				if (v.shape.size != 0)
+					v.shape.average_depth = static_cast<double>(v.depth_sum) / static_cast<double>(v.shape.size);
+				for (node_ptr n = get_root(); n != NULL; n = n->left)
+					if (n->color == BLACK)
+						v.shape.black_height++;
+				return v.shape;
+			}
 
+			// 레드블랙 트리의 모든 불변식과 부모 링크, 정렬, 크기를 검사한다.
+			bool verify() const {
+				node_ptr root = get_root();
+				if (root != NULL && (root->parent != _head_node || root->color != BLACK))
+					return false;
+				verify_visitor v;
+				v.ok = true;
+				v.count = 0;
+				v.leaf_black = 0;
+				v.seen_leaf = false;
+				if (!walk(v) || !v.ok || v.count != _size)
+					return false;
+				const_iterator it = begin();
+				if (it == end())
+					return true;
+				for (const_iterator next = it; ++next != end(); it = next)
+					if (!_comp(*it, *next))
+						return false;
+				return true;
+			}
 
+		private:
+			struct shape_visitor {
+				ft::tree_shape	shape;
+				size_t			depth_sum;
+
+				void operator()(node_ptr, size_t depth, size_t) {
+					shape.size++;
+					depth_sum += depth;
+					if (depth + 1 > shape.height)
+						shape.height = depth + 1;
+				}
+			};
+
+			struct verify_visitor {
+				bool	ok;
+				size_t	count;
+				size_t	leaf_black;
+				bool	seen_leaf;
+
+				// black 는 루트부터 node 까지의 검은 노드 수. 빈 자식이 있는 노드마다
+				// 그 값이 전부 같아야 한다.
+				void operator()(node_ptr node, size_t, size_t black) {
+					count++;
+					if (node->color != RED && node->color != BLACK)
+						ok = false;
+					if (node->color == RED && ((node->left != NULL && node->left->color == RED)
+						|| (node->right != NULL && node->right->color == RED)))
+						ok = false;
+					if (node->left == NULL || node->right == NULL) {
+						if (!seen_leaf) {
+							leaf_black = black;
+							seen_leaf = true;
+						}
+						else if (black != leaf_black)
+							ok = false;
+					}
+				}
+			};
+
+			// 전위 순회. delete_tree 처럼 부모 포인터로 올라가며, 방문 때마다
+			// 깊이(루트 0)와 루트부터의 검은 노드 수를 넘긴다.
+			// 자식의 parent 링크가 틀리면 더 돌지 않고 false.
+			template <typename Visitor>
+			bool walk(Visitor& visit) const {
+				node_ptr root = get_root();
+				if (root == NULL)
+					return true;
+				node_ptr stop = root->parent;
+				node_ptr prev = stop;
+				node_ptr node = root;
+				size_t depth = 0;
+				size_t black = root->color == BLACK;
+				while (node != stop) {
+					node_ptr next;
+					if (prev == node->parent) {
+						visit(node, depth, black);
+						if (node->left != NULL)
+							next = node->left;
+						else if (node->right != NULL)
+							next = node->right;
+						else
+							next = node->parent;
+					}
+					else if (prev == node->left && node->right != NULL)
+						next = node->right;
+					else
+						next = node->parent;
+					if (next == node->parent) {
+						depth--;
+						black -= node->color == BLACK;
+					}
+					else {
+						if (next->parent != node)
+							return false;
+						depth++;
+						black += next->color == BLACK;
+					}
+					prev = node;
+					node = next;
+				}
+				return true;
+			}
 	};
 }
 
@@ -84,16 +84,16 @@ namespace ft{
 			bool operator!=(const tree_const_iterator<T>& ref) const { return (_node != ref.base()); }
 			
 			private:
-			NodePtr min_value_node(NodePtr node) {
-				if (node->left == NULL)
-					return (node);
-				return (min_value_node(node->left));
+			static NodePtr min_value_node(NodePtr node) {
+				while (node->left != NULL)
+					node = node->left;
+				return (node);
 			}
 
-			NodePtr max_value_node(NodePtr node) {
-				if (node->right == NULL)
-					return (node);
-				return (max_value_node(node->right));
+			static NodePtr max_value_node(NodePtr node) {
+				while (node->right != NULL)
+					node = node->right;
+				return (node);
 			}
 	};
 
@@ -115,15 +115,14 @@ namespace ft{
 			tree_const_iterator(const tree_const_iterator &other) : _node(other._node) {}
 			tree_const_iterator(const tree_iterator<T> &other) : _node(other.base()) {}
 			tree_const_iterator(NodePtr node) : _node(node) {}
-			virtual ~tree_const_iterator() {}
+			~tree_const_iterator() {}
 			tree_const_iterator& operator=(const tree_const_iterator &ref) {
 				if (this != &ref)
 					_node = ref.base();
 				return (*this);
 			}
 			tree_const_iterator& operator=(const tree_iterator<T>& ref) {
-				if (this != &ref)
-					_node = ref.base();
+				_node = ref.base();
 				return (*this);
 			}
 
@@ -186,16 +185,16 @@ namespace ft{
 			bool operator!=(const tree_iterator<T>& ref) const { return (_node != ref.base()); }
 
 		private:
-			NodePtr min_value_node(NodePtr node) {
-				if (node->left == NULL)
-					return (node);
-				return (min_value_node(node->left));
+			static NodePtr min_value_node(NodePtr node) {
+				while (node->left != NULL)
+					node = node->left;
+				return (node);
 			}
 
-			NodePtr max_value_node(NodePtr node) {
-				if (node->right == NULL)
-					return (node);
-				return (max_value_node(node->right));
+			static NodePtr max_value_node(NodePtr node) {
+				while (node->right != NULL)
+					node = node->right;
+				return (node);
 			}
 	};
 
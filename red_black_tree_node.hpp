@@ -1,6 +1,8 @@
 #ifndef RED_BLACK_TREE_NODE_HPP
 #define RED_BLACK_TREE_NODE_HPP
 
+#include <cstddef>
+
 namespace ft {
 	enum Color {
 			RED,
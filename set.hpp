@@ -2,11 +2,15 @@
 #define SET_HPP
 
 #include "red_black_tree.hpp"
+#include "node_handle.hpp"
+#include <algorithm>
+#include <cassert>
 #include <memory>
 
 namespace ft {
 
-	template <class Key, class Compare = ft::less<Key>, class Alloc = std::allocator<Key> >
+	// Stats turns on the tree's rebalancing counters (see tree_stats.hpp)
+	template <class Key, class Compare = ft::less<Key>, class Alloc = std::allocator<Key>, bool Stats = false>
 	class set {
 		public:
 		typedef Key key_type;
@@ -25,28 +29,36 @@ namespace ft {
 		typedef typename ft::reverse_iterator<iterator> reverse_iterator;
 		typedef typename ft::reverse_iterator<const_iterator> const_reverse_iterator;
 
+		private:
+			typedef ft::red_black_tree<value_type, key_compare, allocator_type, Stats> tree_type;
+
+		public:
+		typedef ft::set_node_handle<Key, typename tree_type::node_allocator_type> node_type;
+		typedef ft::insert_return_type<iterator, node_type> insert_return_type;
+
 		private:
 			key_compare _comp;
-			allocator_type _alloc;
-			ft::red_black_tree<value_type, key_compare, allocator_type> _tree;
+			tree_type _tree;
 
 		public:
 			explicit set(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
-			: _comp(comp), _alloc(alloc), _tree(value_compare(), alloc) {}
+			: _comp(comp), _tree(comp, alloc) {}
 
 			template <class InputIterator>
 			set(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
-			: _comp(comp), _alloc(alloc), _tree(value_compare(), alloc) {
+			: _comp(comp), _tree(comp, alloc) {
 				_tree.insert(first, last);
 			}
 
 			set(const set& ref)
-			: _comp(ref._comp), _alloc(ref._alloc), _tree(ref._tree) {}
+			: _comp(ref._comp), _tree(ref._tree) {}
 
 			~set() {}
 
+			// _comp goes along with the tree: the bound queries descend with it
 			set& operator=(const set& ref) {
 				_tree = ref._tree;
+				_comp = ref._comp;
 				return *this;
 			}
 
@@ -93,7 +105,7 @@ namespace ft {
 			}
 
 			size_type max_size() const {
-				return _alloc.max_size();
+				return _tree.max_size();
 			}
 
 			//modifiers
@@ -111,6 +123,58 @@ namespace ft {
 				_tree.insert(first, last);
 			}
 
+			//node handles
+			node_type extract(iterator position) {
+				return node_type(_tree.extract_node(position), _tree.get_node_allocator());
+			}
+
+			node_type extract(const key_type& k) {
+				iterator it = find(k);
+				if (it == end())
+					return node_type();
+				return extract(it);
+			}
+
+			// the node is freed by this tree's allocator later on, so it has to
+			// come from an equal one
+			insert_return_type insert(node_type nh) {
+				insert_return_type ret;
+				if (nh.empty()) {
+					ret.position = end();
+					ret.inserted = false;
+					return ret;
+				}
+				assert(nh.get_allocator() == _tree.get_node_allocator());
+				typename node_type::node_ptr node = nh.release();
+				pair<typename tree_type::iterator, bool> res = _tree.reinsert_node(node);
+				ret.position = res.first;
+				ret.inserted = res.second;
+				if (!res.second)
+					ret.node = node_type(node, _tree.get_node_allocator());
+				return ret;
+			}
+
+			iterator insert(iterator hint, node_type nh) {
+				(void)hint;
+				if (nh.empty())
+					return end();
+				return insert(nh).position;
+			}
+
+			// moves every node whose key is not already here; nothing is allocated or copied
+			template <class C2, bool S2>
+			void merge(set<Key, C2, Alloc, S2>& source) {
+				typedef typename set<Key, C2, Alloc, S2>::iterator source_iterator;
+				assert(source.get_allocator() == get_allocator());
+				for (source_iterator it = source.begin(); it != source.end(); ) {
+					source_iterator next = it;
+					++next;
+					if (find(*it) == end())
+						insert(source.extract(it));
+					it = next;
+				}
+			}
+
 			void erase(iterator position) {
 				_tree.erase(position);
 			}
@@ -125,11 +189,21 @@ namespace ft {
 
 			void swap(set& x) {
 				_tree.swap(x._tree);
+				std::swap(_comp, x._comp);
 			}
 
 			void clear() {
 				_tree.clear();
 			}
+
+			// keep_nodes: the nodes stay allocated and the next inserts reuse them
+			void clear(bool keep_nodes) {
+				_tree.clear(keep_nodes);
+			}
+
+			size_type spare_nodes() const {
+				return _tree.spare_nodes();
+			}
 			
 			key_compare key_comp() const {
 				return _comp;
@@ -149,55 +223,23 @@ namespace ft {
 			}
 
 			size_type count(const key_type& k) const {
-				return _tree.count(k);
+				return find(k) == end() ? 0 : 1;
 			}
 
 			iterator lower_bound(const key_type& k) {
-				iterator	it1 = this->begin();
-				iterator	it2 = this->end();
-				while (it1 != it2)
-				{
-					if (_comp(*it1, k) == false)
-						break;
-					++it1;
-				}
-				return it1;
+				return _tree.lower_bound_key(k, _comp);
 			}
 
 			const_iterator lower_bound(const key_type& k) const {
-				const_iterator	it1 = this->begin();
-				const_iterator	it2 = this->end();
-				while (it1 != it2)
-				{
-					if (_comp(*it1, k) == false)
-						break;
-					++it1;
-				}
-				return it1;
+				return _tree.lower_bound_key(k, _comp);
 			}
 
 			iterator upper_bound(const key_type& k) {
-				iterator	it1 = this->begin();
-				iterator	it2 = this->end();
-				while (it1 != it2)
-				{
-					if (_comp(k, *it1) == true)
-						break;
-					++it1;
-				}
-				return it1;
+				return _tree.upper_bound_key(k, _comp);
 			}
 
 			const_iterator upper_bound(const key_type& k) const {
-				const_iterator	it1 = this->begin();
-				const_iterator	it2 = this->end();
-				while (it1 != it2)
-				{
-					if (_comp(k, *it1) == true)
-						break;
-					++it1;
-				}
-				return it1;
+				return _tree.upper_bound_key(k, _comp);
 			}
 
 			pair<iterator,iterator>	equal_range (const value_type& k) const {
@@ -206,44 +248,65 @@ namespace ft {
 
 			//allocator
 			allocator_type get_allocator() const {
-				return _alloc;
+				return _tree.get_allocator();
+			}
+
+			ft::memory_footprint memory_usage() const {
+				return _tree.memory_usage();
+			}
+
+			//statistics
+			const ft::tree_stats& stats() const {
+				return _tree.stats();
+			}
+
+			void reset_stats() {
+				_tree.reset_stats();
+			}
+
+			ft::tree_shape shape() const {
+				return _tree.shape();
+			}
+
+			bool verify() const {
+				return _tree.verify();
 			}
 	};
 
-	template <class Key, class Compare, class Alloc>
-	void swap(ft::set<Key, Compare, Alloc>& lhs, ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	void swap(ft::set<Key, Compare, Alloc, Stats>& lhs, ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		lhs.swap(rhs);
 	}
 
-	template <class Key, class Compare, class Alloc>
-	bool operator==(const ft::set<Key, Compare, Alloc>& lhs, const ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	bool operator==(const ft::set<Key, Compare, Alloc, Stats>& lhs, const ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		if (lhs.size() != rhs.size())
 			return false;
 		return ft::equal(lhs.begin(), lhs.end(), rhs.begin());
 	}
 
-	template <class Key, class Compare, class Alloc>
-	bool operator!=(const ft::set<Key, Compare, Alloc>& lhs, const ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	bool operator!=(const ft::set<Key, Compare, Alloc, Stats>& lhs, const ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		return !(lhs == rhs);
 	}
 
-	template <class Key, class Compare, class Alloc>
-	bool operator<(const ft::set<Key, Compare, Alloc>& lhs, const ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	bool operator<(const ft::set<Key, Compare, Alloc, Stats>& lhs, const ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 	}
 
-	template <class Key, class Compare, class Alloc>
-	bool operator>(const ft::set<Key, Compare, Alloc>& lhs, const ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	bool operator>(const ft::set<Key, Compare, Alloc, Stats>& lhs, const ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		return rhs < lhs;
 	}
 
-	template <class Key, class Compare, class Alloc>
-	bool operator<=(const ft::set<Key, Compare, Alloc>& lhs, const ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	bool operator<=(const ft::set<Key, Compare, Alloc, Stats>& lhs, const ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		return !(rhs < lhs);
 	}
 
-	template <class Key, class Compare, class Alloc>
-	bool operator>=(const ft::set<Key, Compare, Alloc>& lhs, const ft::set<Key, Compare, Alloc>& rhs) {
+	template <class Key, class Compare, class Alloc, bool Stats>
+	bool operator>=(const ft::set<Key, Compare, Alloc, Stats>& lhs, const ft::set<Key, Compare, Alloc, Stats>& rhs) {
 		return !(lhs < rhs);
 	}
 }
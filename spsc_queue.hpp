@@ -0,0 +1,200 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include "atomic.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace ft {
+
+	// Bounded FIFO between exactly one producer thread and one consumer thread,
+	// wait-free on both sides: no CAS, no retry loop. The producer owns the tail
+	// index and the consumer the head; each keeps a private copy of the other's
+	// index and reloads it only when the copy says full (empty), so in steady
+	// state the two threads touch no common cache line but the slots themselves.
+	//
+	// The capacity is rounded up to a power of two. try_* never wait; push/pop
+	// and push_n/pop_n spin with backoff until done. try_push_n/try_pop_n move as
+	// much as fits, as at most two contiguous copies (the ring may wrap).
+	// Calling a producer function from two threads at once (or a consumer
+	// function) is a data race. T's copy constructor, assignment and destructor
+	// must not throw.
+	template <typename T, typename Alloc = std::allocator<T> >
+	class spsc_queue {
+		public:
+			typedef T			value_type;
+			typedef Alloc		allocator_type;
+			typedef size_t		size_type;
+
+		private:
+			// read-only after construction
+			allocator_type		_alloc;
+			T*					_slots;
+			size_t				_mask;
+			char				_pad0[cache_line_size];
+			// the producer's line
+			ft::atomic<size_t>	_tail;
+			size_t				_head_cache;
+			char				_pad1[cache_line_size - 2 * sizeof(size_t)];
+			// the consumer's line
+			ft::atomic<size_t>	_head;
+			size_t				_tail_cache;
+			char				_pad2[cache_line_size - 2 * sizeof(size_t)];
+
+			spsc_queue(const spsc_queue&);
+			spsc_queue& operator=(const spsc_queue&);
+
+			static size_t round_up(size_t n) {
+				size_t c = 2;
+				while (c < n)
+					c *= 2;
+				return c;
+			}
+
+			// slots the producer may fill from tail, at most n
+			size_t writable(size_t tail, size_t n) {
+				size_t room = _mask + 1 - (tail - _head_cache);
+				if (room < n) {
+					_head_cache = _head.load(memory_order_acquire);
+					room = _mask + 1 - (tail - _head_cache);
+				}
+				return room < n ? room : n;
+			}
+
+			// slots the consumer may take from head, at most n
+			size_t readable(size_t head, size_t n) {
+				size_t ready = _tail_cache - head;
+				if (ready < n) {
+					_tail_cache = _tail.load(memory_order_acquire);
+					ready = _tail_cache - head;
+				}
+				return ready < n ? ready : n;
+			}
+
+		public:
+			explicit spsc_queue(size_type capacity, const allocator_type& alloc = allocator_type())
+				: _alloc(alloc), _slots(NULL), _mask(round_up(capacity) - 1), _tail(0), _head_cache(0),
+				_head(0), _tail_cache(0) {
+				_slots = _alloc.allocate(_mask + 1);
+			}
+
+			// only once neither thread uses the queue
+			~spsc_queue() {
+				size_t tail = _tail.load(memory_order_relaxed);
+				for (size_t pos = _head.load(memory_order_relaxed); pos != tail; pos++)
+					_alloc.destroy(&_slots[pos & _mask]);
+				_alloc.deallocate(_slots, _mask + 1);
+			}
+
+			// producer ===========================================================
+
+			bool try_push(const T& val) {
+				size_t tail = _tail.load(memory_order_relaxed);
+				if (writable(tail, 1) == 0)
+					return false;
+				_alloc.construct(&_slots[tail & _mask], val);
+				_tail.store(tail + 1, memory_order_release);
+				return true;
+			}
+
+			void push(const T& val) {
+				ft::backoff wait;
+				while (!try_push(val))
+					wait.pause();
+			}
+
+			// pushes items[0 .. k) for the largest k <= n that fits right now; returns k
+			size_type try_push_n(const T* items, size_type n) {
+				size_t tail = _tail.load(memory_order_relaxed);
+				n = writable(tail, n);
+				size_t first = tail & _mask;
+				size_t span = _mask + 1 - first;
+				if (span > n)
+					span = n;
+				std::uninitialized_copy(items, items + span, _slots + first);
+				std::uninitialized_copy(items + span, items + n, _slots);
+				_tail.store(tail + n, memory_order_release);
+				return n;
+			}
+
+			void push_n(const T* items, size_type n) {
+				ft::backoff wait;
+				while (n != 0) {
+					size_t k = try_push_n(items, n);
+					if (k == 0) {
+						wait.pause();
+						continue;
+					}
+					wait.reset();
+					items += k;
+					n -= k;
+				}
+			}
+
+			// consumer ===========================================================
+
+			bool try_pop(T& out) {
+				size_t head = _head.load(memory_order_relaxed);
+				if (readable(head, 1) == 0)
+					return false;
+				T* slot = &_slots[head & _mask];
+				out = *slot;
+				_alloc.destroy(slot);
+				_head.store(head + 1, memory_order_release);
+				return true;
+			}
+
+			void pop(T& out) {
+				ft::backoff wait;
+				while (!try_pop(out))
+					wait.pause();
+			}
+
+			// pops up to n items into out, in queue order; returns how many
+			size_type try_pop_n(T* out, size_type n) {
+				size_t head = _head.load(memory_order_relaxed);
+				n = readable(head, n);
+				size_t first = head & _mask;
+				size_t span = _mask + 1 - first;
+				if (span > n)
+					span = n;
+				std::copy(_slots + first, _slots + first + span, out);
+				std::copy(_slots, _slots + (n - span), out + span);
+				for (size_t i = 0; i < n; i++)
+					_alloc.destroy(&_slots[(head + i) & _mask]);
+				_head.store(head + n, memory_order_release);
+				return n;
+			}
+
+			void pop_n(T* out, size_type n) {
+				ft::backoff wait;
+				while (n != 0) {
+					size_t k = try_pop_n(out, n);
+					if (k == 0) {
+						wait.pause();
+						continue;
+					}
+					wait.reset();
+					out += k;
+					n -= k;
+				}
+			}
+
+			// either side ========================================================
+
+			// a snapshot that may be stale by the time it returns
+			size_type size_approx() const {
+				size_t head = _head.load(memory_order_acquire);
+				return _tail.load(memory_order_acquire) - head;
+			}
+
+			bool empty_approx() const { return size_approx() == 0; }
+
+			size_type capacity() const { return _mask + 1; }
+	};
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define STACK_HPP
 
 #include "vector.hpp"
+#include "allocator_traits.hpp"
+#include "enable_if.hpp"
 
 namespace ft {
 	template <class T, class Container = ft::vector<T> >
@@ -14,6 +16,13 @@ namespace ft {
 			container_type c;
 		public:
 			explicit stack(const container_type& ctnr = container_type()) : c(ctnr) {}
+			// the underlying container allocates from a, e.g. an arena
+			template <class Alloc>
+			explicit stack(const Alloc& a,
+				typename ft::enable_if<ft::uses_allocator<container_type, Alloc>::value>::type* = 0) : c(a) {}
+			template <class Alloc>
+			stack(const container_type& ctnr, const Alloc& a,
+				typename ft::enable_if<ft::uses_allocator<container_type, Alloc>::value>::type* = 0) : c(ctnr, a) {}
 			~stack() {}
 			bool empty() const { return c.empty(); }
 			size_type size() const { return c.size(); }
@@ -21,6 +30,7 @@ namespace ft {
 			const value_type& top() const { return c.back(); }
 			void push(const value_type& val) { c.push_back(val); }
 			void pop() { c.pop_back(); }
+			ft::memory_footprint memory_usage() const { return c.memory_usage(); }
 			
 			template <class T1, class Container1>
 			friend bool operator==(const stack<T1, Container1>& lhs, const stack<T1, Container1>& rhs);
@@ -0,0 +1,304 @@
+#ifndef THREAD_CACHE_HPP
+#define THREAD_CACHE_HPP
+
+#include "allocator_traits.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <pthread.h>
+
+// Node allocator for many threads churning their own containers. Blocks up to
+// 256 bytes come in 16 size classes; each thread keeps a free list per class
+// and only takes a lock when the list runs dry (fetch one batch of 32 blocks
+// from the shared depot) or grows past two batches (return one). A block may
+// be freed on any thread: it joins the freeing thread's cache and travels back
+// to the depot in a batch, so a producer/consumer pair does not leak or
+// serialise. A thread's cache goes back to the depot when the thread exits.
+// The depot carves 64 KiB slabs from operator new and keeps them for the life
+// of the process. Larger requests go straight to operator new.
+
+namespace ft {
+namespace thread_cache_detail {
+
+	static const size_t	class_granularity = 16;
+	static const size_t	class_count = 16;
+	static const size_t	max_small = class_granularity * class_count;
+	static const size_t	batch_size = 32;
+	static const size_t	slab_size = 64 * 1024;
+
+	// every block has room for two links: within a batch and between batches
+	struct block {
+		block*	next;
+		block*	next_batch;
+	};
+
+	inline size_t class_of(size_t bytes) {
+		return bytes ? (bytes - 1) / class_granularity : 0;
+	}
+
+	inline size_t class_size(size_t c) {
+		return (c + 1) * class_granularity;
+	}
+
+	struct depot_stats {
+		unsigned long	fetches;	// batches handed to thread caches
+		unsigned long	returns;	// batches given back
+		unsigned long	slabs;		// slabs carved
+	};
+
+	struct cache_class {
+		block*	head;
+		size_t	count;
+	};
+
+	struct thread_cache {
+		cache_class	classes[class_count];
+		bool		registered;
+	};
+
+	inline void flush_thread_cache(void* cache);
+
+	// the shared pool of full batches, one lock per size class. Trivially
+	// destructible so exiting threads can still flush into it during shutdown.
+	class depot {
+		private:
+			struct depot_class {
+				pthread_mutex_t	mutex;
+				block*			batches;
+				block*			loose;			// a partial batch from exiting threads
+				size_t			loose_count;
+			};
+
+			depot_class		_classes[class_count];
+			pthread_key_t	_key;
+			depot_stats		_stats;
+
+			depot(const depot&);
+			depot& operator=(const depot&);
+
+			// carves a slab into batches; called with the class locked
+			void carve(depot_class& dc, size_t c) {
+				size_t size = class_size(c);
+				size_t blocks = slab_size / size / batch_size * batch_size;
+				char* slab = static_cast<char*>(::operator new(blocks * size));
+				__sync_fetch_and_add(&_stats.slabs, 1);
+				for (size_t first = 0; first + batch_size <= blocks; first += batch_size) {
+					block* head = reinterpret_cast<block*>(slab + first * size);
+					for (size_t i = 0; i + 1 < batch_size; i++)
+						reinterpret_cast<block*>(slab + (first + i) * size)->next =
+							reinterpret_cast<block*>(slab + (first + i + 1) * size);
+					reinterpret_cast<block*>(slab + (first + batch_size - 1) * size)->next = NULL;
+					head->next_batch = dc.batches;
+					dc.batches = head;
+				}
+			}
+
+		public:
+			depot() {
+				for (size_t c = 0; c < class_count; c++) {
+					pthread_mutex_init(&_classes[c].mutex, NULL);
+					_classes[c].batches = NULL;
+					_classes[c].loose = NULL;
+					_classes[c].loose_count = 0;
+				}
+				pthread_key_create(&_key, flush_thread_cache);
+				_stats.fetches = 0;
+				_stats.returns = 0;
+				_stats.slabs = 0;
+			}
+
+			static depot& instance() {
+				static depot d;
+				return d;
+			}
+
+			pthread_key_t key() const { return _key; }
+
+			// a chain of batch_size blocks
+			block* fetch(size_t c) {
+				depot_class& dc = _classes[c];
+				pthread_mutex_lock(&dc.mutex);
+				if (dc.batches == NULL)
+					carve(dc, c);
+				block* b = dc.batches;
+				dc.batches = b->next_batch;
+				pthread_mutex_unlock(&dc.mutex);
+				__sync_fetch_and_add(&_stats.fetches, 1);
+				return b;
+			}
+
+			void give(size_t c, block* batch) {
+				depot_class& dc = _classes[c];
+				pthread_mutex_lock(&dc.mutex);
+				batch->next_batch = dc.batches;
+				dc.batches = batch;
+				pthread_mutex_unlock(&dc.mutex);
+				__sync_fetch_and_add(&_stats.returns, 1);
+			}
+
+			// fewer than batch_size blocks; they wait in the loose list until
+			// it makes a whole batch
+			void give_loose(size_t c, block* chain) {
+				depot_class& dc = _classes[c];
+				pthread_mutex_lock(&dc.mutex);
+				while (chain != NULL) {
+					block* next = chain->next;
+					chain->next = dc.loose;
+					dc.loose = chain;
+					if (++dc.loose_count == batch_size) {
+						dc.loose->next_batch = dc.batches;
+						dc.batches = dc.loose;
+						dc.loose = NULL;
+						dc.loose_count = 0;
+					}
+					chain = next;
+				}
+				pthread_mutex_unlock(&dc.mutex);
+			}
+
+			// other threads keep counting meanwhile, so each counter is read
+			// atomically; the three together are not one snapshot
+			depot_stats stats() const {
+				depot_stats s;
+				s.fetches = __atomic_load_n(&_stats.fetches, __ATOMIC_RELAXED);
+				s.returns = __atomic_load_n(&_stats.returns, __ATOMIC_RELAXED);
+				s.slabs = __atomic_load_n(&_stats.slabs, __ATOMIC_RELAXED);
+				return s;
+			}
+	};
+
+	inline thread_cache& local_cache() {
+		static __thread thread_cache cache;
+		return cache;
+	}
+
+	// thread exit: every cached block goes back to the depot
+	inline void flush_thread_cache(void* p) {
+		thread_cache* cache = static_cast<thread_cache*>(p);
+		depot& d = depot::instance();
+		for (size_t c = 0; c < class_count; c++) {
+			cache_class& cc = cache->classes[c];
+			while (cc.count >= batch_size) {
+				block* first = cc.head;
+				block* last = first;
+				for (size_t i = 1; i < batch_size; i++)
+					last = last->next;
+				cc.head = last->next;
+				last->next = NULL;
+				cc.count -= batch_size;
+				d.give(c, first);
+			}
+			d.give_loose(c, cc.head);
+			cc.head = NULL;
+			cc.count = 0;
+		}
+		cache->registered = false;
+	}
+
+	inline void register_cache(thread_cache& cache) {
+		pthread_setspecific(depot::instance().key(), &cache);
+		cache.registered = true;
+	}
+
+	inline void* allocate(size_t bytes) {
+		if (bytes > max_small)
+			return ::operator new(bytes);
+		size_t c = class_of(bytes);
+		thread_cache& cache = local_cache();
+		cache_class& cc = cache.classes[c];
+		if (cc.head == NULL) {
+			if (!cache.registered)
+				register_cache(cache);
+			cc.head = depot::instance().fetch(c);
+			cc.count = batch_size;
+		}
+		block* b = cc.head;
+		cc.head = b->next;
+		cc.count--;
+		return b;
+	}
+
+	inline void deallocate(void* p, size_t bytes) {
+		if (bytes > max_small) {
+			::operator delete(p);
+			return;
+		}
+		size_t c = class_of(bytes);
+		thread_cache& cache = local_cache();
+		cache_class& cc = cache.classes[c];
+		if (!cache.registered)
+			register_cache(cache);
+		block* b = static_cast<block*>(p);
+		b->next = cc.head;
+		cc.head = b;
+		if (++cc.count < 2 * batch_size)
+			return;
+		block* last = b;
+		for (size_t i = 1; i < batch_size; i++)
+			last = last->next;
+		cc.head = last->next;
+		last->next = NULL;
+		cc.count -= batch_size;
+		depot::instance().give(c, b);
+	}
+}
+
+	inline thread_cache_detail::depot_stats thread_cache_stats() {
+		return thread_cache_detail::depot::instance().stats();
+	}
+
+	// Stateless: every instance draws from the same caches, so all compare
+	// equal and containers may be swapped, assigned and destroyed on any thread.
+	template <typename T>
+	class thread_caching_allocator {
+		public:
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef const T*	const_pointer;
+			typedef T&			reference;
+			typedef const T&	const_reference;
+			typedef size_t		size_type;
+			typedef ptrdiff_t	difference_type;
+
+			typedef ft::true_type	propagate_on_container_swap;
+
+			template <typename U>
+			struct rebind { typedef thread_caching_allocator<U> other; };
+
+			thread_caching_allocator() throw() {}
+			thread_caching_allocator(const thread_caching_allocator&) throw() {}
+			template <typename U>
+			thread_caching_allocator(const thread_caching_allocator<U>&) throw() {}
+			~thread_caching_allocator() throw() {}
+
+			pointer			address(reference x) const { return &x; }
+			const_pointer	address(const_reference x) const { return &x; }
+
+			pointer allocate(size_type n, const void* hint = 0) {
+				(void)hint;
+				if (n > max_size())
+					throw std::bad_alloc();
+				return static_cast<pointer>(thread_cache_detail::allocate(n * sizeof(T)));
+			}
+
+			void deallocate(pointer p, size_type n) {
+				if (p != NULL)
+					thread_cache_detail::deallocate(p, n * sizeof(T));
+			}
+
+			size_type max_size() const throw() {
+				return std::numeric_limits<size_type>::max() / sizeof(T);
+			}
+
+			void construct(pointer p, const_reference val) { ::new (static_cast<void*>(p)) T(val); }
+			void destroy(pointer p) { p->~T(); }
+
+			template <typename U>
+			bool operator==(const thread_caching_allocator<U>&) const { return true; }
+			template <typename U>
+			bool operator!=(const thread_caching_allocator<U>&) const { return false; }
+	};
+}
+
+#endif
@@ -0,0 +1,406 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include "atomic.hpp"
+#include "concurrent_queue.hpp"
+#include "work_stealing_deque.hpp"
+
+#include <cstddef>
+#include <ctime>
+#include <exception>
+#include <pthread.h>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+namespace ft {
+
+	class thread_pool;
+
+	namespace thread_pool_detail {
+
+		class task {
+			public:
+				virtual ~task() {}
+				virtual void run() = 0;
+		};
+
+		// the forked half of a parallel_invoke: lives on the forking worker's
+		// stack, which waits for done() before returning
+		template <typename F>
+		class join_task : public task {
+			private:
+				F&				_f;
+				ft::atomic<int>	_done;
+
+			public:
+				explicit join_task(F& f) : _f(f), _done(0) {}
+
+				virtual void run() {
+					_f();
+					_done.store(1, memory_order_release);
+				}
+
+				bool done() const { return _done.load(memory_order_acquire) != 0; }
+		};
+
+		// work handed in by a thread outside the pool, which sleeps until it ends
+		template <typename F>
+		class blocking_task : public task {
+			private:
+				F&				_f;
+				bool			_finished;
+				pthread_mutex_t	_lock;
+				pthread_cond_t	_cond;
+
+			public:
+				explicit blocking_task(F& f) : _f(f), _finished(false) {
+					pthread_mutex_init(&_lock, NULL);
+					pthread_cond_init(&_cond, NULL);
+				}
+
+				~blocking_task() {
+					pthread_cond_destroy(&_cond);
+					pthread_mutex_destroy(&_lock);
+				}
+
+				// the waiter may destroy the task as soon as the lock is released
+				virtual void run() {
+					_f();
+					pthread_mutex_lock(&_lock);
+					_finished = true;
+					pthread_cond_signal(&_cond);
+					pthread_mutex_unlock(&_lock);
+				}
+
+				void wait() {
+					pthread_mutex_lock(&_lock);
+					while (!_finished)
+						pthread_cond_wait(&_cond, &_lock);
+					pthread_mutex_unlock(&_lock);
+				}
+		};
+
+		template <typename F1, typename F2>
+		struct invoke_both {
+			F1&	f1;
+			F2&	f2;
+
+			invoke_both(F1& a, F2& b) : f1(a), f2(b) {}
+			void operator()();
+		};
+
+		struct worker {
+			thread_pool*				pool;
+			size_t						index;
+			work_stealing_deque<task*>	deque;
+			unsigned long				seed;
+			pthread_t					thread;
+			ft::atomic<size_t>			executed;
+			ft::atomic<size_t>			steals;
+
+			worker(thread_pool* p, size_t i)
+				: pool(p), index(i), deque(), seed(0x9E3779B97F4A7C15UL * (i + 1)), thread(), executed(0), steals(0) {}
+		};
+
+		// the worker the calling thread is, NULL outside every pool
+		inline worker*& current_worker() {
+			static __thread worker* w = NULL;
+			return w;
+		}
+
+		struct pool_stats {
+			size_t	executed;	// tasks run, forked halves and submitted work
+			size_t	steals;		// of those, taken from another worker's deque
+		};
+	}
+
+	// Fork/join scheduler: one deque per worker thread (work_stealing_deque).
+	// A worker pushes the second half of a parallel_invoke on its own deque,
+	// runs the first half, then pops the second back and runs it too unless an
+	// idle worker stole it meanwhile; in that case it helps with other work
+	// until the thief is done. Idle workers steal from a random victim, take
+	// work handed in from outside the pool, and after a while of finding
+	// nothing go to sleep until new work is pushed.
+	//
+	// Functions are called with no arguments and taken by reference; their
+	// result goes into the functor itself. An exception from a half run by the
+	// calling thread propagates out of invoke once the other half is done. One
+	// thrown by any other task (a stolen half, work from outside the pool, or a
+	// task a waiting worker picked up meanwhile) calls std::terminate, as it
+	// would on a std::thread.
+	class thread_pool {
+		public:
+			typedef thread_pool_detail::task		task;
+			typedef thread_pool_detail::worker		worker;
+			typedef thread_pool_detail::pool_stats	stats_type;
+
+		private:
+			std::vector<worker*>		_workers;
+			ft::concurrent_queue<task*>	_injected;
+			ft::atomic<int>				_stop;
+			ft::atomic<int>				_sleepers;
+			pthread_mutex_t				_lock;
+			pthread_cond_t				_wake;
+
+			thread_pool(const thread_pool&);
+			thread_pool& operator=(const thread_pool&);
+
+			static void* worker_main(void* p) {
+				worker& w = *static_cast<worker*>(p);
+				thread_pool_detail::current_worker() = &w;
+				w.pool->work(w);
+				return NULL;
+			}
+
+			static unsigned long xorshift(unsigned long& s) {
+				s ^= s << 13;
+				s ^= s >> 7;
+				s ^= s << 17;
+				return s;
+			}
+
+			static void count_executed(worker& w) {
+				w.executed.store(w.executed.load(memory_order_relaxed) + 1, memory_order_relaxed);
+			}
+
+			// t belongs to another invoke (or to a caller outside the pool), which
+			// waits for it: an exception has nowhere to go without leaving that
+			// one hanging, or unwinding a frame another task still points into
+			static void execute(worker& w, task* t) {
+				try {
+					t->run();
+				}
+				catch (...) {
+					std::terminate();
+				}
+				count_executed(w);
+			}
+
+			// own deque first (newest, still in cache), then work from outside,
+			// then one pass over the other workers from a random one
+			task* find_work(worker& w) {
+				task* t;
+				if (w.deque.pop(t) || _injected.try_pop(t))
+					return t;
+				size_t n = _workers.size();
+				size_t start = static_cast<size_t>(xorshift(w.seed) % n);
+				for (size_t i = 0; i < n; i++) {
+					worker& victim = *_workers[(start + i) % n];
+					if (&victim != &w && victim.deque.steal(t)) {
+						w.steals.store(w.steals.load(memory_order_relaxed) + 1, memory_order_relaxed);
+						return t;
+					}
+				}
+				return NULL;
+			}
+
+			bool has_work() const {
+				if (_injected.size_approx() != 0)
+					return true;
+				for (size_t i = 0; i < _workers.size(); i++)
+					if (!_workers[i]->deque.empty_approx())
+						return true;
+				return false;
+			}
+
+			void work(worker& w) {
+				ft::backoff wait;
+				unsigned idle = 0;
+				while (!_stop.load(memory_order_acquire)) {
+					task* t = find_work(w);
+					if (t != NULL) {
+						execute(w, t);
+						wait.reset();
+						idle = 0;
+					}
+					else if (++idle < 64)
+						wait.pause();
+					else {
+						sleep();
+						wait.reset();
+						idle = 0;
+					}
+				}
+			}
+
+			// Registers as a sleeper before the last look for work, and notify()
+			// looks for sleepers after pushing, so one of the two sees the other.
+			// The timeout only bounds the damage of a bug in that argument.
+			void sleep() {
+				pthread_mutex_lock(&_lock);
+				_sleepers.fetch_add(1);
+				atomic_thread_fence(memory_order_seq_cst);
+				if (!_stop.load(memory_order_acquire) && !has_work()) {
+					struct timespec until;
+					clock_gettime(CLOCK_REALTIME, &until);
+					until.tv_nsec += 10000000;
+					if (until.tv_nsec >= 1000000000) {
+						until.tv_sec++;
+						until.tv_nsec -= 1000000000;
+					}
+					pthread_cond_timedwait(&_wake, &_lock, &until);
+				}
+				_sleepers.fetch_sub(1);
+				pthread_mutex_unlock(&_lock);
+			}
+
+			void notify() {
+				atomic_thread_fence(memory_order_seq_cst);
+				if (_sleepers.load(memory_order_relaxed) == 0)
+					return;
+				pthread_mutex_lock(&_lock);
+				pthread_cond_signal(&_wake);
+				pthread_mutex_unlock(&_lock);
+			}
+
+			void shutdown(size_t started) {
+				_stop.store(1, memory_order_release);
+				pthread_mutex_lock(&_lock);
+				pthread_cond_broadcast(&_wake);
+				pthread_mutex_unlock(&_lock);
+				for (size_t i = 0; i < started; i++)
+					pthread_join(_workers[i]->thread, NULL);
+				for (size_t i = 0; i < _workers.size(); i++)
+					delete _workers[i];
+				pthread_cond_destroy(&_wake);
+				pthread_mutex_destroy(&_lock);
+			}
+
+			// waits for t (pushed last on w's deque) while running other work
+			template <typename F>
+			void join(worker& w, thread_pool_detail::join_task<F>& t) {
+				task* next;
+				if (w.deque.pop(next)) {
+					if (next == &t) {
+						// not stolen: run inline, so its exception propagates too
+						count_executed(w);
+						t.run();
+						return;
+					}
+					execute(w, next);
+				}
+				ft::backoff wait;
+				while (!t.done()) {
+					next = find_work(w);
+					if (next != NULL) {
+						execute(w, next);
+						wait.reset();
+					}
+					else
+						wait.pause();
+				}
+			}
+
+		public:
+			// threads == 0: one per online cpu
+			explicit thread_pool(size_t threads = 0) : _workers(), _injected(1024), _stop(0), _sleepers(0) {
+				if (threads == 0)
+					threads = hardware_threads();
+				pthread_mutex_init(&_lock, NULL);
+				pthread_cond_init(&_wake, NULL);
+				for (size_t i = 0; i < threads; i++)
+					_workers.push_back(new worker(this, i));
+				for (size_t i = 0; i < threads; i++) {
+					if (pthread_create(&_workers[i]->thread, NULL, worker_main, _workers[i]) != 0) {
+						shutdown(i);
+						throw std::runtime_error("thread_pool: pthread_create failed");
+					}
+				}
+			}
+
+			// every run() and invoke() must have returned
+			~thread_pool() { shutdown(_workers.size()); }
+
+			size_t size() const { return _workers.size(); }
+
+			// whether the calling thread is one of this pool's workers
+			bool in_worker() const {
+				worker* w = thread_pool_detail::current_worker();
+				return w != NULL && w->pool == this;
+			}
+
+			// calls f on a worker and returns when it is done; called from a
+			// worker, simply calls f
+			template <typename F>
+			void run(F& f) {
+				if (in_worker()) {
+					f();
+					return;
+				}
+				thread_pool_detail::blocking_task<F> t(f);
+				_injected.push(&t);
+				notify();
+				t.wait();
+			}
+
+			// calls f1 and f2, in parallel if a worker is free, and returns when
+			// both are done
+			template <typename F1, typename F2>
+			void invoke(F1& f1, F2& f2) {
+				if (!in_worker()) {
+					thread_pool_detail::invoke_both<F1, F2> both(f1, f2);
+					run(both);
+					return;
+				}
+				worker& w = *thread_pool_detail::current_worker();
+				thread_pool_detail::join_task<F2> second(f2);
+				w.deque.push(&second);
+				notify();
+				try {
+					f1();
+				}
+				catch (...) {
+					join(w, second);
+					throw;
+				}
+				join(w, second);
+			}
+
+			stats_type stats() const {
+				stats_type s;
+				s.executed = 0;
+				s.steals = 0;
+				for (size_t i = 0; i < _workers.size(); i++) {
+					s.executed += _workers[i]->executed.load(memory_order_relaxed);
+					s.steals += _workers[i]->steals.load(memory_order_relaxed);
+				}
+				return s;
+			}
+
+			static size_t hardware_threads() {
+				long n = sysconf(_SC_NPROCESSORS_ONLN);
+				return n > 0 ? static_cast<size_t>(n) : 1;
+			}
+
+			// one worker per cpu, started on first use
+			static thread_pool& default_pool() {
+				static thread_pool pool;
+				return pool;
+			}
+
+			// the pool the calling thread works for, else the default one
+			static thread_pool& current() {
+				worker* w = thread_pool_detail::current_worker();
+				return w != NULL ? *w->pool : default_pool();
+			}
+	};
+
+	template <typename F1, typename F2>
+	void thread_pool_detail::invoke_both<F1, F2>::operator()() {
+		current_worker()->pool->invoke(f1, f2);
+	}
+
+	// fork/join on the pool the caller works for (the default pool outside one)
+	template <typename F1, typename F2>
+	void parallel_invoke(F1& f1, F2& f2) {
+		thread_pool::current().invoke(f1, f2);
+	}
+
+	template <typename F1, typename F2>
+	void parallel_invoke(thread_pool& pool, F1& f1, F2& f2) {
+		pool.invoke(f1, f2);
+	}
+}
+
+#endif
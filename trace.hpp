@@ -0,0 +1,659 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "map.hpp"
+#include "set.hpp"
+#include "vector.hpp"
+#include "enable_if.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// Operation traces: traced_map / traced_set / traced_vector behave like the
+// container they derive from and append every insert, lookup, erase and bound
+// query to a trace_writer. bench/trace_replay plays the log back against ft or
+// std containers.
+//
+// Format: an 8-byte header ("FTTR", version, container, key kind, 0) followed
+// by one record per operation: the op byte, then the key. Integer keys are
+// zigzag LEB128 varints, strings a varint length and the bytes, and the
+// vector index op a plain varint. One container per trace.
+
+namespace ft {
+
+	enum trace_op {
+		trace_insert = 1,
+		trace_subscript,
+		trace_find,
+		trace_erase,
+		trace_lower_bound,
+		trace_upper_bound,
+		trace_clear,
+		trace_push_back,
+		trace_pop_back,
+		trace_index,
+		trace_op_end
+	};
+
+	inline const char* trace_op_name(int op) {
+		static const char* names[trace_op_end] = {
+			"?", "insert", "subscript", "find", "erase", "lower_bound", "upper_bound",
+			"clear", "push_back", "pop_back", "index"
+		};
+		return op > 0 && op < trace_op_end ? names[op] : "?";
+	}
+
+	enum trace_container {
+		trace_map = 'm',
+		trace_set = 's',
+		trace_vector = 'v'
+	};
+
+	struct trace_header {
+		char	container;	// trace_container
+		char	key_kind;	// 'i' integer, 's' string
+	};
+
+	// codecs =====================================================================
+
+	namespace trace_detail {
+
+		static const char			magic[4] = { 'F', 'T', 'T', 'R' };
+		static const unsigned char	version = 1;
+
+		inline void put_varint(std::ostream& out, unsigned long v) {
+			while (v >= 0x80) {
+				out.put(static_cast<char>((v & 0x7F) | 0x80));
+				v >>= 7;
+			}
+			out.put(static_cast<char>(v));
+		}
+
+		inline bool get_varint(std::istream& in, unsigned long& v) {
+			v = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7) {
+				int c = in.get();
+				if (c == EOF)
+					return false;
+				v |= static_cast<unsigned long>(c & 0x7F) << shift;
+				if ((c & 0x80) == 0)
+					return true;
+			}
+			throw std::runtime_error("trace: varint too long");
+		}
+
+		template <typename T, bool Integral = ft::is_integral<T>::value>
+		struct codec;
+
+		template <typename T>
+		struct codec<T, true> {
+			static const char kind = 'i';
+
+			static void write(std::ostream& out, const T& v) {
+				long s = static_cast<long>(v);
+				put_varint(out, (static_cast<unsigned long>(s) << 1) ^ static_cast<unsigned long>(s >> 63));
+			}
+			static bool read(std::istream& in, T& v) {
+				unsigned long u;
+				if (!get_varint(in, u))
+					return false;
+				v = static_cast<T>(static_cast<long>((u >> 1) ^ (~(u & 1) + 1)));
+				return true;
+			}
+		};
+
+		template <>
+		struct codec<std::string, false> {
+			static const char kind = 's';
+
+			static void write(std::ostream& out, const std::string& v) {
+				put_varint(out, v.size());
+				out.write(v.data(), static_cast<std::streamsize>(v.size()));
+			}
+			static bool read(std::istream& in, std::string& v) {
+				unsigned long n;
+				if (!get_varint(in, n))
+					return false;
+				v.resize(n);
+				if (n != 0 && !in.read(&v[0], static_cast<std::streamsize>(n)))
+					throw std::runtime_error("trace: truncated string key");
+				return true;
+			}
+		};
+	}
+
+	// writer / reader ============================================================
+
+	class trace_writer {
+		private:
+			std::ostream*	_out;
+			trace_header	_header;
+			bool			_opened;
+			size_t			_records;
+
+			trace_writer(const trace_writer&);
+			trace_writer& operator=(const trace_writer&);
+
+		public:
+			explicit trace_writer(std::ostream& out) : _out(&out), _header(), _opened(false), _records(0) {}
+
+			// called by the traced container; writes the header once
+			template <typename Key>
+			void open(trace_container container) {
+				char kind = trace_detail::codec<Key>::kind;
+				if (_opened) {
+					if (_header.container != container || _header.key_kind != kind)
+						throw std::logic_error("trace: one container per trace_writer");
+					return;
+				}
+				_header.container = static_cast<char>(container);
+				_header.key_kind = kind;
+				_out->write(trace_detail::magic, 4);
+				_out->put(static_cast<char>(trace_detail::version));
+				_out->put(_header.container);
+				_out->put(_header.key_kind);
+				_out->put(0);
+				_opened = true;
+			}
+
+			template <typename Key>
+			void record(trace_op op, const Key& key) {
+				_out->put(static_cast<char>(op));
+				trace_detail::codec<Key>::write(*_out, key);
+				_records++;
+			}
+
+			void record(trace_op op) {
+				_out->put(static_cast<char>(op));
+				_records++;
+			}
+
+			void record_index(trace_op op, size_t index) {
+				_out->put(static_cast<char>(op));
+				trace_detail::put_varint(*_out, index);
+				_records++;
+			}
+
+			size_t	records() const { return _records; }
+	};
+
+	inline trace_header read_trace_header(std::istream& in) {
+		char buf[8];
+		if (!in.read(buf, 8) || std::string(buf, 4) != std::string(trace_detail::magic, 4))
+			throw std::runtime_error("trace: not a trace file");
+		if (static_cast<unsigned char>(buf[4]) != trace_detail::version)
+			throw std::runtime_error("trace: unsupported version");
+		trace_header h;
+		h.container = buf[5];
+		h.key_kind = buf[6];
+		return h;
+	}
+
+	// reads the next record; false at the end of the trace. index is set for
+	// trace_index, key for the ops that carry a key.
+	template <typename Key>
+	bool read_trace_record(std::istream& in, int& op, Key& key, size_t& index) {
+		op = in.get();
+		if (op == EOF)
+			return false;
+		bool ok = true;
+		switch (op) {
+			case trace_clear:
+			case trace_pop_back:
+				break;
+			case trace_index: {
+				unsigned long v;
+				ok = trace_detail::get_varint(in, v);
+				index = v;
+				break;
+			}
+			default:
+				if (op <= 0 || op >= trace_op_end)
+					throw std::runtime_error("trace: unknown op");
+				ok = trace_detail::codec<Key>::read(in, key);
+		}
+		if (!ok)
+			throw std::runtime_error("trace: truncated record");
+		return true;
+	}
+
+	// traced containers ==========================================================
+
+	// Every member that changes the content is recorded as the per-key ops
+	// above (a range insert as one insert per element, insert_or_assign as a
+	// subscript, extract as an erase, merge as an insert per key of the
+	// source...). swap and copy construction have no record: they are private,
+	// so code using them does not compile rather than record a trace that
+	// diverges on replay.
+
+	template <typename Key, typename T, typename Compare = ft::less<Key>,
+		typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class traced_map : public ft::map<Key, T, Compare, Alloc> {
+		private:
+			typedef ft::map<Key, T, Compare, Alloc>	base;
+			trace_writer*	_trace;
+
+		public:
+			typedef typename base::key_type				key_type;
+			typedef typename base::mapped_type			mapped_type;
+			typedef typename base::value_type			value_type;
+			typedef typename base::size_type			size_type;
+			typedef typename base::iterator				iterator;
+			typedef typename base::const_iterator		const_iterator;
+			typedef typename base::node_type			node_type;
+			typedef typename base::insert_return_type	insert_return_type;
+
+		private:
+			traced_map(const traced_map&);
+			void swap(traced_map&);
+
+			// source's keys that are missing here move over; a traced source
+			// records their extraction in its own trace
+			template <typename Map>
+			void merge_from(Map& source) {
+				for (typename Map::iterator it = source.begin(); it != source.end(); ) {
+					typename Map::iterator next = it;
+					++next;
+					_trace->record(trace_insert, it->first);
+					if (base::find(it->first) == base::end())
+						base::insert(source.extract(it));
+					it = next;
+				}
+			}
+
+		public:
+			explicit traced_map(trace_writer& trace, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+				: base(comp, alloc), _trace(&trace) {
+				_trace->open<Key>(trace_map);
+			}
+
+			traced_map& operator=(const traced_map& x) {
+				if (this == &x)
+					return *this;
+				_trace->record(trace_clear);
+				for (const_iterator it = x.begin(); it != x.end(); ++it)
+					_trace->record(trace_insert, it->first);
+				base::operator=(x);
+				return *this;
+			}
+
+			pair<iterator, bool> insert(const value_type& val) {
+				_trace->record(trace_insert, val.first);
+				return base::insert(val);
+			}
+			iterator insert(iterator position, const value_type& val) {
+				_trace->record(trace_insert, val.first);
+				return base::insert(position, val);
+			}
+			template <typename InputIterator>
+			void insert(InputIterator first, InputIterator last) {
+				for (; first != last; ++first)
+					insert(*first);
+			}
+			insert_return_type insert(node_type nh) {
+				if (!nh.empty())
+					_trace->record(trace_insert, nh.key());
+				return base::insert(nh);
+			}
+			iterator insert(iterator hint, node_type nh) {
+				if (!nh.empty())
+					_trace->record(trace_insert, nh.key());
+				return base::insert(hint, nh);
+			}
+			pair<iterator, bool> try_emplace(const key_type& k) {
+				_trace->record(trace_insert, k);
+				return base::try_emplace(k);
+			}
+			template <typename M>
+			pair<iterator, bool> try_emplace(const key_type& k, const M& obj) {
+				_trace->record(trace_insert, k);
+				return base::try_emplace(k, obj);
+			}
+			iterator try_emplace(iterator hint, const key_type& k) {
+				_trace->record(trace_insert, k);
+				return base::try_emplace(hint, k);
+			}
+			template <typename M>
+			iterator try_emplace(iterator hint, const key_type& k, const M& obj) {
+				_trace->record(trace_insert, k);
+				return base::try_emplace(hint, k, obj);
+			}
+			template <typename M>
+			pair<iterator, bool> insert_or_assign(const key_type& k, const M& obj) {
+				_trace->record(trace_subscript, k);
+				return base::insert_or_assign(k, obj);
+			}
+			template <typename M>
+			iterator insert_or_assign(iterator hint, const key_type& k, const M& obj) {
+				_trace->record(trace_subscript, k);
+				return base::insert_or_assign(hint, k, obj);
+			}
+			mapped_type& operator[](const key_type& k) {
+				_trace->record(trace_subscript, k);
+				return base::operator[](k);
+			}
+			iterator find(const key_type& k) {
+				_trace->record(trace_find, k);
+				return base::find(k);
+			}
+			const_iterator find(const key_type& k) const {
+				_trace->record(trace_find, k);
+				return base::find(k);
+			}
+			size_type count(const key_type& k) const {
+				_trace->record(trace_find, k);
+				return base::count(k);
+			}
+			size_type erase(const key_type& k) {
+				_trace->record(trace_erase, k);
+				return base::erase(k);
+			}
+			void erase(iterator position) {
+				_trace->record(trace_erase, position->first);
+				base::erase(position);
+			}
+			void erase(iterator first, iterator last) {
+				while (first != last)
+					erase(first++);
+			}
+			node_type extract(iterator position) {
+				_trace->record(trace_erase, position->first);
+				return base::extract(position);
+			}
+			node_type extract(const key_type& k) {
+				_trace->record(trace_erase, k);
+				return base::extract(k);
+			}
+			template <typename C2, bool S2>
+			void merge(ft::map<Key, T, C2, Alloc, S2>& source) {
+				merge_from(source);
+			}
+			template <typename C2>
+			void merge(traced_map<Key, T, C2, Alloc>& source) {
+				merge_from(source);
+			}
+			iterator lower_bound(const key_type& k) {
+				_trace->record(trace_lower_bound, k);
+				return base::lower_bound(k);
+			}
+			const_iterator lower_bound(const key_type& k) const {
+				_trace->record(trace_lower_bound, k);
+				return base::lower_bound(k);
+			}
+			iterator upper_bound(const key_type& k) {
+				_trace->record(trace_upper_bound, k);
+				return base::upper_bound(k);
+			}
+			const_iterator upper_bound(const key_type& k) const {
+				_trace->record(trace_upper_bound, k);
+				return base::upper_bound(k);
+			}
+			pair<iterator, iterator> equal_range(const key_type& k) {
+				return ft::make_pair(lower_bound(k), upper_bound(k));
+			}
+			pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
+				return ft::make_pair(lower_bound(k), upper_bound(k));
+			}
+			void clear() {
+				_trace->record(trace_clear);
+				base::clear();
+			}
+			void clear(bool keep_nodes) {
+				_trace->record(trace_clear);
+				base::clear(keep_nodes);
+			}
+	};
+
+	// closer than ft::swap(map&, map&), so a swap of traced containers ends up
+	// at the private member and does not compile
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	void swap(traced_map<Key, T, Compare, Alloc>& x, traced_map<Key, T, Compare, Alloc>& y) {
+		x.swap(y);
+	}
+
+	template <typename Key, typename Compare = ft::less<Key>, typename Alloc = std::allocator<Key> >
+	class traced_set : public ft::set<Key, Compare, Alloc> {
+		private:
+			typedef ft::set<Key, Compare, Alloc>	base;
+			trace_writer*	_trace;
+
+		public:
+			typedef typename base::key_type				key_type;
+			typedef typename base::value_type			value_type;
+			typedef typename base::size_type			size_type;
+			typedef typename base::iterator				iterator;
+			typedef typename base::const_iterator		const_iterator;
+			typedef typename base::node_type			node_type;
+			typedef typename base::insert_return_type	insert_return_type;
+
+		private:
+			traced_set(const traced_set&);
+			void swap(traced_set&);
+
+			template <typename Set>
+			void merge_from(Set& source) {
+				for (typename Set::iterator it = source.begin(); it != source.end(); ) {
+					typename Set::iterator next = it;
+					++next;
+					_trace->record(trace_insert, *it);
+					if (base::find(*it) == base::end())
+						base::insert(source.extract(it));
+					it = next;
+				}
+			}
+
+		public:
+			explicit traced_set(trace_writer& trace, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+				: base(comp, alloc), _trace(&trace) {
+				_trace->open<Key>(trace_set);
+			}
+
+			traced_set& operator=(const traced_set& x) {
+				if (this == &x)
+					return *this;
+				_trace->record(trace_clear);
+				for (const_iterator it = x.begin(); it != x.end(); ++it)
+					_trace->record(trace_insert, *it);
+				base::operator=(x);
+				return *this;
+			}
+
+			pair<iterator, bool> insert(const value_type& val) {
+				_trace->record(trace_insert, val);
+				return base::insert(val);
+			}
+			iterator insert(iterator position, const value_type& val) {
+				_trace->record(trace_insert, val);
+				return base::insert(position, val);
+			}
+			template <typename InputIterator>
+			void insert(InputIterator first, InputIterator last) {
+				for (; first != last; ++first)
+					insert(*first);
+			}
+			insert_return_type insert(node_type nh) {
+				if (!nh.empty())
+					_trace->record(trace_insert, nh.value());
+				return base::insert(nh);
+			}
+			iterator insert(iterator hint, node_type nh) {
+				if (!nh.empty())
+					_trace->record(trace_insert, nh.value());
+				return base::insert(hint, nh);
+			}
+			iterator find(const key_type& k) {
+				_trace->record(trace_find, k);
+				return base::find(k);
+			}
+			const_iterator find(const key_type& k) const {
+				_trace->record(trace_find, k);
+				return base::find(k);
+			}
+			size_type count(const key_type& k) const {
+				_trace->record(trace_find, k);
+				return base::count(k);
+			}
+			size_type erase(const key_type& k) {
+				_trace->record(trace_erase, k);
+				return base::erase(k);
+			}
+			void erase(iterator position) {
+				_trace->record(trace_erase, *position);
+				base::erase(position);
+			}
+			void erase(iterator first, iterator last) {
+				while (first != last)
+					erase(first++);
+			}
+			node_type extract(iterator position) {
+				_trace->record(trace_erase, *position);
+				return base::extract(position);
+			}
+			node_type extract(const key_type& k) {
+				_trace->record(trace_erase, k);
+				return base::extract(k);
+			}
+			template <typename C2, bool S2>
+			void merge(ft::set<Key, C2, Alloc, S2>& source) {
+				merge_from(source);
+			}
+			template <typename C2>
+			void merge(traced_set<Key, C2, Alloc>& source) {
+				merge_from(source);
+			}
+			iterator lower_bound(const key_type& k) {
+				_trace->record(trace_lower_bound, k);
+				return base::lower_bound(k);
+			}
+			const_iterator lower_bound(const key_type& k) const {
+				_trace->record(trace_lower_bound, k);
+				return base::lower_bound(k);
+			}
+			iterator upper_bound(const key_type& k) {
+				_trace->record(trace_upper_bound, k);
+				return base::upper_bound(k);
+			}
+			const_iterator upper_bound(const key_type& k) const {
+				_trace->record(trace_upper_bound, k);
+				return base::upper_bound(k);
+			}
+			pair<iterator, iterator> equal_range(const key_type& k) const {
+				return ft::make_pair(lower_bound(k), upper_bound(k));
+			}
+			void clear() {
+				_trace->record(trace_clear);
+				base::clear();
+			}
+			void clear(bool keep_nodes) {
+				_trace->record(trace_clear);
+				base::clear(keep_nodes);
+			}
+	};
+
+	template <typename Key, typename Compare, typename Alloc>
+	void swap(traced_set<Key, Compare, Alloc>& x, traced_set<Key, Compare, Alloc>& y) {
+		x.swap(y);
+	}
+
+	// insert and erase in the middle have no record either, so they are
+	// private too; resize and assign become push_back / pop_back / clear
+	template <typename T, typename Alloc = std::allocator<T> >
+	class traced_vector : public ft::vector<T, Alloc> {
+		private:
+			typedef ft::vector<T, Alloc>	base;
+			trace_writer*	_trace;
+
+		public:
+			typedef typename base::value_type		value_type;
+			typedef typename base::size_type		size_type;
+			typedef typename base::iterator			iterator;
+			typedef typename base::reference		reference;
+			typedef typename base::const_reference	const_reference;
+
+		private:
+			traced_vector(const traced_vector&);
+			void swap(traced_vector&);
+			iterator insert(iterator position, const value_type& val);
+			void insert(iterator position, size_type n, const value_type& val);
+			template <typename InputIterator>
+			void insert(iterator position, InputIterator first, InputIterator last);
+			iterator erase(iterator position);
+			iterator erase(iterator first, iterator last);
+
+		public:
+			explicit traced_vector(trace_writer& trace, const Alloc& alloc = Alloc())
+				: base(alloc), _trace(&trace) {
+				_trace->open<T>(trace_vector);
+			}
+
+			traced_vector& operator=(const traced_vector& x) {
+				if (this != &x)
+					assign(x.begin(), x.end());
+				return *this;
+			}
+
+			void push_back(const value_type& val) {
+				_trace->record(trace_push_back, val);
+				base::push_back(val);
+			}
+			void pop_back() {
+				_trace->record(trace_pop_back);
+				base::pop_back();
+			}
+			reference operator[](size_type n) {
+				_trace->record_index(trace_index, n);
+				return base::operator[](n);
+			}
+			const_reference operator[](size_type n) const {
+				_trace->record_index(trace_index, n);
+				return base::operator[](n);
+			}
+			// recorded once the bounds check passed: a replay has no out of
+			// range index to trip over
+			reference at(size_type n) {
+				reference r = base::at(n);
+				_trace->record_index(trace_index, n);
+				return r;
+			}
+			const_reference at(size_type n) const {
+				const_reference r = base::at(n);
+				_trace->record_index(trace_index, n);
+				return r;
+			}
+			void resize(size_type n, value_type val = value_type()) {
+				for (size_type i = base::size(); i < n; i++)
+					_trace->record(trace_push_back, val);
+				for (size_type i = n; i < base::size(); i++)
+					_trace->record(trace_pop_back);
+				base::resize(n, val);
+			}
+			template <typename InputIterator>
+			void assign(InputIterator first, InputIterator last,
+				typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = NULL) {
+				clear();
+				for (; first != last; ++first)
+					push_back(*first);
+			}
+			void assign(size_type n, const value_type& val) {
+				clear();
+				base::reserve(n);
+				for (size_type i = 0; i < n; i++)
+					push_back(val);
+			}
+			void clear() {
+				_trace->record(trace_clear);
+				base::clear();
+			}
+	};
+
+	template <typename T, typename Alloc>
+	void swap(traced_vector<T, Alloc>& x, traced_vector<T, Alloc>& y) {
+		x.swap(y);
+	}
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef TREE_STATS_HPP
+#define TREE_STATS_HPP
+
+#include <cstddef>
+#include <ostream>
+
+namespace ft {
+
+	// what red_black_tree did to keep itself balanced, per kind of operation
+	struct tree_op_stats {
+		size_t	operations;
+		size_t	comparisons;
+		size_t	rotations;
+		size_t	recolorings;
+
+		tree_op_stats() : operations(0), comparisons(0), rotations(0), recolorings(0) {}
+
+		double per_op(size_t count) const {
+			return operations ? static_cast<double>(count) / static_cast<double>(operations) : 0;
+		}
+	};
+
+	enum tree_op {
+		tree_insert_op,
+		tree_erase_op,
+		tree_lookup_op
+	};
+
+	struct tree_stats {
+		tree_op_stats	insert;
+		tree_op_stats	erase;
+		tree_op_stats	lookup;
+
+		tree_op_stats& at(tree_op op) {
+			if (op == tree_insert_op)
+				return insert;
+			if (op == tree_erase_op)
+				return erase;
+			return lookup;
+		}
+
+		void reset() { *this = tree_stats(); }
+	};
+
+	inline std::ostream& operator<<(std::ostream& os, const tree_stats& s) {
+		const char*				names[3] = { "insert", "erase", "lookup" };
+		const tree_op_stats*	ops[3] = { &s.insert, &s.erase, &s.lookup };
+		for (size_t i = 0; i < 3; i++)
+			os << names[i] << ": " << ops[i]->operations << " ops, per op "
+				<< ops[i]->per_op(ops[i]->comparisons) << " comparisons, "
+				<< ops[i]->per_op(ops[i]->rotations) << " rotations, "
+				<< ops[i]->per_op(ops[i]->recolorings) << " recolorings\n";
+		return os;
+	}
+
+	// shape of the tree right now; depth of the root is 0, height counts nodes
+	struct tree_shape {
+		size_t	size;
+		size_t	height;
+		size_t	black_height;	// black nodes on the path to the leftmost leaf
+		double	average_depth;
+	};
+
+	inline std::ostream& operator<<(std::ostream& os, const tree_shape& s) {
+		return os << "size " << s.size << ", height " << s.height << ", black height "
+			<< s.black_height << ", average depth " << s.average_depth << '\n';
+	}
+
+	// red_black_tree derives from this privately. With Enabled false every hook
+	// is an empty inline function and the base takes no space, so the counting
+	// compiles away; stats() then always reads zero.
+	template <bool Enabled>
+	class tree_stats_recorder {
+		public:
+			const tree_stats&	stats() const {
+				static const tree_stats none;
+				return none;
+			}
+			void				reset_stats() {}
+
+		protected:
+			void	stats_begin(tree_op) const {}
+			void	count_comparison() const {}
+			void	count_rotation() const {}
+			void	count_recoloring(size_t) const {}
+	};
+
+	template <>
+	class tree_stats_recorder<true> {
+		private:
+			// lookups are const member functions of the tree
+			mutable tree_stats	_stats;
+			mutable tree_op		_current;
+
+		public:
+			tree_stats_recorder() : _stats(), _current(tree_lookup_op) {}
+			// a copied tree starts counting from zero
+			tree_stats_recorder(const tree_stats_recorder&) : _stats(), _current(tree_lookup_op) {}
+			tree_stats_recorder& operator=(const tree_stats_recorder&) { return *this; }
+
+			const tree_stats&	stats() const { return _stats; }
+			void				reset_stats() { _stats.reset(); }
+
+		protected:
+			void	stats_begin(tree_op op) const {
+				_current = op;
+				_stats.at(op).operations++;
+			}
+			void	count_comparison() const { _stats.at(_current).comparisons++; }
+			void	count_rotation() const { _stats.at(_current).rotations++; }
+			void	count_recoloring(size_t n) const { _stats.at(_current).recolorings += n; }
+	};
+}
+
+#endif
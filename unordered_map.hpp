@@ -0,0 +1,174 @@
+#ifndef UNORDERED_MAP_HPP
+#define UNORDERED_MAP_HPP
+
+#include "hash_table.hpp"
+#include <memory>
+#include <stdexcept>
+
+namespace ft{
+	template<typename Key, typename T, typename Hash = ft::hash<Key>, typename KeyEqual = ft::equal_to<Key>,
+		typename Alloc = std::allocator<ft::pair<const Key, T> > >
+	class unordered_map{
+	public:
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef ft::pair<const Key, T> value_type;
+		typedef Hash hasher;
+		typedef KeyEqual key_equal;
+		typedef Alloc allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		typedef typename allocator_type::pointer pointer;
+		typedef typename allocator_type::const_pointer const_pointer;
+		typedef typename allocator_type::reference reference;
+		typedef typename allocator_type::const_reference const_reference;
+
+		typedef typename ft::hash_table_iterator<value_type> iterator;
+		typedef typename ft::hash_table_iterator<const value_type> const_iterator;
+
+	private:
+		typedef ft::hash_table<value_type, key_type, ft::select_first<value_type>, hasher, key_equal, allocator_type> table_type;
+
+		table_type	_table;
+	public:
+		explicit unordered_map(size_type bucket_count = 0, const hasher& hf = hasher(),
+		 const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+		: _table(hf, eq, alloc){
+			if (bucket_count != 0)
+				_table.rehash(bucket_count);
+		}
+
+		template<typename InputIterator>
+		unordered_map(InputIterator first, InputIterator last, size_type bucket_count = 0,
+		 const hasher& hf = hasher(), const key_equal& eq = key_equal(),
+		 const allocator_type& alloc = allocator_type())
+		: _table(hf, eq, alloc){
+			if (bucket_count != 0)
+				_table.rehash(bucket_count);
+			insert(first, last);
+		}
+		unordered_map(const unordered_map& x) : _table(x._table){}
+		~unordered_map(){}
+
+		unordered_map& operator=(const unordered_map& x){
+			if(this == &x)
+				return *this;
+			_table = x._table;
+			return *this;
+		}
+
+		iterator begin(){return _table.begin();}
+		const_iterator begin() const{return _table.begin();}
+
+		iterator end(){return _table.end();}
+		const_iterator end() const{return _table.end();}
+
+		bool empty() const{return _table.empty();}
+		size_type size() const{return _table.size();}
+		size_type max_size() const{return _table.max_size();}
+
+		mapped_type& operator[](const key_type& k){
+			return _table.find_or_insert(k).second;
+		}
+		mapped_type& at(const key_type& k){
+			iterator it = find(k);
+			if (it == end())
+				throw std::out_of_range("unordered_map::at");
+			return it->second;
+		}
+		const mapped_type& at(const key_type& k) const{
+			const_iterator it = find(k);
+			if (it == end())
+				throw std::out_of_range("unordered_map::at");
+			return it->second;
+		}
+
+		//insert
+		pair<iterator, bool> insert(const value_type& val){
+			return _table.insert(val);
+		}
+		iterator insert(const_iterator hint, const value_type& val){
+			(void)hint;
+			return _table.insert(val).first;
+		}
+		template<typename InputIterator>
+		void insert(InputIterator first, InputIterator last){
+			_table.insert(first, last);
+		}
+
+		iterator erase(const_iterator position){
+			return _table.erase(position);
+		}
+		size_type erase(const key_type& k){
+			return _table.erase(k);
+		}
+		void swap(unordered_map& x){
+			_table.swap(x._table);
+		}
+		void clear(){
+			_table.clear();
+		}
+
+		iterator find(const key_type& k){
+			return _table.find(k);
+		}
+		const_iterator find(const key_type& k) const{
+			return _table.find(k);
+		}
+		size_type count(const key_type& k) const{
+			return _table.count(k);
+		}
+		pair<iterator, iterator> equal_range(const key_type& k){
+			iterator it = find(k);
+			if (it == end())
+				return ft::make_pair(it, it);
+			iterator next = it;
+			return ft::make_pair(it, ++next);
+		}
+		pair<const_iterator, const_iterator> equal_range(const key_type& k) const{
+			const_iterator it = find(k);
+			if (it == end())
+				return ft::make_pair(it, it);
+			const_iterator next = it;
+			return ft::make_pair(it, ++next);
+		}
+
+		//hash policy
+		size_type bucket_count() const{return _table.bucket_count();}
+		float load_factor() const{return _table.load_factor();}
+		float max_load_factor() const{return _table.max_load_factor();}
+		void max_load_factor(float ml){_table.max_load_factor(ml);}
+		void rehash(size_type n){_table.rehash(n);}
+		void reserve(size_type n){_table.reserve(n);}
+
+		hasher hash_function() const{return _table.hash_function();}
+		key_equal key_eq() const{return _table.key_eq();}
+		allocator_type get_allocator() const{return _table.get_allocator();}
+		ft::memory_footprint memory_usage() const{return _table.memory_usage();}
+	};
+
+	template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+	void swap(unordered_map<Key, T, Hash, KeyEqual, Alloc>& x, unordered_map<Key, T, Hash, KeyEqual, Alloc>& y) {
+		x.swap(y);
+	}
+
+	template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+	bool operator==(const unordered_map<Key, T, Hash, KeyEqual, Alloc>& x, const unordered_map<Key, T, Hash, KeyEqual, Alloc>& y) {
+		if (x.size() != y.size())
+			return false;
+		typedef typename unordered_map<Key, T, Hash, KeyEqual, Alloc>::const_iterator const_iterator;
+		for (const_iterator it = x.begin(); it != x.end(); ++it) {
+			const_iterator other = y.find(it->first);
+			if (other == y.end() || !(other->second == it->second))
+				return false;
+		}
+		return true;
+	}
+
+	template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+	bool operator!=(const unordered_map<Key, T, Hash, KeyEqual, Alloc>& x, const unordered_map<Key, T, Hash, KeyEqual, Alloc>& y) {
+		return !(x == y);
+	}
+};
+#endif
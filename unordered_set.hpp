@@ -0,0 +1,202 @@
+#ifndef UNORDERED_SET_HPP
+#define UNORDERED_SET_HPP
+
+#include "hash_table.hpp"
+#include <memory>
+
+namespace ft {
+
+	template <class Key, class Hash = ft::hash<Key>, class KeyEqual = ft::equal_to<Key>, class Alloc = std::allocator<Key> >
+	class unordered_set {
+		public:
+		typedef Key key_type;
+		typedef Key value_type;
+		typedef Hash hasher;
+		typedef KeyEqual key_equal;
+		typedef Alloc allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef typename allocator_type::reference reference;
+		typedef typename allocator_type::const_reference const_reference;
+		typedef typename allocator_type::pointer pointer;
+		typedef typename allocator_type::const_pointer const_pointer;
+		typedef typename ft::hash_table_iterator<const value_type> iterator;
+		typedef typename ft::hash_table_iterator<const value_type> const_iterator;
+
+		private:
+			typedef ft::hash_table<value_type, key_type, ft::identity<value_type>, hasher, key_equal, allocator_type> table_type;
+
+			table_type _table;
+
+		public:
+			explicit unordered_set(size_type bucket_count = 0, const hasher& hf = hasher(),
+			const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+			: _table(hf, eq, alloc) {
+				if (bucket_count != 0)
+					_table.rehash(bucket_count);
+			}
+
+			template <class InputIterator>
+			unordered_set(InputIterator first, InputIterator last, size_type bucket_count = 0,
+			const hasher& hf = hasher(), const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+			: _table(hf, eq, alloc) {
+				if (bucket_count != 0)
+					_table.rehash(bucket_count);
+				_table.insert(first, last);
+			}
+
+			unordered_set(const unordered_set& ref)
+			: _table(ref._table) {}
+
+			~unordered_set() {}
+
+			unordered_set& operator=(const unordered_set& ref) {
+				_table = ref._table;
+				return *this;
+			}
+
+			//iterators
+			iterator begin() {
+				return _table.begin();
+			}
+
+			const_iterator begin() const {
+				return _table.begin();
+			}
+
+			iterator end() {
+				return _table.end();
+			}
+
+			const_iterator end() const {
+				return _table.end();
+			}
+
+			//capacity
+			bool empty() const {
+				return _table.empty();
+			}
+
+			size_type size() const {
+				return _table.size();
+			}
+
+			size_type max_size() const {
+				return _table.max_size();
+			}
+
+			//modifiers
+			pair<iterator, bool> insert(const value_type& val) {
+				return _table.insert(val);
+			}
+
+			iterator insert(const_iterator hint, const value_type& val) {
+				(void)hint;
+				return _table.insert(val).first;
+			}
+
+			template <class InputIterator>
+			void insert(InputIterator first, InputIterator last) {
+				_table.insert(first, last);
+			}
+
+			iterator erase(const_iterator position) {
+				return _table.erase(position);
+			}
+
+			size_type erase(const key_type& k) {
+				return _table.erase(k);
+			}
+
+			void swap(unordered_set& x) {
+				_table.swap(x._table);
+			}
+
+			void clear() {
+				_table.clear();
+			}
+
+			//operations
+			const_iterator find(const key_type& k) const {
+				return _table.find(k);
+			}
+
+			size_type count(const key_type& k) const {
+				return _table.count(k);
+			}
+
+			pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
+				const_iterator it = find(k);
+				if (it == end())
+					return ft::make_pair(it, it);
+				const_iterator next = it;
+				return ft::make_pair(it, ++next);
+			}
+
+			//hash policy
+			size_type bucket_count() const {
+				return _table.bucket_count();
+			}
+
+			float load_factor() const {
+				return _table.load_factor();
+			}
+
+			float max_load_factor() const {
+				return _table.max_load_factor();
+			}
+
+			void max_load_factor(float ml) {
+				_table.max_load_factor(ml);
+			}
+
+			void rehash(size_type n) {
+				_table.rehash(n);
+			}
+
+			void reserve(size_type n) {
+				_table.reserve(n);
+			}
+
+			//observers
+			hasher hash_function() const {
+				return _table.hash_function();
+			}
+
+			key_equal key_eq() const {
+				return _table.key_eq();
+			}
+
+			allocator_type get_allocator() const {
+				return _table.get_allocator();
+			}
+
+			ft::memory_footprint memory_usage() const {
+				return _table.memory_usage();
+			}
+	};
+
+	template <class Key, class Hash, class KeyEqual, class Alloc>
+	void swap(ft::unordered_set<Key, Hash, KeyEqual, Alloc>& lhs, ft::unordered_set<Key, Hash, KeyEqual, Alloc>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template <class Key, class Hash, class KeyEqual, class Alloc>
+	bool operator==(const ft::unordered_set<Key, Hash, KeyEqual, Alloc>& lhs, const ft::unordered_set<Key, Hash, KeyEqual, Alloc>& rhs) {
+		if (lhs.size() != rhs.size())
+			return false;
+		typedef typename ft::unordered_set<Key, Hash, KeyEqual, Alloc>::const_iterator const_iterator;
+		for (const_iterator it = lhs.begin(); it != lhs.end(); ++it) {
+			if (rhs.find(*it) == rhs.end())
+				return false;
+		}
+		return true;
+	}
+
+	template <class Key, class Hash, class KeyEqual, class Alloc>
+	bool operator!=(const ft::unordered_set<Key, Hash, KeyEqual, Alloc>& lhs, const ft::unordered_set<Key, Hash, KeyEqual, Alloc>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+#endif
@@ -6,6 +6,9 @@
 #include "random_access_iterator.hpp"
 #include "reverse_iterator.hpp"
 #include "enable_if.hpp"
+#include "memory_usage.hpp"
+#include "probes.hpp"
+#include "allocator_traits.hpp"
 
 
 namespace ft {
@@ -63,7 +66,7 @@ namespace ft {
 			template <class InputIterator>
 			explicit vector(InputIterator first, InputIterator last, 
 				const allocator_type& a = allocator_type(),
-				typename std::enable_if<!std::is_integral<InputIterator>::value>::type* = 0)
+				typename ft::enable_if<!ft::is_integral<InputIterator>::value>::type* = 0)
 			: __a_(a) {
 				size_type n = ft::distance(first, last);
 				__begin_ = __a_.allocate(n);
@@ -84,7 +87,18 @@ namespace ft {
 			}
 
 			vector(const vector& x)
-			: __a_(x.__a_) {
+			: __a_(allocator_traits<allocator_type>::select_on_container_copy_construction(x.__a_)) {
+				copy_construct(x);
+			}
+
+			// copies x into memory from a, e.g. an arena other than x's
+			vector(const vector& x, const allocator_type& a)
+			: __a_(a) {
+				copy_construct(x);
+			}
+
+		private:
+			void copy_construct(const vector& x) {
 				size_type n = x.size();
 				__begin_ = __a_.allocate(n);
 				__end_ = __begin_;
@@ -102,7 +116,10 @@ namespace ft {
 				}
 			}
 
+		public:
 			~vector() {
+				if (destruction_is_trivial<allocator_type, value_type>::value)
+					return;
 				for(pointer p = __begin_; p != __end_; p++)
 					__a_.destroy(p);
 				__a_.deallocate(__begin_, __end_cap_ - __begin_);
@@ -114,6 +131,8 @@ namespace ft {
 				for(pointer p = __begin_; p != __end_; p++)
 					__a_.destroy(p);
 				__a_.deallocate(__begin_, __end_cap_ - __begin_);
+				if (ft::allocator_propagates_on_copy(__a_, x.__a_))
+					__a_ = x.__a_;
 				size_type n = x.size();
 				__begin_ = __a_.allocate(n);
 				__end_ = __begin_;
@@ -184,9 +203,11 @@ namespace ft {
 						__a_.deallocate(new_begin, n);
 						throw;// 예외를 다시 던진다. container에서 예외를 처리할 수 있도록 exception safety를 보장한다.
 					}
+					size_type old_capacity = capacity();
 					for(pointer p = __begin_; p != __end_; p++)
 						__a_.destroy(p);
-					__a_.deallocate(__begin_, capacity());
+					__a_.deallocate(__begin_, old_capacity);
+					FT_PROBE4(vector_reserve, this, old_capacity, n, old_size * sizeof(value_type));
 					__begin_ = new_begin;
 					__end_ = new_end;
 					__end_cap_ = new_end_cap;
@@ -323,17 +344,15 @@ namespace ft {
 				pointer			tmp_begin = __begin_;
 				pointer			tmp_end = __end_;
 				pointer			tmp_end_of_storage = __end_cap_;
-				allocator_type	tmp_a = __a_;
 				
 				__begin_ = x.__begin_;
 				__end_ = x.__end_;
 				__end_cap_ = x.__end_cap_;
-				__a_ = x.__a_;
 				
 				x.__begin_ = tmp_begin;
 				x.__end_ = tmp_end;
 				x.__end_cap_ = tmp_end_of_storage;
-				x.__a_ = tmp_a;
+				ft::swap_allocators(__a_, x.__a_);
 			}
 			void clear() {
 				for (size_type i = 0; i < size(); i++) {
@@ -345,6 +364,12 @@ namespace ft {
 			allocator_type get_allocator() const {
 				return __a_;
 			}
+			//memory: the spare capacity counts as overhead
+			ft::memory_footprint memory_usage() const {
+				ft::memory_footprint m;
+				m.add_blocks(capacity() * sizeof(value_type), capacity() != 0 ? 1 : 0, size() * sizeof(value_type));
+				return m;
+			}
 	};
 	//operator
 	template <class T, class Alloc>
@@ -0,0 +1,155 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include "atomic.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace ft {
+
+	// Chase-Lev work-stealing deque, after Le, Pop, Cohen and Zappa Nardelli,
+	// "Correct and efficient work-stealing for weak memory models", with their
+	// seq_cst fences folded into seq_cst accesses of top and bottom (the same
+	// cost on x86, and visible to ThreadSanitizer). One owner thread pushes and
+	// pops at the bottom, LIFO, touching no shared line in the common case; any
+	// number of thieves steal from the top, FIFO, with one CAS. Only the last
+	// item is contended, and the owner settles that race with the same CAS.
+	//
+	// The ring doubles when full. Thieves may still be reading the old ring, so
+	// it is kept until the deque is destroyed (their sizes sum to less than the
+	// current one). T must be a type the builtin atomics take, in practice a
+	// pointer to the work.
+	template <typename T, typename Alloc = std::allocator<T> >
+	class work_stealing_deque {
+		public:
+			typedef T			value_type;
+			typedef Alloc		allocator_type;
+			typedef size_t		size_type;
+
+		private:
+			struct ring {
+				long				mask;
+				ft::atomic<T>*		slots;
+				ring*				retired;	// the ring this one replaced
+
+				T get(long i) const { return slots[i & mask].load(memory_order_relaxed); }
+				void put(long i, T v) { slots[i & mask].store(v, memory_order_relaxed); }
+			};
+
+			typedef typename Alloc::template rebind<ring>::other			ring_alloc_type;
+			typedef typename Alloc::template rebind<ft::atomic<T> >::other	slot_alloc_type;
+
+			ring_alloc_type		_ring_alloc;
+			slot_alloc_type		_slot_alloc;
+			char				_pad0[cache_line_size];
+			ft::atomic<long>	_top;			// thieves
+			char				_pad1[cache_line_size - sizeof(long)];
+			ft::atomic<long>	_bottom;		// owner
+			ft::atomic<ring*>	_ring;
+			char				_pad2[cache_line_size - sizeof(long) - sizeof(ring*)];
+
+			work_stealing_deque(const work_stealing_deque&);
+			work_stealing_deque& operator=(const work_stealing_deque&);
+
+			ring* make_ring(long size, ring* retired) {
+				ring* r = _ring_alloc.allocate(1);
+				r->mask = size - 1;
+				r->retired = retired;
+				r->slots = _slot_alloc.allocate(static_cast<size_t>(size));
+				for (long i = 0; i < size; i++)
+					::new (static_cast<void*>(&r->slots[i])) ft::atomic<T>();
+				return r;
+			}
+
+			// items top .. bottom move to a ring twice the size
+			ring* grow(ring* old, long top, long bottom) {
+				ring* r = make_ring(2 * (old->mask + 1), old);
+				for (long i = top; i < bottom; i++)
+					r->put(i, old->get(i));
+				_ring.store(r, memory_order_release);
+				return r;
+			}
+
+		public:
+			explicit work_stealing_deque(size_type capacity = 64, const allocator_type& alloc = allocator_type())
+				: _ring_alloc(alloc), _slot_alloc(alloc), _top(0), _bottom(0), _ring(NULL) {
+				long size = 2;
+				while (static_cast<size_type>(size) < capacity)
+					size *= 2;
+				_ring.store(make_ring(size, NULL), memory_order_relaxed);
+			}
+
+			// only once no thread uses the deque
+			~work_stealing_deque() {
+				ring* r = _ring.load(memory_order_relaxed);
+				while (r != NULL) {
+					ring* retired = r->retired;
+					for (long i = 0; i <= r->mask; i++)
+						r->slots[i].~atomic();
+					_slot_alloc.deallocate(r->slots, static_cast<size_t>(r->mask + 1));
+					_ring_alloc.deallocate(r, 1);
+					r = retired;
+				}
+			}
+
+			// owner only
+			void push(T v) {
+				long b = _bottom.load(memory_order_relaxed);
+				long t = _top.load(memory_order_acquire);
+				ring* r = _ring.load(memory_order_relaxed);
+				if (b - t > r->mask)
+					r = grow(r, t, b);
+				r->put(b, v);
+				// publishes the item (and whatever it points to) to thieves
+				_bottom.store(b + 1, memory_order_release);
+			}
+
+			// owner only: the most recently pushed item, false if empty or stolen
+			bool pop(T& out) {
+				long b = _bottom.load(memory_order_relaxed) - 1;
+				ring* r = _ring.load(memory_order_relaxed);
+				// the new bottom must be visible before top is read: a thief
+				// reading the old one could take the item popped here
+				_bottom.exchange(b, memory_order_seq_cst);
+				long t = _top.load(memory_order_seq_cst);
+				if (t > b) {
+					_bottom.store(b + 1, memory_order_relaxed);
+					return false;
+				}
+				out = r->get(b);
+				if (t == b) {
+					// the last item: race the thieves for it
+					bool won = _top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+					_bottom.store(b + 1, memory_order_relaxed);
+					return won;
+				}
+				return true;
+			}
+
+			// any thread: the oldest item, false if empty or another thief won it
+			bool steal(T& out) {
+				long t = _top.load(memory_order_seq_cst);
+				long b = _bottom.load(memory_order_seq_cst);
+				if (t >= b)
+					return false;
+				ring* r = _ring.load(memory_order_acquire);
+				T v = r->get(t);
+				if (!_top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+					return false;
+				out = v;
+				return true;
+			}
+
+			// a snapshot that may be stale by the time it returns
+			size_type size_approx() const {
+				long b = _bottom.load(memory_order_relaxed);
+				long t = _top.load(memory_order_relaxed);
+				return b > t ? static_cast<size_type>(b - t) : 0;
+			}
+
+			bool empty_approx() const { return size_approx() == 0; }
+	};
+}
+
+#endif